@@ -7,6 +7,14 @@ echo Tiny3D - Simple Build (No Make needed)
 echo ========================================
 echo.
 
+REM "build-simple.bat depthcue" builds with depth cueing (TINY3D_DEPTH_CUE)
+set DEFINES=
+set CL_DEFINES=
+if /I "%~1"=="depthcue" (
+    set DEFINES=-DTINY3D_DEPTH_CUE
+    set CL_DEFINES=/DTINY3D_DEPTH_CUE
+)
+
 REM Check for g++
 where g++ >nul 2>nul
 if %ERRORLEVEL% EQU 0 goto :build_gcc
@@ -35,12 +43,29 @@ if not exist "build\lib" mkdir build\lib
 if not exist "build\bin" mkdir build\bin
 
 echo Compiling source files...
-g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/animation.cpp -o build/obj/animation.o
-g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/canvas.cpp -o build/obj/canvas.o
-g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/lighting.cpp -o build/obj/lighting.o
-g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/math3d.cpp -o build/obj/math3d.o
-g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/renderer.cpp -o build/obj/renderer.o
-g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/display.cpp -o build/obj/display.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/animation.cpp -o build/obj/animation.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/canvas.cpp -o build/obj/canvas.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/lighting.cpp -o build/obj/lighting.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/math3d.cpp -o build/obj/math3d.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/renderer.cpp -o build/obj/renderer.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/display.cpp -o build/obj/display.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/mesh.cpp -o build/obj/mesh.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/spatial_hash.cpp -o build/obj/spatial_hash.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/mapped_file.cpp -o build/obj/mapped_file.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/mesh_io.cpp -o build/obj/mesh_io.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/mesh_binary.cpp -o build/obj/mesh_binary.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/culling.cpp -o build/obj/culling.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/chunked_scene.cpp -o build/obj/chunked_scene.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/bvh.cpp -o build/obj/bvh.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/lod.cpp -o build/obj/lod.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/edge_reduce.cpp -o build/obj/edge_reduce.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/strips.cpp -o build/obj/strips.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/silhouette.cpp -o build/obj/silhouette.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/raster.cpp -o build/obj/raster.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/hiz.cpp -o build/obj/hiz.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/points.cpp -o build/obj/points.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/transform.cpp -o build/obj/transform.o
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude %DEFINES% -c src/morph.cpp -o build/obj/morph.o
 
 if %ERRORLEVEL% NEQ 0 (
     echo Compilation failed!
@@ -55,15 +80,28 @@ echo Library created: build/lib/libtiny3d.a
 
 echo.
 echo Building demos...
-g++ -std=c++17 -O2 -Iinclude demo/main.cpp build/lib/libtiny3d.a -o build/bin/demo.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% demo/main.cpp build/lib/libtiny3d.a -o build/bin/demo.exe
 echo Demo built: build/bin/demo.exe
-g++ -std=c++17 -O2 -Iinclude demo/interactive.cpp build/lib/libtiny3d.a -o build/bin/interactive.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% demo/interactive.cpp build/lib/libtiny3d.a -o build/bin/interactive.exe
 echo Interactive demo built: build/bin/interactive.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% demo/bench_bvh.cpp build/lib/libtiny3d.a -o build/bin/bench_bvh.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% demo/bench_raster.cpp build/lib/libtiny3d.a -o build/bin/bench_raster.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% demo/bench_hiz.cpp build/lib/libtiny3d.a -o build/bin/bench_hiz.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% demo/bench_points.cpp build/lib/libtiny3d.a -o build/bin/bench_points.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% demo/bench_lighting.cpp build/lib/libtiny3d.a -o build/bin/bench_lighting.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% demo/bench_animation.cpp build/lib/libtiny3d.a -o build/bin/bench_animation.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% demo/bench_hierarchy.cpp build/lib/libtiny3d.a -o build/bin/bench_hierarchy.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% demo/bench_morph.cpp build/lib/libtiny3d.a -o build/bin/bench_morph.exe
 
 echo.
 echo Building tests...
-g++ -std=c++17 -O2 -Iinclude tests/test_animation.cpp build/lib/libtiny3d.a -o build/bin/test_animation.exe
-g++ -std=c++17 -O2 -Iinclude tests/test_math.cpp build/lib/libtiny3d.a -o build/bin/test_math.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% tests/test_animation.cpp build/lib/libtiny3d.a -o build/bin/test_animation.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% tests/test_math.cpp build/lib/libtiny3d.a -o build/bin/test_math.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% tests/test_mesh.cpp build/lib/libtiny3d.a -o build/bin/test_mesh.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% tests/test_mesh_io.cpp build/lib/libtiny3d.a -o build/bin/test_mesh_io.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% tests/test_scene.cpp build/lib/libtiny3d.a -o build/bin/test_scene.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% tests/test_raster.cpp build/lib/libtiny3d.a -o build/bin/test_raster.exe
+g++ -std=c++17 -O2 -Iinclude %DEFINES% tests/test_lighting.cpp build/lib/libtiny3d.a -o build/bin/test_lighting.exe
 echo Tests built!
 
 goto :success
@@ -78,12 +116,29 @@ if not exist "build\lib" mkdir build\lib
 if not exist "build\bin" mkdir build\bin
 
 echo Compiling source files...
-cl /std:c++17 /W4 /O2 /EHsc /Iinclude /c src/animation.cpp /Fo:build/obj/animation.obj
-cl /std:c++17 /W4 /O2 /EHsc /Iinclude /c src/canvas.cpp /Fo:build/obj/canvas.obj
-cl /std:c++17 /W4 /O2 /EHsc /Iinclude /c src/lighting.cpp /Fo:build/obj/lighting.obj
-cl /std:c++17 /W4 /O2 /EHsc /Iinclude /c src/display.cpp /Fo:build/obj/display.obj
-cl /std:c++17 /W4 /O2 /EHsc /Iinclude /c src/math3d.cpp /Fo:build/obj/math3d.obj
-cl /std:c++17 /W4 /O2 /EHsc /Iinclude /c src/renderer.cpp /Fo:build/obj/renderer.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/animation.cpp /Fo:build/obj/animation.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/canvas.cpp /Fo:build/obj/canvas.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/lighting.cpp /Fo:build/obj/lighting.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/display.cpp /Fo:build/obj/display.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/math3d.cpp /Fo:build/obj/math3d.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/renderer.cpp /Fo:build/obj/renderer.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/mesh.cpp /Fo:build/obj/mesh.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/spatial_hash.cpp /Fo:build/obj/spatial_hash.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/mapped_file.cpp /Fo:build/obj/mapped_file.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/mesh_io.cpp /Fo:build/obj/mesh_io.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/mesh_binary.cpp /Fo:build/obj/mesh_binary.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/culling.cpp /Fo:build/obj/culling.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/chunked_scene.cpp /Fo:build/obj/chunked_scene.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/bvh.cpp /Fo:build/obj/bvh.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/lod.cpp /Fo:build/obj/lod.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/edge_reduce.cpp /Fo:build/obj/edge_reduce.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/strips.cpp /Fo:build/obj/strips.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/silhouette.cpp /Fo:build/obj/silhouette.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/raster.cpp /Fo:build/obj/raster.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/hiz.cpp /Fo:build/obj/hiz.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/points.cpp /Fo:build/obj/points.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/transform.cpp /Fo:build/obj/transform.obj
+cl /std:c++17 /W4 /O2 /EHsc /Iinclude %CL_DEFINES% /c src/morph.cpp /Fo:build/obj/morph.obj
 
 if %ERRORLEVEL% NEQ 0 (
     echo Compilation failed!
@@ -97,16 +152,29 @@ lib /OUT:build/lib/tiny3d.lib build/obj/*.obj
 echo Library created: build/lib/tiny3d.lib
 
 echo.s...
-cl /std:c++17 /O2 /EHsc /Iinclude demo/main.cpp build/lib/tiny3d.lib /Fe:build/bin/demo.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% demo/main.cpp build/lib/tiny3d.lib /Fe:build/bin/demo.exe
 echo Demo built: build/bin/demo.exe
-cl /std:c++17 /O2 /EHsc /Iinclude demo/interactive.cpp build/lib/tiny3d.lib /Fe:build/bin/interactive.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% demo/interactive.cpp build/lib/tiny3d.lib /Fe:build/bin/interactive.exe
 echo Interactive demo built: build/bin/interactivede demo/main.cpp build/lib/tiny3d.lib /Fe:build/bin/demo.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% demo/bench_bvh.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_bvh.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% demo/bench_raster.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_raster.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% demo/bench_hiz.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_hiz.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% demo/bench_points.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_points.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% demo/bench_lighting.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_lighting.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% demo/bench_animation.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_animation.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% demo/bench_hierarchy.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_hierarchy.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% demo/bench_morph.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_morph.exe
 echo Demo built: build/bin/demo.exe
 
 echo.
 echo Building tests...
-cl /std:c++17 /O2 /EHsc /Iinclude tests/test_animation.cpp build/lib/tiny3d.lib /Fe:build/bin/test_animation.exe
-cl /std:c++17 /O2 /EHsc /Iinclude tests/test_math.cpp build/lib/tiny3d.lib /Fe:build/bin/test_math.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% tests/test_animation.cpp build/lib/tiny3d.lib /Fe:build/bin/test_animation.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% tests/test_math.cpp build/lib/tiny3d.lib /Fe:build/bin/test_math.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% tests/test_mesh.cpp build/lib/tiny3d.lib /Fe:build/bin/test_mesh.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% tests/test_mesh_io.cpp build/lib/tiny3d.lib /Fe:build/bin/test_mesh_io.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% tests/test_scene.cpp build/lib/tiny3d.lib /Fe:build/bin/test_scene.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% tests/test_raster.cpp build/lib/tiny3d.lib /Fe:build/bin/test_raster.exe
+cl /std:c++17 /O2 /EHsc /Iinclude %CL_DEFINES% tests/test_lighting.cpp build/lib/tiny3d.lib /Fe:build/bin/test_lighting.exe
 echo Tests built!
 
 goto :success
@@ -121,5 +189,10 @@ echo.
 echo To run demo: build\bin\demo.exe
 echo To run tests: build\bin\test_animation.exe
 echo               build\bin\test_math.exe
+echo               build\bin\test_mesh.exe
+echo               build\bin\test_mesh_io.exe
+echo               build\bin\test_scene.exe
+echo               build\bin\test_raster.exe
+echo               build\bin\test_lighting.exe
 echo.
 pause
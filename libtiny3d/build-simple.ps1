@@ -1,6 +1,9 @@
 # Simple Build Script - No Make Required!
 # Just install a C++ compiler (MinGW or Visual Studio)
 
+# .\build-simple.ps1 -DepthCue builds with depth cueing (TINY3D_DEPTH_CUE)
+param([switch]$DepthCue)
+
 $ErrorActionPreference = "Stop"
 
 Write-Host "========================================" -ForegroundColor Cyan
@@ -30,6 +33,13 @@ else {
     exit 1
 }
 
+$defines = @()
+if ($DepthCue) {
+    if ($compiler -eq "g++") { $defines = @("-DTINY3D_DEPTH_CUE") }
+    else { $defines = @("/DTINY3D_DEPTH_CUE") }
+    Write-Host "Depth cueing enabled" -ForegroundColor Green
+}
+
 # Create directories
 Write-Host "Creating build directories..." -ForegroundColor Yellow
 New-Item -ItemType Directory -Force -Path "build/obj" | Out-Null
@@ -44,7 +54,24 @@ $sources = @(
     "src/math3d.cpp",
     "src/renderer.cpp",
     "src/display.cpp",
-    "src/window_display.cpp"
+    "src/window_display.cpp",
+    "src/mesh.cpp",
+    "src/spatial_hash.cpp",
+    "src/mapped_file.cpp",
+    "src/mesh_io.cpp",
+    "src/mesh_binary.cpp",
+    "src/culling.cpp",
+    "src/chunked_scene.cpp",
+    "src/bvh.cpp",
+    "src/lod.cpp",
+    "src/edge_reduce.cpp",
+    "src/strips.cpp",
+    "src/silhouette.cpp",
+    "src/raster.cpp",
+    "src/hiz.cpp",
+    "src/points.cpp",
+    "src/transform.cpp",
+    "src/morph.cpp"
 )
 
 $objects = @()
@@ -59,7 +86,7 @@ if ($compiler -eq "g++") {
         $obj = "build/obj/" + [System.IO.Path]::GetFileNameWithoutExtension($src) + ".o"
         $objects += $obj
         Write-Host "  Compiling: $src" -ForegroundColor Gray
-        & g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c $src -o $obj
+        & g++ -std=c++17 -Wall -Wextra -O2 -Iinclude @defines -c $src -o $obj
         if ($LASTEXITCODE -ne 0) {
             Write-Host "Compilation failed for $src" -ForegroundColor Red
             exit 1
@@ -79,38 +106,103 @@ if ($compiler -eq "g++") {
     # Build demos
     Write-Host ""
     Write-Host "Building demos..." -ForegroundColor Yellow
-    & g++ -std=c++17 -O2 -Iinclude demo/main.cpp build/lib/libtiny3d.a -o build/bin/demo.exe
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/main.cpp build/lib/libtiny3d.a -o build/bin/demo.exe
     if ($LASTEXITCODE -eq 0) {
         Write-Host "Demo built: build/bin/demo.exe" -ForegroundColor Green
     }
     
-    & g++ -std=c++17 -O2 -Iinclude demo/test1_lines.cpp build/lib/libtiny3d.a -lgdi32 -o build/bin/test1_lines.exe
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/test1_lines.cpp build/lib/libtiny3d.a -lgdi32 -o build/bin/test1_lines.exe
     if ($LASTEXITCODE -eq 0) {
         Write-Host "Test 1 built: build/bin/test1_lines.exe" -ForegroundColor Green
     }
     
-    & g++ -std=c++17 -O2 -Iinclude demo/test2_3d_static.cpp build/lib/libtiny3d.a -lgdi32 -o build/bin/test2_3d_static.exe
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/test2_3d_static.cpp build/lib/libtiny3d.a -lgdi32 -o build/bin/test2_3d_static.exe
     if ($LASTEXITCODE -eq 0) {
         Write-Host "Test 2 built: build/bin/test2_3d_static.exe" -ForegroundColor Green
     }
     
-    & g++ -std=c++17 -O2 -Iinclude demo/test3_3d_animated.cpp build/lib/libtiny3d.a -lgdi32 -o build/bin/test3_3d_animated.exe
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/test3_3d_animated.cpp build/lib/libtiny3d.a -lgdi32 -o build/bin/test3_3d_animated.exe
     if ($LASTEXITCODE -eq 0) {
         Write-Host "Test 3 built: build/bin/test3_3d_animated.exe" -ForegroundColor Green
     }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/bench_bvh.cpp build/lib/libtiny3d.a -o build/bin/bench_bvh.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_bvh.exe" -ForegroundColor Green
+    }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/bench_raster.cpp build/lib/libtiny3d.a -o build/bin/bench_raster.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_raster.exe" -ForegroundColor Green
+    }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/bench_hiz.cpp build/lib/libtiny3d.a -o build/bin/bench_hiz.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_hiz.exe" -ForegroundColor Green
+    }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/bench_points.cpp build/lib/libtiny3d.a -o build/bin/bench_points.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_points.exe" -ForegroundColor Green
+    }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/bench_lighting.cpp build/lib/libtiny3d.a -o build/bin/bench_lighting.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_lighting.exe" -ForegroundColor Green
+    }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/bench_animation.cpp build/lib/libtiny3d.a -o build/bin/bench_animation.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_animation.exe" -ForegroundColor Green
+    }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/bench_hierarchy.cpp build/lib/libtiny3d.a -o build/bin/bench_hierarchy.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_hierarchy.exe" -ForegroundColor Green
+    }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines demo/bench_morph.cpp build/lib/libtiny3d.a -o build/bin/bench_morph.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_morph.exe" -ForegroundColor Green
+    }
     
     # Build tests
     Write-Host ""
     Write-Host "Building tests..." -ForegroundColor Yellow
-    & g++ -std=c++17 -O2 -Iinclude tests/test_animation.cpp build/lib/libtiny3d.a -o build/bin/test_animation.exe
+    & g++ -std=c++17 -O2 -Iinclude @defines tests/test_animation.cpp build/lib/libtiny3d.a -o build/bin/test_animation.exe
     if ($LASTEXITCODE -eq 0) {
         Write-Host "Test built: build/bin/test_animation.exe" -ForegroundColor Green
     }
     
-    & g++ -std=c++17 -O2 -Iinclude tests/test_math.cpp build/lib/libtiny3d.a -o build/bin/test_math.exe
+    & g++ -std=c++17 -O2 -Iinclude @defines tests/test_math.cpp build/lib/libtiny3d.a -o build/bin/test_math.exe
     if ($LASTEXITCODE -eq 0) {
         Write-Host "Test built: build/bin/test_math.exe" -ForegroundColor Green
     }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines tests/test_mesh.cpp build/lib/libtiny3d.a -o build/bin/test_mesh.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Test built: build/bin/test_mesh.exe" -ForegroundColor Green
+    }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines tests/test_mesh_io.cpp build/lib/libtiny3d.a -o build/bin/test_mesh_io.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Test built: build/bin/test_mesh_io.exe" -ForegroundColor Green
+    }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines tests/test_scene.cpp build/lib/libtiny3d.a -o build/bin/test_scene.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Test built: build/bin/test_scene.exe" -ForegroundColor Green
+    }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines tests/test_raster.cpp build/lib/libtiny3d.a -o build/bin/test_raster.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Test built: build/bin/test_raster.exe" -ForegroundColor Green
+    }
+
+    & g++ -std=c++17 -O2 -Iinclude @defines tests/test_lighting.cpp build/lib/libtiny3d.a -o build/bin/test_lighting.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Test built: build/bin/test_lighting.exe" -ForegroundColor Green
+    }
     
 }
 elseif ($compiler -eq "cl") {
@@ -119,7 +211,7 @@ elseif ($compiler -eq "cl") {
         $obj = "build/obj/" + [System.IO.Path]::GetFileNameWithoutExtension($src) + ".obj"
         $objects += $obj
         Write-Host "  Compiling: $src" -ForegroundColor Gray
-        & cl /std:c++17 /W4 /O2 /EHsc /Iinclude /c $src /Fo:$obj
+        & cl /std:c++17 /W4 /O2 /EHsc /Iinclude @defines /c $src /Fo:$obj
         if ($LASTEXITCODE -ne 0) {
             Write-Host "Compilation failed for $src" -ForegroundColor Red
             exit 1
@@ -139,28 +231,93 @@ elseif ($compiler -eq "cl") {
     # Build demos
     Write-Host ""
     Write-Host "Building demos..." -ForegroundColor Yellow
-    & cl /std:c++17 /O2 /EHsc /Iinclude demo/main.cpp build/lib/tiny3d.lib /Fe:build/bin/demo.exe
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines demo/main.cpp build/lib/tiny3d.lib /Fe:build/bin/demo.exe
     if ($LASTEXITCODE -eq 0) {
         Write-Host "Demo built: build/bin/demo.exe" -ForegroundColor Green
     }
     
-    & cl /std:c++17 /O2 /EHsc /Iinclude demo/interactive.cpp build/lib/tiny3d.lib /Fe:build/bin/interactive.exe
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines demo/interactive.cpp build/lib/tiny3d.lib /Fe:build/bin/interactive.exe
     if ($LASTEXITCODE -eq 0) {
         Write-Host "Interactive demo built: build/bin/interactive.exe" -ForegroundColor Green
     }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines demo/bench_bvh.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_bvh.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_bvh.exe" -ForegroundColor Green
+    }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines demo/bench_raster.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_raster.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_raster.exe" -ForegroundColor Green
+    }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines demo/bench_hiz.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_hiz.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_hiz.exe" -ForegroundColor Green
+    }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines demo/bench_points.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_points.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_points.exe" -ForegroundColor Green
+    }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines demo/bench_lighting.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_lighting.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_lighting.exe" -ForegroundColor Green
+    }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines demo/bench_animation.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_animation.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_animation.exe" -ForegroundColor Green
+    }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines demo/bench_hierarchy.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_hierarchy.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_hierarchy.exe" -ForegroundColor Green
+    }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines demo/bench_morph.cpp build/lib/tiny3d.lib /Fe:build/bin/bench_morph.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Demo built: build/bin/bench_morph.exe" -ForegroundColor Green
+    }
     
     # Build tests
     Write-Host ""
     Write-Host "Building tests..." -ForegroundColor Yellow
-    & cl /std:c++17 /O2 /EHsc /Iinclude tests/test_animation.cpp build/lib/tiny3d.lib /Fe:build/bin/test_animation.exe
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines tests/test_animation.cpp build/lib/tiny3d.lib /Fe:build/bin/test_animation.exe
     if ($LASTEXITCODE -eq 0) {
         Write-Host "Test built: build/bin/test_animation.exe" -ForegroundColor Green
     }
     
-    & cl /std:c++17 /O2 /EHsc /Iinclude tests/test_math.cpp build/lib/tiny3d.lib /Fe:build/bin/test_math.exe
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines tests/test_math.cpp build/lib/tiny3d.lib /Fe:build/bin/test_math.exe
     if ($LASTEXITCODE -eq 0) {
         Write-Host "Test built: build/bin/test_math.exe" -ForegroundColor Green
     }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines tests/test_mesh.cpp build/lib/tiny3d.lib /Fe:build/bin/test_mesh.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Test built: build/bin/test_mesh.exe" -ForegroundColor Green
+    }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines tests/test_mesh_io.cpp build/lib/tiny3d.lib /Fe:build/bin/test_mesh_io.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Test built: build/bin/test_mesh_io.exe" -ForegroundColor Green
+    }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines tests/test_scene.cpp build/lib/tiny3d.lib /Fe:build/bin/test_scene.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Test built: build/bin/test_scene.exe" -ForegroundColor Green
+    }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines tests/test_raster.cpp build/lib/tiny3d.lib /Fe:build/bin/test_raster.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Test built: build/bin/test_raster.exe" -ForegroundColor Green
+    }
+
+    & cl /std:c++17 /O2 /EHsc /Iinclude @defines tests/test_lighting.cpp build/lib/tiny3d.lib /Fe:build/bin/test_lighting.exe
+    if ($LASTEXITCODE -eq 0) {
+        Write-Host "Test built: build/bin/test_lighting.exe" -ForegroundColor Green
+    }
 }
 
 Write-Host ""
@@ -184,4 +341,9 @@ Write-Host ""
 Write-Host "To run tests:" -ForegroundColor Cyan
 Write-Host "  .\build\bin\test_animation.exe" -ForegroundColor White
 Write-Host "  .\build\bin\test_math.exe" -ForegroundColor White
+Write-Host "  .\build\bin\test_mesh.exe" -ForegroundColor White
+Write-Host "  .\build\bin\test_mesh_io.exe" -ForegroundColor White
+Write-Host "  .\build\bin\test_scene.exe" -ForegroundColor White
+Write-Host "  .\build\bin\test_raster.exe" -ForegroundColor White
+Write-Host "  .\build\bin\test_lighting.exe" -ForegroundColor White
 Write-Host ""
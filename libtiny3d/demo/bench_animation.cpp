@@ -0,0 +1,234 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "math3d.h"
+#include "animation.h"
+
+/* =========================================================
+   Keyframe sampling: 10k instances playing one 256-key clip
+   at different phases. Per-sample binary search vs cached
+   cursors, then the full batch sampler to model matrices.
+   Then the same instances moving at constant speed along a
+   path: chord-sum integration each frame vs BezierPath.
+   Last, rotations: rotation_xyz vs composed quaternions, and
+   slerp vs slerp_fast vs slerp_batch.
+   ========================================================= */
+
+static const int INSTANCES = 10000;
+static const int KEYS = 256;
+static const int FRAMES = 100;
+
+static double ms_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static float frand(float lo, float hi)
+{
+    return lo + (hi - lo) * (std::rand() / (float)RAND_MAX);
+}
+
+int main()
+{
+    std::srand(1);
+    std::vector<float> times(KEYS), quats(KEYS * 4);
+    std::vector<vec3_t> points(KEYS), scales(KEYS);
+    for (int k = 0; k < KEYS; k++)
+    {
+        times[k] = k * 0.25f;
+        points[k] = vec3_t(frand(-10, 10), frand(0, 5), frand(-10, 10));
+        scales[k] = vec3_t(frand(0.5f, 2), frand(0.5f, 2), frand(0.5f, 2));
+        float angle = k * 0.3f;
+        quats[k * 4] = 0.0f;
+        quats[k * 4 + 1] = std::sin(angle * 0.5f);
+        quats[k * 4 + 2] = 0.0f;
+        quats[k * 4 + 3] = std::cos(angle * 0.5f);
+    }
+
+    AnimationClip clip;
+    clip.position.set_vec3(times.data(), points.data(), KEYS, KEY_BEZIER);
+    clip.rotation.set_rotation(times.data(), quats.data(), KEYS);
+    clip.scale.set_vec3(times.data(), scales.data(), KEYS, KEY_LINEAR);
+
+    std::vector<AnimatedInstance> crowd(INSTANCES);
+    for (int i = 0; i < INSTANCES; i++)
+        crowd[i] = {&clip, frand(0, clip.duration()), {0, 0, 0}};
+
+    const float dt = 1.0f / 60.0f;
+    float sink = 0.0f;
+    float value[4];
+
+    // ---- One track, binary search per sample ----
+    std::vector<float> phase(INSTANCES);
+    for (int i = 0; i < INSTANCES; i++)
+        phase[i] = crowd[i].time;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+        for (int i = 0; i < INSTANCES; i++)
+        {
+            clip.position.sample(std::fmod(phase[i] + f * dt, clip.duration()), value);
+            sink += value[0];
+        }
+    double search_ms = ms_since(start) / FRAMES;
+
+    // ---- Same with cursors ----
+    std::vector<int> cursors(INSTANCES, 0);
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+        for (int i = 0; i < INSTANCES; i++)
+        {
+            clip.position.sample(std::fmod(phase[i] + f * dt, clip.duration()), cursors[i], value);
+            sink += value[0];
+        }
+    double cursor_ms = ms_since(start) / FRAMES;
+
+    // ---- Full clip to model matrices ----
+    std::vector<mat4> models(INSTANCES);
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+    {
+        for (AnimatedInstance &inst : crowd)
+            inst.time += dt;
+        sample_animation(crowd.data(), INSTANCES, models.data());
+        sink += models[f].m[12];
+    }
+    double batch_ms = ms_since(start) / FRAMES;
+
+    // ---- Constant speed along a 16-segment path ----
+    std::vector<vec3_t> controls(16 * 3 + 1);
+    for (vec3_t &c : controls)
+        c = vec3_t(frand(-20, 20), frand(0, 5), frand(-20, 20));
+    BezierPath path;
+    start = std::chrono::steady_clock::now();
+    path.build(controls.data(), (int)controls.size());
+    double build_ms = ms_since(start);
+
+    const int INTEGRATION_STEPS = 64; // chord steps per segment
+    std::vector<float> distance(INSTANCES), xyz(INSTANCES * 3);
+    for (int i = 0; i < INSTANCES; i++)
+        distance[i] = frand(0, path.length() * 0.5f);
+
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < 10; f++)
+        for (int i = 0; i < INSTANCES; i++)
+        {
+            // Walk chords from the start until the distance is covered
+            float d = distance[i] + f * 0.1f, walked = 0.0f, t = 0.0f;
+            vec3_t prev = path.position(0.0f);
+            for (int s = 1; s <= path.segment_count() * INTEGRATION_STEPS; s++)
+            {
+                vec3_t p = path.position(s / (float)INTEGRATION_STEPS);
+                float dx = p.x - prev.x, dy = p.y - prev.y, dz = p.z - prev.z;
+                walked += std::sqrt(dx * dx + dy * dy + dz * dz);
+                prev = p;
+                t = s / (float)INTEGRATION_STEPS;
+                if (walked >= d)
+                    break;
+            }
+            sink += path.position(t).x;
+        }
+    double integrate_ms = ms_since(start) / 10;
+
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+    {
+        for (float &d : distance)
+            d += 0.1f;
+        path.evaluate_at(distance.data(), INSTANCES, xyz.data());
+        sink += xyz[f * 3];
+    }
+    double table_ms = ms_since(start) / FRAMES;
+
+    std::vector<float> dense((16 * 1000 + 1) * 3);
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+        for (int i = 0; i <= 16 * 1000; i++)
+        {
+            vec3_t p = path.position(i / 1000.0f);
+            dense[i * 3] = p.x;
+            sink += dense[i * 3];
+        }
+    double direct_ms = ms_since(start) / FRAMES;
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+    {
+        path.evaluate_uniform(1000, dense.data());
+        sink += dense[f * 3];
+    }
+    double fd_ms = ms_since(start) / FRAMES;
+
+    // ---- Rotations: Euler matrices vs quaternion composition ----
+    std::vector<mat4> rotations(INSTANCES);
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+        for (int i = 0; i < INSTANCES; i++)
+            rotations[i] = mat4::rotation_xyz(phase[i] + f * 0.01f, f * 0.02f, 0.5f);
+    double euler_ms = ms_since(start) / FRAMES;
+    sink += rotations[0].m[0];
+
+    std::vector<quat> spins(INSTANCES, quat::identity());
+    quat step = multiply(quat::axis_angle(vec3_t(1, 0, 0), 0.01f), quat::axis_angle(vec3_t(0, 1, 0), 0.02f));
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+        for (int i = 0; i < INSTANCES; i++)
+        {
+            spins[i] = multiply(step, spins[i]);
+            rotations[i] = spins[i].to_matrix();
+        }
+    double quat_ms = ms_since(start) / FRAMES;
+    sink += rotations[0].m[0];
+
+    std::vector<quat> qa(INSTANCES), qb(INSTANCES), qout(INSTANCES);
+    std::vector<float> qt(INSTANCES);
+    std::vector<vec3_t> va(INSTANCES), vb(INSTANCES);
+    for (int i = 0; i < INSTANCES; i++)
+    {
+        qa[i] = quat::axis_angle(vec3_t(frand(-1, 1), frand(-1, 1), frand(-1, 1)), frand(0, 6.28f));
+        qb[i] = quat::axis_angle(vec3_t(frand(-1, 1), frand(-1, 1), frand(-1, 1)), frand(0, 6.28f));
+        va[i] = vec3_t(qa[i].x, qa[i].y, qa[i].z);
+        vb[i] = vec3_t(qb[i].x, qb[i].y, qb[i].z);
+        qt[i] = frand(0, 1);
+    }
+    double slerp_ms[4];
+    for (int mode = 0; mode < 4; mode++)
+    {
+        start = std::chrono::steady_clock::now();
+        for (int f = 0; f < FRAMES; f++)
+        {
+            if (mode == 0)
+                for (int i = 0; i < INSTANCES; i++)
+                    sink += vec3_t::slerp(va[i], vb[i], qt[i]).x;
+            else if (mode == 1)
+                for (int i = 0; i < INSTANCES; i++)
+                    qout[i] = slerp(qa[i], qb[i], qt[i]);
+            else if (mode == 2)
+                for (int i = 0; i < INSTANCES; i++)
+                    qout[i] = slerp_fast(qa[i], qb[i], qt[i]);
+            else
+                slerp_batch(qa.data(), qb.data(), qt.data(), INSTANCES, qout.data());
+            sink += qout[f].w;
+        }
+        slerp_ms[mode] = ms_since(start) / FRAMES;
+    }
+
+    std::cout << INSTANCES << " instances, " << KEYS << " keys per track\n";
+    std::cout << "bezier track, binary search " << search_ms << " ms/frame\n";
+    std::cout << "bezier track, cursors       " << cursor_ms << " ms/frame\n";
+    std::cout << "sample_animation (3 tracks) " << batch_ms << " ms/frame\n";
+    std::cout << "\npath of " << path.segment_count() << " segments, length " << path.length()
+              << " (table built in " << build_ms << " ms)\n";
+    std::cout << "constant speed, chord integration " << integrate_ms << " ms/frame\n";
+    std::cout << "constant speed, arc-length table  " << table_ms << " ms/frame\n";
+    std::cout << "16k samples, position(t)          " << direct_ms << " ms\n";
+    std::cout << "16k samples, forward differencing " << fd_ms << " ms\n";
+    std::cout << "\n" << INSTANCES << " rotations per frame\n";
+    std::cout << "mat4::rotation_xyz          " << euler_ms << " ms\n";
+    std::cout << "quat multiply + to_matrix   " << quat_ms << " ms\n";
+    std::cout << "vec3_t::slerp               " << slerp_ms[0] << " ms\n";
+    std::cout << "slerp                       " << slerp_ms[1] << " ms\n";
+    std::cout << "slerp_fast                  " << slerp_ms[2] << " ms\n";
+    std::cout << "slerp_batch                 " << slerp_ms[3] << " ms\n";
+    return sink != 0.0f ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "math3d.h"
+#include "mesh.h"
+#include "culling.h"
+#include "bvh.h"
+
+/* =========================================================
+   BVH vs brute force: frustum culling and edge picking over
+   100k objects scattered through a large volume.
+   ========================================================= */
+
+static const int OBJECT_COUNT = 100000;
+static const int FRAMES = 50;
+
+static double ms_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    vec3_t cube[8] = {
+        {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+        {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}};
+    const int cube_edges[12][2] = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+    Mesh cube_mesh;
+    cube_mesh.build(cube, 8, cube_edges, 12);
+
+    std::srand(1);
+    std::vector<SceneObject> objects(OBJECT_COUNT);
+    for (SceneObject &obj : objects)
+    {
+        obj.mesh = &cube_mesh;
+        obj.model = multiply(
+            mat4::translation(
+                (std::rand() % 10000) * 0.1f - 500.0f,
+                (std::rand() % 10000) * 0.1f - 500.0f,
+                (std::rand() % 10000) * -0.1f),
+            mat4::scale(0.5f, 0.5f, 0.5f));
+    }
+
+    mat4 view = mat4::identity();
+    mat4 projection = mat4::frustumAssymetric(-0.2f, 0.2f, -0.2f, 0.2f, 1, 500);
+    Frustum frustum = Frustum::from_matrix(multiply(projection, view));
+
+    // ---- Build / refit ----
+    SceneBVH bvh;
+    auto start = std::chrono::steady_clock::now();
+    bvh.build(objects.data(), OBJECT_COUNT);
+    double build_ms = ms_since(start);
+
+    start = std::chrono::steady_clock::now();
+    bvh.refit(objects.data());
+    double refit_ms = ms_since(start);
+
+    std::cout << "objects " << OBJECT_COUNT << ", nodes " << bvh.node_count() << "\n";
+    std::cout << "build  " << build_ms << " ms, refit " << refit_ms << " ms\n\n";
+
+    // ---- Frustum culling ----
+    std::vector<int> visible(OBJECT_COUNT);
+    int brute_count = 0;
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+        brute_count = cull_objects(objects.data(), OBJECT_COUNT, frustum, visible.data());
+    double brute_ms = ms_since(start) / FRAMES;
+
+    std::vector<int> hits;
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+    {
+        hits.clear();
+        bvh.query_frustum(frustum, hits);
+    }
+    double bvh_ms = ms_since(start) / FRAMES;
+
+    std::cout << "frustum: " << brute_count << " / " << hits.size() << " visible\n";
+    std::cout << "  brute " << brute_ms << " ms, bvh " << bvh_ms << " ms ("
+              << brute_ms / bvh_ms << "x)\n\n";
+
+    // ---- Picking ----
+    const int RAYS = 200;
+    int agree = 0;
+    double brute_pick_ms = 0.0;
+    double bvh_pick_ms = 0.0;
+    for (int r = 0; r < RAYS; r++)
+    {
+        float origin[3], dir[3];
+        ray_from_screen(view, projection, (float)(std::rand() % 800), (float)(std::rand() % 800), 800, 800, origin, dir);
+
+        start = std::chrono::steady_clock::now();
+        EdgePick brute = {-1, -1, 0.0f, 1e30f};
+        for (int i = 0; i < OBJECT_COUNT; i++)
+            pick_object_edge(objects[i], i, origin, dir, 0.05f, brute);
+        brute_pick_ms += ms_since(start);
+
+        start = std::chrono::steady_clock::now();
+        EdgePick fast = bvh.pick_edge(objects.data(), origin, dir, 0.05f);
+        bvh_pick_ms += ms_since(start);
+
+        if (brute.object == fast.object && brute.edge == fast.edge)
+            agree++;
+    }
+
+    std::cout << "picking: " << agree << " / " << RAYS << " rays agree\n";
+    std::cout << "  brute " << brute_pick_ms / RAYS << " ms, bvh " << bvh_pick_ms / RAYS << " ms ("
+              << brute_pick_ms / bvh_pick_ms << "x)\n";
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "math3d.h"
+#include "transform.h"
+
+/* =========================================================
+   Transform hierarchy: 200 articulated rigs of 64 joints in
+   chains up to 16 deep; each frame a few joints per rig
+   move. Walking every node's parent chain vs one full pass
+   vs the dirty-subtree update.
+   ========================================================= */
+
+static const int RIGS = 200;
+static const int JOINTS = 64;
+static const int MOVING = 2; // joints moved per rig per frame
+static const int FRAMES = 100;
+
+static double ms_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    std::srand(1);
+    TransformHierarchy scene;
+    for (int r = 0; r < RIGS; r++)
+    {
+        int root = scene.add(-1, mat4::translation((r % 20) * 3.0f, 0, -(r / 20) * 3.0f));
+        // Four limbs of sixteen joints hanging off the root
+        for (int limb = 0; limb < 4; limb++)
+        {
+            int parent = root;
+            for (int j = 0; j < JOINTS / 4 - (limb == 0); j++)
+                parent = scene.add(parent, multiply(mat4::translation(0.2f, 0, 0), mat4::rotation_xyz(0, 0, 0.1f)));
+        }
+    }
+    int nodes = scene.size();
+    scene.update();
+
+    std::vector<int> moved;
+    for (int f = 0; f < FRAMES; f++)
+        for (int r = 0; r < RIGS * MOVING; r++)
+            moved.push_back(std::rand() % nodes);
+
+    // ---- Baseline: each node multiplies up its own parent chain ----
+    std::vector<mat4> worlds(nodes);
+    float sink = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+    {
+        for (int i = 0; i < nodes; i++)
+        {
+            mat4 m = scene.local(i);
+            for (int p = scene.parent(i); p >= 0; p = scene.parent(p))
+                m = multiply(scene.local(p), m);
+            worlds[i] = m;
+        }
+        sink += worlds[f].m[12];
+    }
+    double chain_ms = ms_since(start) / FRAMES;
+
+    // ---- One forward pass over every node ----
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+    {
+        for (int i = 0; i < nodes; i++)
+        {
+            int p = scene.parent(i);
+            worlds[i] = p < 0 ? scene.local(i) : multiply(worlds[p], scene.local(i));
+        }
+        sink += worlds[f].m[12];
+    }
+    double full_ms = ms_since(start) / FRAMES;
+
+    // ---- Dirty subtrees only ----
+    long long written = 0;
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+    {
+        for (int k = 0; k < RIGS * MOVING; k++)
+        {
+            int node = moved[f * RIGS * MOVING + k];
+            scene.set_local(node, multiply(scene.local(node), mat4::rotation_xyz(0, 0, 0.001f)));
+        }
+        written += scene.update();
+        sink += scene.world(f).m[12];
+    }
+    double dirty_ms = ms_since(start) / FRAMES;
+
+    std::cout << nodes << " nodes, " << RIGS * MOVING << " joints moved per frame\n";
+    std::cout << "parent chain per node " << chain_ms << " ms/frame\n";
+    std::cout << "full forward pass     " << full_ms << " ms/frame\n";
+    std::cout << "dirty subtrees        " << dirty_ms << " ms/frame (" << written / FRAMES
+              << " world matrices per frame)\n";
+    return sink != 0.0f ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "math3d.h"
+#include "canvas.h"
+#include "mesh.h"
+#include "culling.h"
+#include "raster.h"
+#include "hiz.h"
+
+/* =========================================================
+   Hierarchical-Z occlusion culling: a 60x60 grid of blocks
+   seen at street level from behind a row of large walls.
+   Frustum culling alone vs frustum + Hi-Z before drawing.
+   ========================================================= */
+
+static const int WIDTH = 960;
+static const int HEIGHT = 540;
+static const int GRID = 60;
+static const int FRAMES = 10;
+
+static double ms_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    float cube_xyz[24] = {
+        -1, -1, -1, 1, -1, -1, 1, 1, -1, -1, 1, -1,
+        -1, -1, 1, 1, -1, 1, 1, 1, 1, -1, 1, 1};
+    const int sizes[6] = {4, 4, 4, 4, 4, 4};
+    const int quads[24] = {
+        0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4,
+        1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7};
+    Mesh cube;
+    cube.build(cube_xyz, 8, nullptr, 0, sizes, 6, quads);
+
+    std::srand(1);
+    std::vector<SceneObject> objects;
+    for (int z = 0; z < GRID; z++)
+        for (int x = 0; x < GRID; x++)
+        {
+            float height = 1.0f + (std::rand() % 40) * 0.1f;
+            objects.push_back({&cube, multiply(
+                                          mat4::translation((x - GRID / 2) * 6.0f, height - 2.0f, -20.0f - z * 6.0f),
+                                          mat4::scale(2, height, 2))});
+        }
+
+    // Occluders: walls across the street ahead, drawn with the scene too
+    std::vector<SceneObject> walls;
+    for (int i = -3; i <= 3; i++)
+        walls.push_back({&cube, multiply(mat4::translation(i * 16.0f, 6.0f, -12.0f), mat4::scale(7.5f, 8.0f, 0.5f))});
+    int first_wall = (int)objects.size();
+    objects.insert(objects.end(), walls.begin(), walls.end());
+
+    mat4 view = mat4::identity();
+    mat4 projection = mat4::frustumAssymetric(-0.8f, 0.8f, -0.45f, 0.45f, 1, 500);
+    Frustum frustum = Frustum::from_matrix(multiply(projection, view));
+    Light light = {vec3_t(-0.3f, -1, -0.5f), 0.9f};
+    SolidOptions options = default_solid_options();
+
+    Canvas canvas(WIDTH, HEIGHT);
+    DepthBuffer depth(WIDTH, HEIGHT);
+    std::vector<int> in_frustum(objects.size());
+    std::vector<int> unoccluded(objects.size());
+
+    // ---- Frustum culling only ----
+    int frustum_count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+    {
+        depth.clear();
+        frustum_count = cull_objects(objects.data(), (int)objects.size(), frustum, in_frustum.data());
+        for (int i = 0; i < frustum_count; i++)
+            render_mesh_solid(canvas, depth, *objects[in_frustum[i]].mesh, objects[in_frustum[i]].model,
+                              view, projection, &light, 1, options);
+    }
+    double plain_ms = ms_since(start) / FRAMES;
+
+    // ---- Frustum + Hi-Z from the occluders at quarter resolution ----
+    HiZBuffer hiz;
+    OcclusionStats occlusion = {};
+    double build_ms = 0.0;
+    int drawn = 0;
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+    {
+        depth.clear();
+        auto build_start = std::chrono::steady_clock::now();
+        hiz.build_from_occluders(walls.data(), (int)walls.size(), view, projection, WIDTH / 4, HEIGHT / 4);
+        build_ms += ms_since(build_start);
+
+        int candidates = cull_objects(objects.data(), first_wall, frustum, in_frustum.data());
+        drawn = occlusion_cull(hiz, objects.data(), in_frustum.data(), candidates, view, projection,
+                               unoccluded.data(), &occlusion);
+        for (int i = 0; i < drawn; i++)
+            render_mesh_solid(canvas, depth, *objects[unoccluded[i]].mesh, objects[unoccluded[i]].model,
+                              view, projection, &light, 1, options);
+        for (const SceneObject &wall : walls)
+            render_mesh_solid(canvas, depth, *wall.mesh, wall.model, view, projection, &light, 1, options);
+    }
+    double hiz_ms = ms_since(start) / FRAMES;
+    build_ms /= FRAMES;
+
+    std::cout << "objects " << objects.size() << ", in frustum " << frustum_count << "\n";
+    std::cout << "hi-z: " << occlusion.occluded << " of " << occlusion.tested << " occluded, "
+              << drawn + (int)walls.size() << " drawn, " << hiz.level_count() << " levels\n\n";
+    std::cout << "frustum only  " << plain_ms << " ms/frame\n";
+    std::cout << "frustum + hiz " << hiz_ms << " ms/frame (pyramid " << build_ms << " ms)\n";
+    std::cout << "saved         " << plain_ms - hiz_ms << " ms/frame\n";
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "math3d.h"
+#include "lighting.h"
+#include "mesh.h"
+#include "canvas.h"
+#include "renderer.h"
+
+/* =========================================================
+   Edge lighting: 16 directional lights over 50k edges,
+   lambert_edge_multi per edge vs the SoA batch path, then
+   a lit wireframe under a moving camera with and without
+   the per-mesh intensity cache, then 100-800 point and spot
+   lights over a city-sized area, brute force vs LightGrid,
+   then 16-1024 directional lights, batch vs LightSH.
+   ========================================================= */
+
+static const int EDGES = 50000;
+static const int LIGHTS = 16;
+static const int FRAMES = 20;
+
+static double ms_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static float frand(float lo, float hi)
+{
+    return lo + (hi - lo) * (std::rand() / (float)RAND_MAX);
+}
+
+int main()
+{
+    std::srand(1);
+    std::vector<Light> lights(LIGHTS);
+    for (Light &l : lights)
+    {
+        l.direction = vec3_t(frand(-1, 1), frand(-1, 1), frand(-1, 1));
+        l.direction.normalize_fast();
+        l.intensity = frand(0.05f, 0.2f);
+    }
+
+    std::vector<vec3_t> a(EDGES), b(EDGES);
+    std::vector<float> soa[6];
+    for (int e = 0; e < EDGES; e++)
+    {
+        a[e] = vec3_t(frand(-10, 10), frand(-10, 10), frand(-10, 10));
+        b[e] = vec3_t(frand(-10, 10), frand(-10, 10), frand(-10, 10));
+        soa[0].push_back(a[e].x);
+        soa[1].push_back(a[e].y);
+        soa[2].push_back(a[e].z);
+        soa[3].push_back(b[e].x);
+        soa[4].push_back(b[e].y);
+        soa[5].push_back(b[e].z);
+    }
+
+    std::vector<float> out(EDGES);
+    float sink = 0.0f;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+        for (int e = 0; e < EDGES; e++)
+            out[e] = lambert_edge_multi(a[e], b[e], lights.data(), LIGHTS);
+    double scalar_ms = ms_since(start) / FRAMES;
+    sink += out[EDGES / 2];
+
+    LightBatch batch;
+    batch.assign(lights.data(), LIGHTS);
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++)
+        lambert_edges_batch(soa[0].data(), soa[1].data(), soa[2].data(),
+                            soa[3].data(), soa[4].data(), soa[5].data(), EDGES, batch, out.data());
+    double batch_ms = ms_since(start) / FRAMES;
+    sink += out[EDGES / 2];
+
+    std::cout << EDGES << " edges, " << LIGHTS << " lights\n";
+    std::cout << "lambert_edge_multi  " << scalar_ms << " ms\n";
+    std::cout << "lambert_edges_batch " << batch_ms << " ms (" << scalar_ms / batch_ms << "x)\n";
+
+    // ---- Lit wireframe, static mesh, moving camera ----
+    std::vector<vec3_t> points;
+    std::vector<int> pairs;
+    for (int e = 0; e < EDGES; e++)
+    {
+        points.push_back(a[e]);
+        points.push_back(b[e]);
+        pairs.push_back(e * 2);
+        pairs.push_back(e * 2 + 1);
+    }
+    Mesh mesh;
+    mesh.build(points.data(), (int)points.size(), reinterpret_cast<const int(*)[2]>(pairs.data()), EDGES);
+
+    Canvas canvas(800, 600);
+    mat4 model = mat4::scale(0.1f, 0.1f, 0.1f);
+    mat4 projection = mat4::frustumAssymetric(-1, 1, -0.75f, 0.75f, 1, 50);
+    EdgeLightCache cache;
+
+    double timings[2];
+    for (int cached = 1; cached >= 0; cached--)
+    {
+        start = std::chrono::steady_clock::now();
+        for (int f = 0; f < FRAMES; f++)
+        {
+            if (!cached)
+                cache.invalidate();
+            mat4 view = multiply(mat4::translation(0, 0, -4), mat4::rotation_xyz(0, 0.05f * f, 0));
+            renderer_wireframe_lit(canvas, mesh, cache, model, view, projection, lights.data(), LIGHTS, 800, 600);
+        }
+        timings[cached] = ms_since(start) / FRAMES;
+    }
+    std::cout << "\nlit wireframe, cache rebuilt each frame " << timings[0] << " ms/frame\n";
+    std::cout << "lit wireframe, cached                   " << timings[1] << " ms/frame\n";
+
+    // ---- Hundreds of local lights ----
+    std::vector<float> city_xyz((size_t)EDGES * 6);
+    std::vector<uint32_t> city_pairs((size_t)EDGES * 2);
+    for (int e = 0; e < EDGES; e++)
+    {
+        float c[3] = {frand(-200, 200), frand(0, 20), frand(-200, 200)};
+        for (int k = 0; k < 3; k++)
+        {
+            city_xyz[e * 6 + k] = c[k];
+            city_xyz[e * 6 + 3 + k] = c[k] + frand(-2, 2);
+        }
+        city_pairs[e * 2] = e * 2;
+        city_pairs[e * 2 + 1] = e * 2 + 1;
+    }
+
+    std::cout << "\n" << EDGES << " edges over 400 x 400 units, lights of range 6-15:\n";
+    for (int count = 100; count <= 800; count *= 2)
+    {
+        std::vector<Light> local;
+        for (int i = 0; i < count; i++)
+        {
+            vec3_t at(frand(-200, 200), frand(2, 20), frand(-200, 200));
+            if (i % 4 == 0)
+                local.push_back(Light::spot(at, vec3_t(0, -1, 0), 0.8f, frand(6, 15), 0.4f, 0.8f));
+            else
+                local.push_back(Light::point(at, 0.6f, frand(6, 15)));
+        }
+
+        start = std::chrono::steady_clock::now();
+        for (int e = 0; e < EDGES; e++)
+        {
+            const float *p = &city_xyz[e * 6];
+            out[e] = lambert_edge_multi(vec3_t(p[0], p[1], p[2]), vec3_t(p[3], p[4], p[5]), local.data(), count);
+        }
+        double brute_ms = ms_since(start);
+        sink += out[EDGES / 2];
+
+        LightGrid grid;
+        LightGridStats stats;
+        start = std::chrono::steady_clock::now();
+        grid.build(local.data(), count);
+        double build_ms = ms_since(start);
+        start = std::chrono::steady_clock::now();
+        grid.shade_edges(city_xyz.data(), city_pairs.data(), EDGES, out.data(), &stats);
+        double grid_ms = ms_since(start);
+        sink += out[EDGES / 2];
+
+        std::cout << "  " << count << " lights: brute " << brute_ms << " ms, grid " << grid_ms
+                  << " ms + build " << build_ms << " ms, "
+                  << stats.light_tests / (double)EDGES << " lights tested per edge\n";
+    }
+
+    // ---- Many directional lights: exact batch vs nine SH coefficients ----
+    std::cout << "\n" << EDGES << " edges, directional lights of total intensity 2:\n";
+    std::vector<float> exact(EDGES);
+    for (int count = 16; count <= 1024; count *= 4)
+    {
+        std::vector<Light> sky(count);
+        for (Light &l : sky)
+        {
+            l.direction = vec3_t(frand(-1, 1), frand(-1, 1), frand(-1, 1));
+            l.direction.normalize_fast();
+            l.intensity = 2.0f / count;
+        }
+
+        batch.assign(sky.data(), count);
+        start = std::chrono::steady_clock::now();
+        lambert_edges_batch(soa[0].data(), soa[1].data(), soa[2].data(),
+                            soa[3].data(), soa[4].data(), soa[5].data(), EDGES, batch, exact.data());
+        double exact_ms = ms_since(start);
+
+        LightSH sh;
+        start = std::chrono::steady_clock::now();
+        sh.project(sky.data(), count);
+        double project_ms = ms_since(start);
+        start = std::chrono::steady_clock::now();
+        lambert_edges_sh(soa[0].data(), soa[1].data(), soa[2].data(),
+                         soa[3].data(), soa[4].data(), soa[5].data(), EDGES, sh, out.data());
+        double sh_ms = ms_since(start);
+
+        double mean = 0.0, worst = 0.0;
+        for (int e = 0; e < EDGES; e++)
+        {
+            double error = std::abs(out[e] - exact[e]);
+            mean += error / EDGES;
+            worst = std::max(worst, error);
+        }
+        sink += out[EDGES / 2];
+
+        std::cout << "  " << count << " lights: batch " << exact_ms << " ms, sh " << sh_ms
+                  << " ms + project " << project_ms << " ms, error mean " << mean << " max " << worst << "\n";
+    }
+
+    return sink > 0.0f ? 0 : 1;
+}
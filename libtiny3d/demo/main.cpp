@@ -1,9 +1,10 @@
 #include <cmath>
 #include <vector>
-#include <utility>
 #include "math3d.h"
 #include "renderer.h"
 #include "canvas.h"
+#include "mesh.h"
+#include "spatial_hash.h"
 
 /* =========================================================
    CONFIG
@@ -25,16 +26,19 @@ static vec3_t ico_vertices[12] = {
 
 /* -------- Icosahedron edges (30 total) -------- */
 static const int ico_edges[30][2] = {
-    {0, 1}, {0, 5}, {0, 7}, {0, 10}, {0, 11}, {1, 5}, {1, 7}, {1, 8}, {1, 9}, {2, 3}, {2, 4}, {2, 6}, {2, 10}, {2, 11}, {3, 4}, {3, 6}, {3, 8}, {3, 9}, {4, 5}, {4, 9}, {4, 11}, {5, 9}, {5, 11}, {6, 7}, {6, 8}, {7, 8}, {7, 10}, {8, 9}, {10, 11}};
+    {0, 1}, {0, 5}, {0, 7}, {0, 10}, {0, 11}, {1, 5}, {1, 7}, {1, 8}, {1, 9}, {2, 3}, {2, 4}, {2, 6}, {2, 10}, {2, 11}, {3, 4}, {3, 6}, {3, 8}, {3, 9}, {4, 5}, {4, 9}, {4, 11}, {5, 9}, {5, 11}, {6, 7}, {6, 8}, {6, 10}, {7, 8}, {7, 10}, {8, 9}, {10, 11}};
 
 /* =========================================================
    GENERATE SOCCER BALL GEOMETRY
    ========================================================= */
 
 void generate_soccer_ball(
-    std::vector<vec3_t> &out_vertices,
-    std::vector<std::pair<int, int>> &out_edges)
+    std::vector<float> &out_vertices,
+    std::vector<int> &out_edges)
 {
+    std::vector<float> points;
+    std::vector<int> remap;
+
     out_vertices.clear();
     out_edges.clear();
 
@@ -61,27 +65,15 @@ void generate_soccer_ball(
         v1.normalize_fast();
         v2.normalize_fast();
 
-        out_vertices.push_back(v1);
-        out_vertices.push_back(v2);
+        points.insert(points.end(), {v1.x, v1.y, v1.z, v2.x, v2.y, v2.z});
     }
 
-    /* ---- Build edges automatically (distance test) ---- */
-    const float EDGE_DIST2 = 0.30f; // tuned for truncated icosahedron
+    /* ---- Merge coincident points, then connect neighbours ---- */
+    const float WELD_EPS = 1e-4f;
+    const float EDGE_DIST = sqrtf(0.30f); // tuned for truncated icosahedron
 
-    int n = (int)out_vertices.size();
-    for (int i = 0; i < n; i++)
-    {
-        for (int j = i + 1; j < n; j++)
-        {
-            float dx = out_vertices[i].x - out_vertices[j].x;
-            float dy = out_vertices[i].y - out_vertices[j].y;
-            float dz = out_vertices[i].z - out_vertices[j].z;
-
-            float d2 = dx * dx + dy * dy + dz * dz;
-            if (d2 < EDGE_DIST2)
-                out_edges.push_back({i, j});
-        }
-    }
+    weld_vertices(points.data(), (int)points.size() / 3, WELD_EPS, out_vertices, remap);
+    connect_points_within(out_vertices.data(), (int)out_vertices.size() / 3, EDGE_DIST, out_edges);
 }
 
 /* =========================================================
@@ -91,18 +83,18 @@ void generate_soccer_ball(
 int main()
 {
     /* -------- Generate soccer ball -------- */
-    std::vector<vec3_t> ball_vertices;
-    std::vector<std::pair<int, int>> ball_edges;
+    std::vector<float> ball_vertices;
+    std::vector<int> ball_edges;
 
     generate_soccer_ball(ball_vertices, ball_edges);
 
-    /* Convert edges to renderer format */
-    std::vector<int[2]> edge_list(ball_edges.size());
-    for (size_t i = 0; i < ball_edges.size(); i++)
-    {
-        edge_list[i][0] = ball_edges[i].first;
-        edge_list[i][1] = ball_edges[i].second;
-    }
+    /* Build once: validates indices and drops duplicate/degenerate edges */
+    Mesh ball;
+    ball.build(
+        ball_vertices.data(),
+        (int)ball_vertices.size() / 3,
+        reinterpret_cast<const int(*)[2]>(ball_edges.data()),
+        (int)ball_edges.size() / 2);
 
     /* -------- Camera & Projection -------- */
     mat4 view = mat4::identity();
@@ -131,10 +123,7 @@ int main()
 
         renderer_wireframe(
             canvas,
-            ball_vertices.data(),
-            (int)ball_vertices.size(),
-            edge_list.data(),
-            (int)edge_list.size(),
+            ball,
             model,
             view,
             projection,
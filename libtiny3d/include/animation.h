@@ -1,6 +1,7 @@
 #ifndef ANIMATION_H
 #define ANIMATION_H
 
+#include <vector>
 #include "math3d.h"
 
 vec3_t bezier(
@@ -12,4 +13,141 @@ vec3_t bezier(
 
 float loop_time(float t);
 
+// --------------------
+// Keyframe tracks
+// --------------------
+
+enum KeyInterpolation
+{
+    KEY_LINEAR,
+    KEY_BEZIER, // smooth: Catmull-Rom tangents turned into cubic Bezier handles
+    KEY_SLERP   // rotation tracks (unit quaternions x, y, z, w), slerp_fast
+};
+
+/*
+ * Keyframed vec3 (position, scale) or rotation track. Times and each value
+ * component live in their own arrays. Sampling is clamped to the key range.
+ *
+ * The cursor overload keeps the segment found last time: playback moving
+ * forward (or jumping back to the start of a loop) finds the next segment
+ * in a step or two, falling back to a binary search for large jumps. One
+ * cursor per track per instance; start it at 0.
+ */
+class KeyframeTrack
+{
+public:
+    KeyframeTrack();
+
+    // times must be strictly increasing; returns false (track untouched) otherwise
+    bool set_vec3(const float *times, const vec3_t *values, int count, KeyInterpolation mode);
+    bool set_rotation(const float *times, const float *xyzw, int count);
+    bool set_rotation(const float *times, const quat *keys, int count);
+
+    int key_count() const { return (int)times.size(); }
+    int components() const { return comps; }
+    bool empty() const { return times.empty(); }
+    float start_time() const { return times.empty() ? 0.0f : times.front(); }
+    float end_time() const { return times.empty() ? 0.0f : times.back(); }
+
+    // Writes components() floats; no-op on an empty track
+    void sample(float time, int &cursor, float *out) const;
+    void sample(float time, float *out) const; // binary search every call
+
+    // Rotation tracks: the keys either side of time and the blend between
+    // them, for slerping many instances at once (identity when empty)
+    void rotation_span(float time, int &cursor, quat &a, quat &b, float &t) const;
+
+private:
+    int segment(float time, int hint) const;
+    void evaluate(int k, float time, float *out) const;
+    quat key_quat(int k) const;
+
+    KeyInterpolation mode;
+    int comps;
+    std::vector<float> times;
+    std::vector<float> value[4];
+    std::vector<float> handle_out[3]; // KEY_BEZIER: control point after each key
+    std::vector<float> handle_in[3];  // and before it
+};
+
+struct AnimationClip
+{
+    KeyframeTrack position;
+    KeyframeTrack rotation;
+    KeyframeTrack scale;
+    bool loop;
+
+    AnimationClip() : loop(true) {}
+
+    // Latest key time over the three tracks
+    float duration() const;
+};
+
+struct AnimationCursor
+{
+    int position, rotation, scale;
+};
+
+struct AnimatedInstance
+{
+    const AnimationClip *clip;
+    float time; // seconds into the clip; wrapped when the clip loops
+    AnimationCursor cursor;
+};
+
+/*
+ * Model matrices translation * rotation * scale for count instances. Missing
+ * tracks leave the origin, identity rotation and unit scale. Each instance's
+ * cursors advance with it, so a frame of steadily playing instances costs a
+ * constant amount per instance; rotations are blended with slerp_batch.
+ */
+void sample_animation(AnimatedInstance *instances, int count, mat4 *out);
+
+// --------------------
+// Arc-length paths
+// --------------------
+
+/*
+ * Chain of cubic Beziers (3n + 1 control points, segment i uses points
+ * 3i .. 3i + 3) reparameterized by arc length. build() measures the chain
+ * once with a dense polyline and inverts it into a table of t at evenly
+ * spaced distances, so t_at(distance) is a constant-time lookup and an
+ * object stepping distance by speed * dt moves at constant speed.
+ *
+ * t runs from 0 to segment_count(); tangents are dP/dt (not normalized).
+ */
+class BezierPath
+{
+public:
+    BezierPath();
+
+    // samples per segment for the length table; false (path untouched) for
+    // a count that is not 3n + 1 >= 4 or non-finite points
+    bool build(const vec3_t *points, int count, int samples = 128);
+
+    int segment_count() const { return (int)(coeffs.size() / 12); }
+    float length() const { return arc.empty() ? 0.0f : arc.back(); }
+
+    // Path parameter at distance along the path (clamped to [0, length])
+    float t_at(float distance) const;
+
+    vec3_t position(float t) const;
+    vec3_t tangent(float t) const;
+
+    // count positions (packed xyz) and optional tangents at the given distances
+    void evaluate_at(const float *distances, int count, float *xyz, float *tangents = nullptr) const;
+
+    // steps + 1 samples per segment at even t, by forward differencing (no
+    // polynomial evaluation per sample); shared segment ends are written
+    // once: segment_count() * steps + 1 samples in all
+    void evaluate_uniform(int steps, float *xyz, float *tangents = nullptr) const;
+
+private:
+    int locate(float t, float &u) const;
+
+    std::vector<float> coeffs;    // per segment: a, b, c, d (xyz each) of a t^3 + b t^2 + c t + d
+    std::vector<float> arc;       // length at samples * segments + 1 even steps of t
+    std::vector<float> uniform_t; // t at as many evenly spaced distances
+};
+
 #endif
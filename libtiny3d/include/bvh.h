@@ -0,0 +1,98 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <vector>
+#include "math3d.h"
+#include "mesh.h"
+#include "culling.h"
+
+struct BvhNode
+{
+    AABB box;
+    int left;  // -1 for leaves; the right child is always left + 1
+    int first; // objects [first, first + count) of the item list,
+    int count; // covering the whole subtree for inner nodes
+};
+
+struct EdgePick
+{
+    int object;     // -1 when no edge is within the pick radius
+    int edge;
+    float distance; // closest approach between the ray and the edge
+    float t;        // ray parameter at that point
+};
+
+/*
+ * Bounding volume hierarchy over the world-space AABBs of scene objects.
+ * build() is a full rebuild using binned SAH splits; refit() keeps the
+ * tree shape and only recomputes bounds, which is enough for objects that
+ * move a little per frame. Every node owns a contiguous item range, so a
+ * node fully inside the frustum is accepted without visiting its children.
+ */
+class SceneBVH
+{
+public:
+    SceneBVH();
+
+    // Objects with no mesh (or an empty one) are left out
+    void build(const SceneObject *objects, int count);
+
+    // Same object array as build(), with updated model matrices
+    void refit(const SceneObject *objects);
+
+    void clear();
+
+    int object_count() const { return (int)items.size(); }
+    int node_count() const { return (int)nodes.size(); }
+    const BvhNode &node(int i) const { return nodes[i]; }
+
+    // Appends the indices of objects whose bounds intersect the frustum
+    void query_frustum(const Frustum &f, std::vector<int> &out) const;
+
+    // Edge nearest along the ray among those passing within radius of it
+    EdgePick pick_edge(
+        const SceneObject *objects,
+        const float origin[3],
+        const float dir[3],
+        float radius) const;
+
+    // Objects with at least one vertex inside the pixel rectangle
+    void select_rect(
+        const SceneObject *objects,
+        const mat4 &view,
+        const mat4 &projection,
+        float x0, float y0,
+        float x1, float y1,
+        int screen_width,
+        int screen_height,
+        std::vector<int> &out) const;
+
+private:
+    void build_node(int index, int first, int count, const std::vector<float> &centroids);
+    void fit_node(int index);
+
+    std::vector<BvhNode> nodes;
+    std::vector<int> items;
+    std::vector<AABB> object_bounds; // indexed by object
+};
+
+// Tests every edge of one object against the ray; updates best on a nearer hit
+void pick_object_edge(
+    const SceneObject &object,
+    int object_index,
+    const float origin[3],
+    const float dir[3],
+    float radius,
+    EdgePick &best);
+
+// World-space ray through pixel (px, py); dir is normalized
+bool ray_from_screen(
+    const mat4 &view,
+    const mat4 &projection,
+    float px, float py,
+    int screen_width,
+    int screen_height,
+    float origin[3],
+    float dir[3]);
+
+#endif
@@ -18,4 +18,18 @@ struct Canvas
 void set_pixel_f(Canvas &c, float x, float y, float intensity);
 void draw_line_f(Canvas &c, float x0, float y0, float x1, float y1, float intensity, float thickness);
 
+// Connected strip through count points (packed xy); each joint is drawn once.
+// A strip whose last point equals its first is treated as closed.
+void draw_polyline_f(Canvas &c, const float *xy, int count, float intensity, float thickness);
+
+#ifdef TINY3D_DEPTH_CUE
+// draw_line_f with the intensity interpolated from intensity0 at (x0, y0)
+// to intensity1 at (x1, y1), one add per step
+void draw_line_f_cued(Canvas &c, float x0, float y0, float x1, float y1,
+                      float intensity0, float intensity1, float thickness);
+
+// draw_polyline_f with one intensity per point, interpolated along each segment
+void draw_polyline_f_cued(Canvas &c, const float *xy, const float *intensity, int count, float thickness);
+#endif
+
 #endif
@@ -0,0 +1,187 @@
+#ifndef CHUNKED_SCENE_H
+#define CHUNKED_SCENE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <utility>
+#include <vector>
+#include "math3d.h"
+#include "mesh.h"
+#include "mapped_file.h"
+
+struct Canvas;
+
+/*
+ * Chunked scene file (.t3dc) for point/edge data larger than memory.
+ *
+ *   [ChunkedSceneHeader][ChunkRecord x chunk_count][chunk data ...]
+ *
+ * Space is split into a uniform grid; each non-empty cell is one chunk
+ * holding float xyz positions and uint32 local edge pairs. Edges live in
+ * the chunk of their first vertex, so vertices on chunk borders are
+ * duplicated; a cell keeps its own vertices only when one of its edges or
+ * no edge at all uses them (those are drawn as points). Chunk data starts on 4 KB boundaries so pages can be
+ * prefetched and released per chunk. All values are little endian.
+ */
+
+#define CHUNKED_SCENE_MAGIC "T3DC"
+#define CHUNKED_SCENE_VERSION 1
+
+struct ChunkedSceneHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t chunk_count;
+    uint32_t reserved;
+    int32_t grid_dims[3];
+    uint32_t reserved2;
+    float bounds_min[3];
+    float bounds_max[3];
+    uint64_t chunk_table_offset;
+};
+
+struct ChunkRecord
+{
+    float bounds_min[3];
+    float bounds_max[3];
+    int32_t cell[3];
+    uint32_t vertex_count;
+    uint32_t edge_count;
+    uint32_t reserved;
+    uint64_t data_offset; // positions, then edges at data_offset + vertex_count * 12
+};
+
+#define CHUNKED_WRITE_BATCH ((size_t)256 << 20)
+
+/*
+ * Partitions the data into cells_per_axis^3 cells (empty cells are skipped).
+ * The input is only read in sequential passes plus edge-endpoint lookups,
+ * so it can be a mapping of a file larger than memory. The writer keeps
+ * one entry per non-empty cell and gathers consecutive cells in batches
+ * of about batch_bytes. One pass spills vertex and edge ids to a temporary
+ * file grouped by batch, and each batch is read back from there; a single
+ * cell larger than batch_bytes still has to fit in memory on its own.
+ * Non-finite positions are rejected.
+ */
+bool write_chunked_scene(
+    const float *xyz,
+    int vertex_count,
+    const int (*edges)[2],
+    int edge_count,
+    int cells_per_axis,
+    const char *path,
+    size_t batch_bytes = CHUNKED_WRITE_BATCH);
+
+bool write_chunked_scene(
+    const float *xyz,
+    uint64_t vertex_count,
+    const uint64_t (*edges)[2],
+    uint64_t edge_count,
+    int cells_per_axis,
+    const char *path,
+    size_t batch_bytes = CHUNKED_WRITE_BATCH);
+
+class ChunkedScene
+{
+public:
+    ChunkedScene();
+
+    bool open(const char *path);
+    void close();
+
+    int chunk_count() const { return header ? (int)header->chunk_count : 0; }
+    const ChunkRecord &chunk(int i) const { return records[i]; }
+    AABB chunk_bounds(int i) const;
+    size_t chunk_bytes(int i) const;
+
+    const float *chunk_positions(int i) const;
+    const uint32_t *chunk_edges(int i) const;
+
+    // open() checks that every chunk lies inside the file; edge indices are
+    // checked against the chunk's vertex count the first time a chunk is
+    // checked (touching its pages then rather than at open). Results are
+    // cached in the scene, so check from one thread at a time.
+    bool check_chunk(int i) const;
+
+    // Vertices of a checked chunk that no edge uses (point data)
+    bool has_points(int i) const { return (state[i] & CHUNK_POINTS) != 0; }
+    int chunk_points(int i, std::vector<float> &xyz) const; // packed xyz
+
+    // Up to 26 grid neighbours of chunk i
+    int neighbours(int i, int out[26]) const;
+
+    const MappedFile &mapping() const { return file; }
+
+private:
+    enum ChunkState
+    {
+        CHUNK_CHECKED = 1,
+        CHUNK_VALID = 2,
+        CHUNK_POINTS = 4
+    };
+
+    int find_cell(int x, int y, int z) const;
+
+    MappedFile file;
+    const ChunkedSceneHeader *header;
+    const ChunkRecord *records;
+    std::vector<std::pair<long long, int>> cell_keys; // sorted (cell, chunk)
+    mutable std::vector<unsigned char> state;         // ChunkState per chunk
+};
+
+/*
+ * Bounded resident set over a ChunkedScene mapping. Chunks that are drawn
+ * or prefetched are kept in LRU order; once the budget is exceeded the
+ * oldest chunks' pages are handed back to the OS.
+ */
+class ChunkCache
+{
+public:
+    explicit ChunkCache(size_t budget_bytes);
+
+    void touch(const ChunkedScene &scene, int chunk);
+    bool prefetch(const ChunkedScene &scene, int chunk);
+    void clear();
+
+    size_t resident_bytes() const { return resident; }
+    int evictions() const { return evicted; }
+
+private:
+    void insert_front(const ChunkedScene &scene, int chunk);
+    void evict(const ChunkedScene &scene);
+
+    size_t budget;
+    size_t resident;
+    int evicted;
+    std::list<int> lru; // front = most recent
+    std::vector<std::list<int>::iterator> where;
+    std::vector<char> present;
+};
+
+struct ChunkRenderStats
+{
+    int chunks_total;
+    int chunks_culled;
+    int chunks_drawn;
+    int chunks_prefetched;
+    int chunks_invalid; // edge index past the chunk's vertices; skipped
+    long long edges_drawn;
+    long long points_drawn; // vertices no edge uses, drawn as splats
+    size_t resident_bytes;
+};
+
+// Culls chunks against the view frustum and streams the visible ones
+// through the wireframe projection/raster stages; vertices no edge uses
+// are drawn as one-pixel splats (render_points)
+void render_chunked_scene(
+    Canvas &canvas,
+    const ChunkedScene &scene,
+    ChunkCache &cache,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height,
+    ChunkRenderStats *stats = nullptr);
+
+#endif
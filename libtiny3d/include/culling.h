@@ -0,0 +1,66 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include "math3d.h"
+#include "mesh.h"
+
+struct Canvas;
+
+// Inside when nx * x + ny * y + nz * z + d >= 0
+struct Plane
+{
+    float nx, ny, nz, d;
+};
+
+struct Frustum
+{
+    Plane planes[6]; // left, right, bottom, top, near, far
+
+    // Planes of projection * view (world space) or projection * view * model (local space)
+    static Frustum from_matrix(const mat4 &m);
+
+    // Sub-frustum through the NDC rectangle [x0, x1] x [y0, y1] (near/far unchanged)
+    static Frustum from_matrix_rect(const mat4 &m, float x0, float y0, float x1, float y1);
+};
+
+bool frustum_intersects_sphere(const Frustum &f, const float center[3], float radius);
+bool frustum_intersects_aabb(const Frustum &f, const AABB &box);
+
+// Bounds of a local-space volume after a model transform
+BoundingSphere transform_sphere(const BoundingSphere &s, const mat4 &model);
+AABB transform_aabb(const AABB &box, const mat4 &model);
+
+struct SceneObject
+{
+    const Mesh *mesh;
+    mat4 model;
+};
+
+struct CullStats
+{
+    int tested;
+    int culled;
+    int drawn;
+};
+
+// Sphere test first, AABB test for survivors. Writes surviving object
+// indices to visible (room for count entries); returns how many survived.
+int cull_objects(
+    const SceneObject *objects,
+    int count,
+    const Frustum &frustum,
+    int *visible,
+    CullStats *stats = nullptr);
+
+// Culls whole objects before any vertex work, then draws the rest
+void render_scene(
+    Canvas &canvas,
+    const SceneObject *objects,
+    int count,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height,
+    CullStats *stats = nullptr);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef EDGE_REDUCE_H
+#define EDGE_REDUCE_H
+
+#include <vector>
+#include "renderer.h"
+
+struct ScreenSegment
+{
+    ScreenVertex a;
+    ScreenVertex b;
+};
+
+struct EdgeReduceStats
+{
+    int edges_in;
+    int offscreen;    // both ends outside the draw margin
+    int degenerate;   // both ends on the same pixel
+    int merged;       // edges absorbed into a longer segment
+    int segments_out;
+};
+
+/*
+ * Post-projection edge reduction. Edges the raster stage would skip or
+ * collapse to a dot are dropped, then chains of connected edges through
+ * vertices of degree 2 are replaced by longer segments wherever every
+ * joint stays within max_deviation pixels of the straight segment. Chains
+ * are merged at most a few dozen vertices at a time to keep the pass linear.
+ * Returns the number of segments written to out (out is overwritten).
+ */
+int reduce_screen_edges(
+    const ScreenVertex *projected,
+    int vertex_count,
+    const int *pairs,
+    int edge_count,
+    int screen_width,
+    int screen_height,
+    float max_deviation,
+    std::vector<ScreenSegment> &out,
+    EdgeReduceStats *stats = nullptr);
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef HIZ_H
+#define HIZ_H
+
+#include <memory>
+#include <vector>
+#include "math3d.h"
+#include "mesh.h"
+#include "raster.h"
+#include "culling.h"
+
+struct Canvas;
+
+struct OcclusionStats
+{
+    int tested;
+    int occluded; // entirely behind the pyramid's depth
+    int visible;
+};
+
+/*
+ * Hierarchical-Z pyramid for occlusion culling. Level 0 holds the farthest
+ * depth of each 8x8 pixel block; every level above halves the resolution,
+ * keeping the farthest of its four children. A screen rectangle is tested
+ * at the level where it spans at most 2x2 texels, so each query reads only
+ * a handful of values whatever the rectangle's size. Depth follows the
+ * rasterizer: 0 near, 1 far.
+ */
+class HiZBuffer
+{
+public:
+    HiZBuffer();
+    ~HiZBuffer();
+
+    // From a finished depth buffer, e.g. last frame's. Only conservative
+    // while the camera and occluders have not moved since it was drawn.
+    void build(const DepthBuffer &depth);
+
+    // Rasterizes the occluders' faces into a width x height depth buffer
+    // first. A reduced resolution is much cheaper but samples coverage at
+    // coarser pixel centres, so objects peeking past an occluder's edge by
+    // under one of those pixels can be culled.
+    void build_from_occluders(
+        const SceneObject *occluders,
+        int count,
+        const mat4 &view,
+        const mat4 &projection,
+        int width,
+        int height);
+
+    void clear();
+    bool empty() const { return levels.empty(); }
+
+    int screen_width() const { return screen_w; }
+    int screen_height() const { return screen_h; }
+    int level_count() const { return (int)levels.size(); }
+    int level_width(int level) const { return widths[level]; }
+    int level_height(int level) const { return heights[level]; }
+    float farthest(int level, int x, int y) const { return levels[level][y * widths[level] + x]; }
+
+    // Pixel rectangle (at the pyramid's screen resolution) whose nearest
+    // depth is znear. False when hidden everywhere or off screen.
+    bool rect_visible(float x0, float y0, float x1, float y1, float znear) const;
+
+    // World-space box under projection * view. Boxes crossing the near
+    // plane are always visible.
+    bool box_visible(const AABB &box, const mat4 &view_projection) const;
+
+private:
+    void build_levels();
+
+    int screen_w, screen_h;
+    std::vector<int> widths, heights;
+    std::vector<std::vector<float>> levels;
+
+    // Occluder rasterization scratch
+    DepthBuffer occluder_depth;
+    std::unique_ptr<Canvas> occluder_canvas;
+};
+
+// Tests the world boxes of the candidate objects (indices into objects,
+// typically the survivors of cull_objects) against the pyramid. Writes the
+// unoccluded indices to visible and returns how many there are. An empty
+// pyramid passes everything.
+int occlusion_cull(
+    const HiZBuffer &hiz,
+    const SceneObject *objects,
+    const int *candidates,
+    int count,
+    const mat4 &view,
+    const mat4 &projection,
+    int *visible,
+    OcclusionStats *stats = nullptr);
+
+#endif
@@ -1,14 +1,45 @@
 #ifndef LIGHTING_H
 #define LIGHTING_H
 
+#include <cstdint>
+#include <vector>
 #include "math3d.h"
 
+enum LightType
+{
+    LIGHT_DIRECTIONAL,
+    LIGHT_POINT,
+    LIGHT_SPOT
+};
+
+// Directional lights use direction and intensity only. Point and spot
+// lights fade smoothly to zero at range; a spot is full strength inside
+// spot_inner and dark outside spot_outer (half-angles in radians, around
+// direction). Point and spot lights shade an edge from its midpoint.
 struct Light
 {
     vec3_t direction;
     float intensity;
+    LightType type;
+    vec3_t position;
+    float range;
+    float spot_inner;
+    float spot_outer;
+
+    Light();
+    Light(const vec3_t &direction, float intensity); // directional
+
+    static Light point(const vec3_t &position, float intensity, float range);
+    static Light spot(const vec3_t &position, const vec3_t &direction, float intensity, float range,
+                      float inner, float outer);
 };
 
+// Range and cone falloff of a point/spot light at p (cosines of the cone
+// half-angles and the unit cone axis precomputed by the caller); writes the
+// unit direction from the light to p. 0 when out of reach.
+float light_falloff(const Light &light, const float p[3], float cos_inner, float cos_outer,
+                    const float axis[3], float to_p[3]);
+
 float lambert_edge(
     const vec3_t &v1,
     const vec3_t &v2,
@@ -20,4 +51,129 @@ float lambert_edge_multi(
     const Light *lights,
     int light_count);
 
+// Directional lights in SoA form for the batch path (other types are skipped)
+struct LightBatch
+{
+    std::vector<float> dx, dy, dz;
+    std::vector<float> intensity;
+
+    void assign(const Light *lights, int count);
+    int count() const { return (int)intensity.size(); }
+};
+
+/*
+ * lambert_edge_multi for edge_count edges at once, endpoints given as SoA
+ * arrays (edge i runs from (x0[i], y0[i], z0[i]) to (x1[i], y1[i], z1[i])).
+ * Each edge is normalized once and all lights are accumulated four edges
+ * at a time; out receives one intensity per edge.
+ */
+void lambert_edges_batch(
+    const float *x0, const float *y0, const float *z0,
+    const float *x1, const float *y1, const float *z1,
+    int edge_count,
+    const LightBatch &lights,
+    float *out);
+
+// Same for packed xyz positions and index pairs (gathered to SoA in blocks)
+void lambert_edges_indexed(
+    const float *xyz,
+    const uint32_t *edges,
+    int edge_count,
+    const LightBatch &lights,
+    float *out);
+
+/*
+ * Directional lights projected onto spherical harmonics, bands 0-2 (nine
+ * coefficients), for shading edges at a fixed cost whatever the light
+ * count. |e . d| is even in e, so each light is replaced by its best
+ * band-2 fit 0.1875 + 0.9375 (e . d)^2 and band 1 stays zero. Project once
+ * per frame (or when the lights change); point and spot lights are skipped.
+ *
+ * Accuracy against lambert_edge_multi: a single light of intensity I is
+ * off by at most 0.1875 I (0.1875 I across the light instead of 0, 1.125 I
+ * along it instead of I), and only the sum is clamped, not each light.
+ * Errors from lights spread over many directions largely cancel: with a
+ * total intensity of 2, 64 or more random lights give a mean error under
+ * 0.01 and a worst case near 0.04, 16 lights a worst case near 0.1
+ * (tests/test_lighting.cpp, demo/bench_lighting.cpp). Prefer the exact
+ * path for a few strong lights.
+ */
+struct LightSH
+{
+    float coeffs[9];
+
+    void project(const Light *lights, int count);
+};
+
+float lambert_edge_sh(
+    const vec3_t &v1,
+    const vec3_t &v2,
+    const LightSH &sh);
+
+// lambert_edges_batch / lambert_edges_indexed evaluating the SH set
+void lambert_edges_sh(
+    const float *x0, const float *y0, const float *z0,
+    const float *x1, const float *y1, const float *z1,
+    int edge_count,
+    const LightSH &sh,
+    float *out);
+
+void lambert_edges_sh_indexed(
+    const float *xyz,
+    const uint32_t *edges,
+    int edge_count,
+    const LightSH &sh,
+    float *out);
+
+struct LightGridStats
+{
+    long long edges;
+    long long light_tests; // point/spot evaluations, summed over edges
+};
+
+/*
+ * Uniform world-space grid over the reach of the point and spot lights.
+ * Each cell lists the lights whose range sphere overlaps it, so an edge
+ * only evaluates the lights binned in its midpoint's cell and the cost
+ * follows local light density rather than the total light count.
+ * Directional lights reach everything and go through the SoA batch path.
+ */
+class LightGrid
+{
+public:
+    LightGrid();
+
+    // cell_size <= 0 picks the mean light range; the cell count is capped
+    void build(const Light *lights, int count, float cell_size = 0.0f);
+
+    int local_light_count() const { return (int)local.size(); }
+    int cell_count() const { return dims[0] * dims[1] * dims[2]; }
+
+    // Local lights binned at p (indices for local_light)
+    int lights_at(const float p[3], const int *&indices) const;
+    const Light &local_light(int i) const { return local[i]; }
+
+    // Per-edge intensity for world-space packed positions and index pairs,
+    // same clamping as lambert_edge_multi
+    void shade_edges(
+        const float *xyz,
+        const uint32_t *edges,
+        int edge_count,
+        float *out,
+        LightGridStats *stats = nullptr) const;
+
+private:
+    int cell_index(const float p[3]) const;
+
+    std::vector<Light> local;    // point and spot lights, axis normalized
+    std::vector<float> spot_cos; // cos(inner), cos(outer) per local light
+    LightBatch directional;
+
+    float origin[3];
+    float cell;
+    int dims[3];
+    std::vector<int> cell_offsets; // CSR over cells
+    std::vector<int> cell_lights;  // indices into local
+};
+
 #endif
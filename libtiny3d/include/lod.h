@@ -0,0 +1,94 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include <vector>
+#include "math3d.h"
+#include "mesh.h"
+
+struct Canvas;
+
+/*
+ * Offline simplification for wireframes. Vertices joined by edges shorter
+ * than max_error are merged, shortest edge first, as long as no merged
+ * vertex moves further than max_error. Chains through degree-2 vertices
+ * are then replaced by longer straight edges wherever every dropped vertex
+ * lies within max_error of them. Faces and edgeless vertices are dropped.
+ */
+bool simplify_wireframe(const Mesh &src, float max_error, Mesh &out);
+
+/*
+ * A mesh plus coarser versions of it. Each level records its world-space
+ * error; at draw time the coarsest level whose error stays under a pixel
+ * tolerance on screen is used.
+ */
+class LodMesh
+{
+public:
+    LodMesh();
+
+    // Level 0 is a copy of base. Coarser candidates come from
+    // simplify_wireframe() with the error bound doubling from finest_error
+    // (default: 1/128 of the bounding radius) up to the radius; one is kept
+    // only if it has at least 10% fewer edges than the level before it.
+    void generate(const Mesh &base, int max_levels = 5, float finest_error = 0.0f);
+
+    // Appends a level supplied by the caller (error must grow with level)
+    void add_level(const Mesh &mesh, float error);
+
+    void clear();
+
+    int level_count() const { return (int)levels.size(); }
+    const Mesh &level(int i) const { return levels[i]; }
+    float level_error(int i) const { return errors[i]; }
+
+    // Level to draw when the bounding sphere covers radius_px pixels.
+    // current is the level used last frame (-1 if none); a change is only
+    // made once the error crosses the tolerance by the hysteresis fraction,
+    // so objects near a threshold do not flicker between levels.
+    int select(
+        float radius_px,
+        int current,
+        float pixel_error = 1.0f,
+        float hysteresis = 0.25f) const;
+
+private:
+    std::vector<Mesh> levels;
+    std::vector<float> errors;
+    float base_radius;
+};
+
+// Screen-space radius in pixels of a world-space sphere (huge when the camera is inside it)
+float projected_radius(
+    const BoundingSphere &world_sphere,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_height);
+
+struct LodObject
+{
+    const LodMesh *lod;
+    mat4 model;
+    int level; // updated by render_lod_scene; start at -1
+};
+
+struct LodRenderStats
+{
+    int objects_culled;
+    int objects_drawn;
+    int level_histogram[8]; // objects drawn per level (last bucket collects the rest)
+    long long edges_drawn;
+};
+
+// Frustum-culls objects, picks each one's level and draws it
+void render_lod_scene(
+    Canvas &canvas,
+    LodObject *objects,
+    int count,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height,
+    float pixel_error = 1.0f,
+    LodRenderStats *stats = nullptr);
+
+#endif
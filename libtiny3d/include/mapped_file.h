@@ -0,0 +1,39 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+/* Read-only memory-mapped file (POSIX mmap / Win32 file mapping) */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const char *path);
+    void close();
+
+    bool is_open() const { return base != nullptr; }
+    const unsigned char *data() const { return base; }
+    size_t size() const { return length; }
+
+    // Paging hints; no-ops where the platform has no equivalent
+    void advise_sequential() const;
+    void prefetch(size_t offset, size_t bytes) const;
+    void release(size_t offset, size_t bytes) const;
+
+private:
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    const unsigned char *base;
+    size_t length;
+#ifdef _WIN32
+    void *file_handle;
+    void *mapping_handle;
+#else
+    int fd;
+#endif
+};
+
+#endif
@@ -36,7 +36,38 @@ struct mat4
     static mat4 frustumAssymetric(float left, float right, float bottom, float top, float nearVal, float farVal);
 };
 
+// Rotation as a unit quaternion (x, y, z vector part, w scalar), turning
+// counterclockwise about its axis. mat4::rotation_xyz turns the other way:
+// rotation_xyz about one axis by a equals axis_angle about it by -a.
+struct quat
+{
+    float x, y, z, w;
+
+    static quat identity();
+    static quat axis_angle(const vec3_t &axis, float angle); // axis need not be unit
+
+    mat4 to_matrix() const;
+};
+
+// a * b: rotates by b, then by a
+quat multiply(const quat &a, const quat &b);
+quat normalize(const quat &q);
+
+// Interpolators take the short way round (b is negated when a . b < 0)
+quat nlerp(const quat &a, const quat &b, float t);
+quat slerp(const quat &a, const quat &b, float t);
+
+// nlerp with t remapped by a polynomial fitted to slerp's angle curve: no
+// trig, angular error against slerp under 0.001 rad
+quat slerp_fast(const quat &a, const quat &b, float t);
+
+// slerp_fast over arrays, four quaternions per SIMD step
+void slerp_batch(const quat *a, const quat *b, const float *t, int count, quat *out);
+
 mat4 multiply(const mat4 &a, const mat4 &b);
 vec3_t multiply(const mat4 &m, const vec3_t &v);
 
+// General 4x4 inverse; returns false (out untouched) for a singular matrix
+bool invert(const mat4 &m, mat4 &out);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,145 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <vector>
+#include "math3d.h"
+
+struct AABB
+{
+    float min[3];
+    float max[3];
+};
+
+struct BoundingSphere
+{
+    float center[3];
+    float radius;
+};
+
+// Problems found in the input while building a mesh
+struct MeshBuildStats
+{
+    int duplicate_edges;   // dropped: same vertex pair seen again (either winding)
+    int degenerate_edges;  // dropped: both ends on the same vertex
+    int nonmanifold_edges; // kept: edge shared by more than two faces
+    int invalid_indices;   // build failed: index outside [0, vertex_count)
+    int invalid_positions; // build failed: NaN or infinite coordinate
+    int invalid_faces;     // build failed: face with fewer than 3 vertices
+};
+
+/*
+ * Open-addressing hash set of undirected edges, indexed in insertion order.
+ * Used to deduplicate edges while streaming faces in.
+ */
+class EdgeSet
+{
+public:
+    explicit EdgeSet(int expected_edges = 0);
+
+    // Edge index of (a, b); inserted as (min, max) if new
+    int insert(int a, int b, bool &inserted);
+    int find(int a, int b) const;
+
+    int size() const { return (int)pairs.size() / 2; }
+    std::vector<int> &edge_pairs() { return pairs; }
+
+private:
+    void grow();
+
+    std::vector<long long> keys; // -1 = empty slot
+    std::vector<int> slots;
+    std::vector<int> pairs;
+    int mask;
+};
+
+/*
+ * Retained wireframe mesh.
+ *
+ * Built once from raw arrays, then read-only. Positions are packed xyz
+ * floats, edges are canonical (a < b) and unique; build() also sorts
+ * them, adopt() keeps the caller's order. Bounds and adjacency are
+ * computed at build time so renderers never redo that work.
+ */
+class Mesh
+{
+public:
+    Mesh();
+
+    // Returns false and leaves the mesh empty if any index or position is invalid.
+    bool build(
+        const vec3_t *vertices,
+        int vertex_count,
+        const int (*edges)[2],
+        int edge_count);
+
+    // Optional polygon faces: face_sizes[i] indices per face, packed in face_indices.
+    // Face boundary edges are merged into the edge list.
+    bool build(
+        const float *xyz,
+        int vertex_count,
+        const int (*edges)[2],
+        int edge_count,
+        const int *face_sizes = nullptr,
+        int face_count = 0,
+        const int *face_indices = nullptr);
+
+    // Takes ownership of buffers whose edges are already unique (loaders).
+    // Indices are range-checked; edge_faces may be empty.
+    bool adopt(
+        std::vector<float> &&xyz,
+        std::vector<int> &&edges,
+        std::vector<int> &&faces_offsets,
+        std::vector<int> &&faces_indices,
+        std::vector<int> &&edges_faces);
+
+    void clear();
+
+    bool empty() const { return vertex_total == 0; }
+    int vertex_count() const { return vertex_total; }
+    int edge_count() const { return (int)edge_pairs.size() / 2; }
+    int face_count() const { return face_offsets.empty() ? 0 : (int)face_offsets.size() - 1; }
+
+    const float *position_data() const { return positions.data(); }
+    const int (*edge_data() const)[2] { return reinterpret_cast<const int(*)[2]>(edge_pairs.data()); }
+
+    // Faces
+    int face_size(int f) const { return face_offsets[f + 1] - face_offsets[f]; }
+    const int *face_vertices(int f) const { return face_index_list.data() + face_offsets[f]; }
+
+    // Two faces per edge, -1 where missing; only when has_edge_faces()
+    bool has_edge_faces() const { return !edge_face_pairs.empty(); }
+    const int *edge_faces(int e) const { return edge_face_pairs.data() + e * 2; }
+
+    // Vertex -> incident edge indices
+    int vertex_degree(int v) const { return vertex_edge_offsets[v + 1] - vertex_edge_offsets[v]; }
+    const int *vertex_edges(int v) const { return vertex_edge_list.data() + vertex_edge_offsets[v]; }
+
+    const AABB &aabb() const { return box; }
+    const BoundingSphere &bounding_sphere() const { return sphere; }
+    const MeshBuildStats &build_stats() const { return stats; }
+
+    // New for every build(), adopt() and clear(), unique across meshes
+    // (copies share it); caches key on it instead of the mesh address
+    unsigned long long generation() const { return build_generation; }
+
+private:
+    void finish(std::vector<long long> &edge_keys);
+    void compute_bounds();
+    void compute_adjacency();
+
+    int vertex_total;
+    unsigned long long build_generation;
+    std::vector<float> positions;      // x, y, z per vertex
+    std::vector<int> edge_pairs;       // a, b per edge
+    std::vector<int> face_offsets;     // face_count + 1 entries
+    std::vector<int> face_index_list;
+    std::vector<int> edge_face_pairs;  // f0, f1 per edge
+    std::vector<int> vertex_edge_offsets;
+    std::vector<int> vertex_edge_list;
+
+    AABB box;
+    BoundingSphere sphere;
+    MeshBuildStats stats;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef MESH_BINARY_H
+#define MESH_BINARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include "math3d.h"
+#include "mesh.h"
+#include "mapped_file.h"
+
+/*
+ * Binary wireframe mesh file (.t3dm), designed to be mapped and used in place.
+ *
+ *   [MeshFileHeader][positions][edges]
+ *
+ * Positions are float32 xyz, or uint16 xyz quantized over the header
+ * bounds (MESH_FILE_QUANTIZED). Edges are uint32 pairs, or uint16 pairs
+ * when every index fits (MESH_FILE_INDEX16). Sections start on 16-byte
+ * boundaries; all values are little endian. Faces are not stored.
+ */
+
+#define MESH_FILE_MAGIC "T3DM"
+#define MESH_FILE_VERSION 1
+
+enum MeshFileFlags
+{
+    MESH_FILE_QUANTIZED = 1 << 0,
+    MESH_FILE_INDEX16 = 1 << 1
+};
+
+struct MeshFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t vertex_count;
+    uint32_t edge_count;
+    uint32_t reserved;
+    float bounds_min[3];
+    float bounds_max[3];
+    float sphere[4]; // center xyz, radius
+    uint64_t positions_offset;
+    uint64_t edges_offset;
+};
+
+// Writes a mesh; uint16 indices are used automatically when they fit
+bool write_mesh_binary(const Mesh &mesh, const char *path, bool quantize_positions = false);
+
+/*
+ * Read-only view over a .t3dm file or buffer. Opening only checks the
+ * header and that both sections lie inside the buffer; vertex and edge
+ * data are never copied or read. renderer_wireframe skips edges whose
+ * indices are out of range as it draws them; validate() checks them all
+ * up front for callers that index position() themselves.
+ */
+class MeshView
+{
+public:
+    MeshView();
+
+    bool open(const char *path);
+    bool attach(const unsigned char *data, size_t size);
+    void close();
+
+    // Every edge index below vertex_count (one pass over the edges)
+    bool validate() const;
+
+    bool is_open() const { return header != nullptr; }
+    int vertex_count() const { return (int)header->vertex_count; }
+    int edge_count() const { return (int)header->edge_count; }
+    bool quantized() const { return (header->flags & MESH_FILE_QUANTIZED) != 0; }
+    bool index16() const { return (header->flags & MESH_FILE_INDEX16) != 0; }
+
+    const MeshFileHeader &file_header() const { return *header; }
+    AABB aabb() const;
+    BoundingSphere bounding_sphere() const;
+
+    // Raw sections: float xyz or uint16 xyz; uint16 or uint32 pairs
+    const void *position_data() const { return base + header->positions_offset; }
+    const void *edge_data() const { return base + header->edges_offset; }
+
+    // Stored position -> model space (identity unless quantized)
+    mat4 dequantize_matrix() const;
+
+    void position(int i, float out[3]) const;
+    void edge(int e, int &a, int &b) const;
+
+private:
+    MappedFile file;
+    const unsigned char *base;
+    const MeshFileHeader *header;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef MESH_IO_H
+#define MESH_IO_H
+
+#include <cstddef>
+
+class Mesh;
+
+struct MeshLoadInfo
+{
+    const char *error; // nullptr on success
+    long long bytes;
+    int vertices;
+    int faces;
+    int edges;
+    int skipped; // unsupported lines / malformed faces that were ignored
+};
+
+/*
+ * Wavefront OBJ and PLY (ascii, binary little/big endian) loaders.
+ *
+ * The file is memory-mapped and parsed in place with a non-allocating
+ * tokenizer. Face boundaries are turned into unique edges through a hash
+ * set as faces stream in, and the buffers are handed to the Mesh without
+ * a copy. OBJ "l" polylines and PLY "edge" elements become explicit edges.
+ */
+bool load_obj(const char *path, Mesh &out, MeshLoadInfo *info = nullptr);
+bool load_ply(const char *path, Mesh &out, MeshLoadInfo *info = nullptr);
+
+// Picks the parser from the file extension (.obj / .ply)
+bool load_mesh(const char *path, Mesh &out, MeshLoadInfo *info = nullptr);
+
+// In-memory variants used by the file loaders
+bool parse_obj(const char *text, size_t length, Mesh &out, MeshLoadInfo *info = nullptr);
+bool parse_ply(const unsigned char *data, size_t length, Mesh &out, MeshLoadInfo *info = nullptr);
+
+#endif
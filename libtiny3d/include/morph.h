@@ -0,0 +1,58 @@
+#ifndef MORPH_H
+#define MORPH_H
+
+#include <vector>
+#include "math3d.h"
+#include "mesh.h"
+
+/*
+ * Morph targets over a base set of packed xyz positions (same vertex count
+ * and order, any topology). A target keeps only the vertices it moves, as
+ * runs of consecutive vertices with their deltas packed alongside; short
+ * gaps inside a run are filled with zero deltas so each run is one
+ * contiguous weighted-accumulate.
+ *
+ * blend() writes base + sum(weight * delta) into a position buffer that
+ * renderer_wireframe_packed() (or project_positions()) takes directly.
+ * Targets with zero weight and vertices a target does not move cost nothing.
+ */
+class MorphSet
+{
+public:
+    MorphSet();
+
+    void set_base(const float *xyz, int vertex_count);
+    void set_base(const Mesh &mesh);
+    void clear();
+
+    // Vertices moving by more than epsilon are kept; returns the target
+    // index, or -1 when vertex_count differs from the base
+    int add_target(const float *xyz, int vertex_count, float epsilon = 0.0f);
+
+    int vertex_count() const { return (int)base.size() / 3; }
+    int target_count() const { return (int)targets.size(); }
+    int target_vertices(int t) const; // vertices stored for target t (gap fill included)
+    const float *base_data() const { return base.data(); }
+
+    // weights: one per target; out: vertex_count() * 3 floats
+    void blend(const float *weights, float *out) const;
+
+private:
+    struct Run
+    {
+        int first;  // vertex
+        int count;  // vertices
+        int offset; // into deltas, in floats
+    };
+
+    struct Target
+    {
+        std::vector<Run> runs;
+        std::vector<float> deltas; // packed xyz per run vertex
+    };
+
+    std::vector<float> base;
+    std::vector<Target> targets;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef POINTS_H
+#define POINTS_H
+
+#include "math3d.h"
+
+struct Canvas;
+class DepthBuffer;
+
+struct PointOptions
+{
+    float intensity;          // splat value (scaled by the per-point array when given)
+    float size;               // splat side in pixels
+    bool size_by_distance;    // scale size by reference_distance / view depth
+    float reference_distance; // depth at which a splat is exactly size pixels
+    float max_size;           // clamp for close points
+    int threads;              // 0: every hardware thread
+};
+
+PointOptions default_point_options();
+
+struct PointStats
+{
+    long long points_in;
+    long long points_clipped; // behind the near plane, past the far plane or off screen
+    long long points_drawn;
+};
+
+/*
+ * Splats count points (packed xyz) through a premultiplied
+ * projection * view * model. Points are projected four at a time and drawn
+ * as square splats of whole pixels. Without a depth buffer splats add to
+ * the canvas like set_pixel_f; with one, the nearest point wins and writes
+ * its depth (same 0..1 range as the triangle rasterizer, so points and
+ * filled meshes share a frame).
+ *
+ * With several threads, each thread projects a contiguous range of points
+ * and bins the splats into horizontal bands; bands are then drawn in
+ * parallel, each owned by one thread, in the original point order.
+ */
+void render_points(
+    Canvas &canvas,
+    DepthBuffer *depth,
+    const float *xyz,
+    const float *point_intensity, // optional, one per point
+    int count,
+    const mat4 &mvp,
+    const PointOptions &options,
+    PointStats *stats = nullptr);
+
+#endif
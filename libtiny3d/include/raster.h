@@ -0,0 +1,120 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <cstddef>
+#include <vector>
+#include "math3d.h"
+#include "lighting.h"
+
+struct Canvas;
+class Mesh;
+
+/*
+ * Depth buffer for the triangle rasterizer. Depth runs from 0 (near) to
+ * 1 (far) and is cleared to 1. Storage is padded to whole 8x8 blocks so
+ * SIMD rows never need a scalar tail, and each block keeps its farthest
+ * depth for early-z rejection of whole blocks.
+ */
+class DepthBuffer
+{
+public:
+    DepthBuffer(int width, int height);
+
+    void clear();
+
+    // Reallocates for a new size and clears
+    void resize(int width, int height);
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int stride() const { return pitch; }
+
+    float at(int x, int y) const { return depth[(size_t)y * pitch + x]; }
+    float *row(int y) { return &depth[(size_t)y * pitch]; }
+    const float *row(int y) const { return &depth[(size_t)y * pitch]; }
+
+    // Farthest depth in the 8x8 block containing pixel (x, y)
+    float block_max(int x, int y) const { return block_far[(y >> 3) * blocks_x + (x >> 3)]; }
+    float &block_max_ref(int bx, int by) { return block_far[by * blocks_x + bx]; }
+
+private:
+    int w, h;
+    int pitch;
+    int blocks_x;
+    std::vector<float> depth;
+    std::vector<float> block_far;
+};
+
+// Screen-space vertex: pixel position, depth in [0, 1], shade (intensity)
+struct RasterVertex
+{
+    float x, y, z;
+    float shade;
+};
+
+enum ShadeMode
+{
+    SHADE_FLAT,   // first vertex's shade across the triangle
+    SHADE_GOURAUD // shade interpolated across the triangle
+};
+
+struct RasterStats
+{
+    long long triangles_in;
+    long long triangles_culled; // back-facing, behind the near plane, zero area or off screen
+    long long triangles_drawn;
+    long long blocks_tested;
+    long long blocks_rejected_z; // skipped by early-z without touching pixels
+    long long pixels_written;
+};
+
+/*
+ * Rasterizes tri_count triangles given as three consecutive vertices each.
+ * Triangles are binned into 64x64 tiles and tiles are shaded in parallel
+ * (threads = 0 uses every hardware thread). Inside a tile, 8x8 blocks are
+ * trivially rejected or tested against the block's far depth first; pixel
+ * coverage and depth are then evaluated four at a time with edge functions
+ * sampled at pixel centres. Shared edges are owned by exactly one triangle.
+ * Both windings are drawn; cull before calling if needed.
+ */
+void rasterize_triangles(
+    Canvas &canvas,
+    DepthBuffer &depth,
+    const RasterVertex *vertices,
+    int tri_count,
+    ShadeMode mode,
+    int threads = 0,
+    RasterStats *stats = nullptr);
+
+struct SolidOptions
+{
+    ShadeMode mode;
+    bool cull_backfaces; // faces wound clockwise on screen are skipped
+    float ambient;
+    int threads;
+};
+
+SolidOptions default_solid_options();
+
+/*
+ * Filled rendering of a faced mesh through the same model/view/projection
+ * pipeline as renderer_wireframe. Polygons are fanned into triangles and
+ * clipped to the near plane. Shade is ambient plus the Lambert term of each
+ * light, whose direction is the way the light travels; point and spot
+ * lights (world space) are evaluated per vertex for Gouraud and at the face
+ * centroid for flat shading, with the same range and cone falloff as the
+ * edge lighting. Gouraud uses area-weighted vertex normals.
+ */
+void render_mesh_solid(
+    Canvas &canvas,
+    DepthBuffer &depth,
+    const Mesh &mesh,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    const Light *lights,
+    int light_count,
+    const SolidOptions &options,
+    RasterStats *stats = nullptr);
+
+#endif
@@ -1,10 +1,16 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include <cstdint>
+#include <vector>
 #include "math3d.h"
 
 // Forward declaration
 struct Canvas;
+class Mesh;
+class MeshView;
+struct EdgeReduceStats;
+struct Light;
 
 struct ScreenVertex
 {
@@ -28,6 +34,36 @@ bool clip_to_circular_viewport(
     int cx, int cy, int radius,
     int x, int y);
 
+#ifdef TINY3D_DEPTH_CUE
+/*
+ * Depth cueing, compiled in with -DTINY3D_DEPTH_CUE (without it edges are
+ * drawn exactly as before, at no cost). Every wireframe path scales each
+ * edge end by a factor of its ScreenVertex::z, mapped to the rasterizer's
+ * 0..1 depth, and interpolates that along the line. Linear fades from 1 at
+ * start to 0 at end; exponential is exp(-density * (depth - start)) past
+ * start. The setting is process-wide and starts off.
+ */
+enum DepthCueMode
+{
+    DEPTH_CUE_OFF,
+    DEPTH_CUE_LINEAR,
+    DEPTH_CUE_EXP
+};
+
+struct DepthCue
+{
+    DepthCueMode mode;
+    float start, end; // 0..1 depth
+    float density;    // DEPTH_CUE_EXP
+};
+
+void set_depth_cue(const DepthCue &cue);
+const DepthCue &get_depth_cue();
+
+// Cue factor for a ScreenVertex::z
+float depth_cue_factor(float z);
+#endif
+
 // draw wireframes edges
 void renderer_wireframe(
     Canvas &canvas,
@@ -41,4 +77,140 @@ void renderer_wireframe(
     int screen_width,
     int screen_height);
 
+// Projects packed xyz positions with a premultiplied projection * view * model
+void project_positions(
+    const float *xyz,
+    int count,
+    const mat4 &mvp,
+    int screen_width,
+    int screen_height,
+    ScreenVertex *out);
+
+// Same, for quantized positions (fold the dequantize transform into mvp)
+void project_positions(
+    const uint16_t *xyz,
+    int count,
+    const mat4 &mvp,
+    int screen_width,
+    int screen_height,
+    ScreenVertex *out);
+
+// Projection and raster stages for packed positions / uint32 edge pairs
+void renderer_wireframe_packed(
+    Canvas &canvas,
+    const float *xyz,
+    int vertex_count,
+    const uint32_t *edges,
+    int edge_count,
+    const mat4 &mvp,
+    int screen_width,
+    int screen_height);
+
+// draw a prebuilt mesh (no vertex/edge limits)
+void renderer_wireframe(
+    Canvas &canvas,
+    const Mesh &mesh,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height);
+
+// draw a prebuilt mesh after dropping degenerate edges and merging
+// near-collinear chains in screen space (see edge_reduce.h)
+void renderer_wireframe_reduced(
+    Canvas &canvas,
+    const Mesh &mesh,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height,
+    float max_deviation = 0.5f,
+    EdgeReduceStats *stats = nullptr);
+
+// draw a mapped .t3dm mesh in place
+void renderer_wireframe(
+    Canvas &canvas,
+    const MeshView &mesh,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height);
+
+// Per-edge world-space Lambert intensities (as lambert_edge_multi) for one
+// mesh; point and spot lights go through a LightGrid. They depend only on
+// the mesh, the model matrix and the lights, so update() recomputes them
+// only when one changed; a moving camera reuses them. A rebuilt mesh
+// (build(), adopt()) is detected through Mesh::generation().
+class EdgeLightCache
+{
+public:
+    EdgeLightCache();
+
+    // Returns true when the intensities were recomputed
+    bool update(const Mesh &mesh, const mat4 &model, const Light *lights, int light_count);
+    void invalidate();
+
+    const float *intensities() const { return values.data(); }
+    int update_count() const { return updates; }
+
+private:
+    unsigned long long generation; // Mesh::generation() of the cached mesh
+    bool valid;
+    int updates;
+    mat4 model;
+    std::vector<float> light_key; // every parameter of every light
+    std::vector<float> values;
+};
+
+// renderer_wireframe with each edge drawn at its cached lit intensity
+void renderer_wireframe_lit(
+    Canvas &canvas,
+    const Mesh &mesh,
+    EdgeLightCache &cache,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    const Light *lights,
+    int light_count,
+    int screen_width,
+    int screen_height);
+
+// Screen-space polyline of a cubic Bezier under projection * view * model.
+// The curve is split by de Casteljau on its clip-space control points
+// (exact for the projected, rational curve) until each piece's projected
+// control polygon lies within tolerance pixels of its chord. Pieces behind
+// the near plane or wholly off screen are dropped, which can split the
+// result into several strips: xy holds packed points, offsets the first
+// point of each strip plus a final end offset.
+void flatten_bezier(
+    const vec3_t &p0,
+    const vec3_t &p1,
+    const vec3_t &p2,
+    const vec3_t &p3,
+    const mat4 &mvp,
+    int screen_width,
+    int screen_height,
+    float tolerance,
+    std::vector<float> &xy,
+    std::vector<int> &offsets);
+
+// Flattens and draws the curve with draw_polyline_f; returns the number
+// of line segments drawn
+int renderer_bezier(
+    Canvas &canvas,
+    const vec3_t &p0,
+    const vec3_t &p1,
+    const vec3_t &p2,
+    const vec3_t &p3,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height,
+    float tolerance = 0.25f,
+    float intensity = 1.0f);
+
 #endif
\ No newline at end of file
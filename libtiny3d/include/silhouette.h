@@ -0,0 +1,79 @@
+#ifndef SILHOUETTE_H
+#define SILHOUETTE_H
+
+#include <cstdint>
+#include <vector>
+#include "math3d.h"
+
+struct Canvas;
+class Mesh;
+
+struct SilhouetteStats
+{
+    int faces_front;
+    int faces_changed;    // facing flips since the previous update
+    int edges_visible;    // silhouette + front-face + faceless edges
+    int silhouette_edges; // one adjacent face front-facing, the other not
+};
+
+/*
+ * Per-frame visible/silhouette edge set for a faced mesh (faces wound
+ * counter-clockwise seen from outside). Face planes are precomputed in
+ * SoA form; each update() classifies every face against the eye with a
+ * SIMD pass, then only the edges of faces whose facing flipped are
+ * re-evaluated, so a slowly rotating model costs little beyond the
+ * classification. Hidden-line removal is by facing only: front-facing
+ * edges occluded by other parts of a non-convex model are still drawn.
+ */
+class SilhouetteExtractor
+{
+public:
+    SilhouetteExtractor();
+
+    // False when the mesh has no faces
+    bool attach(const Mesh &mesh);
+    void detach();
+
+    // Eye position in the mesh's local space
+    void update(const float eye_local[3]);
+
+    // Same, with the eye taken from the camera of view * model
+    void update(const mat4 &model, const mat4 &view);
+
+    const std::vector<int> &visible_edges() const { return visible; }
+    const std::vector<int> &silhouette() const { return outline; }
+    const SilhouetteStats &stats() const { return last; }
+
+private:
+    void set_edge(int e);
+    static void list_set(std::vector<int> &list, std::vector<int> &where, int e, bool on);
+
+    const Mesh *mesh;
+    bool primed;
+
+    // Face planes, SoA, padded to a multiple of 4
+    std::vector<float> nx, ny, nz, d;
+    std::vector<uint8_t> facing; // 0xff front, 0 back
+
+    std::vector<int> face_edge_offsets;
+    std::vector<int> face_edge_list;
+    std::vector<int> changed;
+
+    std::vector<int> visible, visible_at;
+    std::vector<int> outline, outline_at;
+
+    SilhouetteStats last;
+};
+
+// Draws only the extractor's visible edges (updates it for this view first)
+void renderer_wireframe_visible(
+    Canvas &canvas,
+    const Mesh &mesh,
+    SilhouetteExtractor &extractor,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height);
+
+#endif
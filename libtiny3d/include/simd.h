@@ -0,0 +1,10 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// SSE2 is baseline on x86-64; every SIMD path keeps a scalar fallback
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TINY3D_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#endif
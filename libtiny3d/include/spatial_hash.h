@@ -0,0 +1,75 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <vector>
+
+class Mesh;
+
+/*
+ * Uniform-grid spatial hash over packed xyz points.
+ *
+ * Points are bucketed by hashed cell into one flat array (counting sort),
+ * so building is O(n) and a radius query only visits the 27 cells around
+ * the query point.
+ */
+class SpatialHashGrid
+{
+public:
+    SpatialHashGrid();
+
+    void build(const float *xyz, int count, float cell_size);
+
+    // Calls visit(index) for every point in the 3x3x3 cells around (x, y, z).
+    // Candidates still need a distance test.
+    template <typename Visitor>
+    void for_each_near(float x, float y, float z, Visitor visit) const
+    {
+        int cx, cy, cz;
+        cell_of(x, y, z, cx, cy, cz);
+
+        for (int dz = -1; dz <= 1; dz++)
+            for (int dy = -1; dy <= 1; dy++)
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int bucket = bucket_of(cx + dx, cy + dy, cz + dz);
+                    for (int k = bucket_offsets[bucket]; k < bucket_offsets[bucket + 1]; k++)
+                    {
+                        int i = sorted_points[k];
+                        // Different cells can share a bucket
+                        if (cells[i * 3] == cx + dx && cells[i * 3 + 1] == cy + dy && cells[i * 3 + 2] == cz + dz)
+                            visit(i);
+                    }
+                }
+    }
+
+private:
+    void cell_of(float x, float y, float z, int &cx, int &cy, int &cz) const;
+    int bucket_of(int cx, int cy, int cz) const;
+
+    float inv_cell;
+    int bucket_mask;
+    std::vector<int> cells;          // cx, cy, cz per point
+    std::vector<int> bucket_offsets; // bucket_count + 1 entries
+    std::vector<int> sorted_points;
+};
+
+// Merges vertices closer than epsilon into the first one seen.
+// remap[i] is the welded index of input vertex i. Returns the welded count.
+int weld_vertices(
+    const float *xyz,
+    int count,
+    float epsilon,
+    std::vector<float> &out_xyz,
+    std::vector<int> &remap);
+
+// Appends an edge (i, j), i < j, for every pair of points closer than max_distance.
+void connect_points_within(
+    const float *xyz,
+    int count,
+    float max_distance,
+    std::vector<int> &out_edges);
+
+// Welds a mesh's vertices and rebuilds its edges/faces on the welded set.
+bool weld_mesh(const Mesh &in, float epsilon, Mesh &out);
+
+#endif
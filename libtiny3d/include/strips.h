@@ -0,0 +1,45 @@
+#ifndef STRIPS_H
+#define STRIPS_H
+
+#include <vector>
+#include "math3d.h"
+
+struct Canvas;
+class Mesh;
+
+/*
+ * Edge graph as a set of polylines. Strip s visits
+ * vertices[offsets[s]] .. vertices[offsets[s + 1] - 1]; a strip whose
+ * first and last vertex are equal is a closed loop.
+ */
+struct PolylineStrips
+{
+    std::vector<int> offsets;
+    std::vector<int> vertices;
+
+    int strip_count() const { return offsets.empty() ? 0 : (int)offsets.size() - 1; }
+    int strip_size(int s) const { return offsets[s + 1] - offsets[s]; }
+    const int *strip(int s) const { return &vertices[offsets[s]]; }
+};
+
+/*
+ * Eulerian decomposition: every edge is covered exactly once using the
+ * fewest polylines possible, i.e. one per pair of odd-degree vertices in
+ * a component, or a single closed loop for components with none.
+ */
+void build_polyline_strips(const int *pairs, int edge_count, int vertex_count, PolylineStrips &out);
+void build_polyline_strips(const Mesh &mesh, PolylineStrips &out);
+
+// Draws a mesh strip by strip, so each shared vertex is rasterized once per
+// pass through it instead of once per incident edge
+void renderer_wireframe_strips(
+    Canvas &canvas,
+    const Mesh &mesh,
+    const PolylineStrips &strips,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <cstdint>
+#include <vector>
+#include "math3d.h"
+
+/*
+ * Parent/child transforms in flat arrays. Nodes are stored in topological
+ * order (a parent is always added before its children), so one forward
+ * pass computes world = world(parent) * local for every node.
+ *
+ * set_local() only marks the node dirty; update() starts at the first
+ * dirty node and recomputes just the dirty nodes and their descendants,
+ * so a frame where a few joints move touches only their subtrees. world()
+ * is the model matrix to hand to the renderer.
+ */
+class TransformHierarchy
+{
+public:
+    TransformHierarchy();
+
+    // Returns the new node's index, or -1 for a parent that does not exist yet
+    int add(int parent, const mat4 &local);
+    void clear();
+
+    int size() const { return (int)parents.size(); }
+    int parent(int node) const { return parents[node]; }
+
+    void set_local(int node, const mat4 &local);
+    const mat4 &local(int node) const { return locals[node]; }
+
+    // Valid after update()
+    const mat4 &world(int node) const { return worlds[node]; }
+    const mat4 *world_data() const { return worlds.data(); }
+
+    bool dirty() const { return first_dirty < size(); }
+
+    // Recomputes dirty subtrees; returns the number of world matrices written
+    int update();
+
+private:
+    std::vector<int> parents;
+    std::vector<mat4> locals;
+    std::vector<mat4> worlds;
+    std::vector<uint8_t> flags; // local changed / world recomputed this update
+    int first_dirty;
+};
+
+#endif
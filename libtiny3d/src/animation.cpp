@@ -1,4 +1,6 @@
 #include "animation.h"
+#include <algorithm>
+#include <cmath>
 
 vec3_t bezier(
     const vec3_t &p0,
@@ -42,4 +44,455 @@ float loop_time(float t)
         t -= static_cast<int>(t);
     }
     return t;
-}
\ No newline at end of file
+}
+
+// --------------------
+// Keyframe tracks
+// --------------------
+
+// Forward steps tried from the cursor before falling back to a binary search
+static const int CURSOR_STEPS = 4;
+
+KeyframeTrack::KeyframeTrack() : mode(KEY_LINEAR), comps(3) {}
+
+static bool increasing(const float *times, int count)
+{
+    if (count <= 0)
+        return false;
+    for (int i = 0; i < count; i++)
+        if (!std::isfinite(times[i]) || (i > 0 && !(times[i] > times[i - 1])))
+            return false;
+    return true;
+}
+
+bool KeyframeTrack::set_vec3(const float *key_times, const vec3_t *values, int count, KeyInterpolation interpolation)
+{
+    if (!increasing(key_times, count) || interpolation == KEY_SLERP)
+        return false;
+
+    mode = interpolation;
+    comps = 3;
+    times.assign(key_times, key_times + count);
+    for (int c = 0; c < 4; c++)
+        value[c].clear();
+    for (int i = 0; i < count; i++)
+    {
+        value[0].push_back(values[i].x);
+        value[1].push_back(values[i].y);
+        value[2].push_back(values[i].z);
+    }
+
+    for (int c = 0; c < 3; c++)
+    {
+        handle_out[c].clear();
+        handle_in[c].clear();
+    }
+    if (mode != KEY_BEZIER)
+        return true;
+
+    // Catmull-Rom tangent (per second) at each key, one-sided at the ends;
+    // a third of it per segment length gives the Bezier handles
+    for (int c = 0; c < 3; c++)
+    {
+        const std::vector<float> &v = value[c];
+        handle_out[c].resize(count);
+        handle_in[c].resize(count);
+        for (int i = 0; i < count; i++)
+        {
+            int a = std::max(0, i - 1), b = std::min(count - 1, i + 1);
+            float slope = b > a ? (v[b] - v[a]) / (times[b] - times[a]) : 0.0f;
+            float before = i > 0 ? times[i] - times[i - 1] : 0.0f;
+            float after = i + 1 < count ? times[i + 1] - times[i] : 0.0f;
+            handle_in[c][i] = v[i] - slope * before / 3.0f;
+            handle_out[c][i] = v[i] + slope * after / 3.0f;
+        }
+    }
+    return true;
+}
+
+bool KeyframeTrack::set_rotation(const float *key_times, const float *xyzw, int count)
+{
+    if (!increasing(key_times, count))
+        return false;
+
+    mode = KEY_SLERP;
+    comps = 4;
+    times.assign(key_times, key_times + count);
+    for (int c = 0; c < 4; c++)
+        value[c].clear();
+    for (int c = 0; c < 3; c++)
+    {
+        handle_out[c].clear();
+        handle_in[c].clear();
+    }
+
+    // Normalized, each key on the same side as the one before (shortest arcs)
+    float prev[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    for (int i = 0; i < count; i++)
+    {
+        const float *q = xyzw + i * 4;
+        float len = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        float inv = len > 0.0f ? 1.0f / len : 0.0f;
+        float n[4] = {q[0] * inv, q[1] * inv, q[2] * inv, len > 0.0f ? q[3] * inv : 1.0f};
+        if (i > 0 && n[0] * prev[0] + n[1] * prev[1] + n[2] * prev[2] + n[3] * prev[3] < 0.0f)
+            for (int c = 0; c < 4; c++)
+                n[c] = -n[c];
+        for (int c = 0; c < 4; c++)
+        {
+            value[c].push_back(n[c]);
+            prev[c] = n[c];
+        }
+    }
+    return true;
+}
+
+bool KeyframeTrack::set_rotation(const float *key_times, const quat *keys, int count)
+{
+    return set_rotation(key_times, &keys[0].x, count);
+}
+
+// Segment k with times[k] <= time < times[k + 1], clamped to [0, keys - 2]
+int KeyframeTrack::segment(float time, int hint) const
+{
+    int last = (int)times.size() - 2;
+    if (last <= 0)
+        return 0;
+
+    int k = std::max(0, std::min(hint, last));
+    if (time >= times[k])
+    {
+        for (int step = 0; step < CURSOR_STEPS; step++)
+        {
+            if (k == last || time < times[k + 1])
+                return k;
+            k++;
+        }
+    }
+    else if (time < times[1])
+        return 0; // looped back to the start
+    else if (time >= times[k - 1])
+        return k - 1;
+
+    k = (int)(std::upper_bound(times.begin(), times.end(), time) - times.begin()) - 1;
+    return std::max(0, std::min(k, last));
+}
+
+void KeyframeTrack::evaluate(int k, float time, float *out) const
+{
+    int keys = (int)times.size();
+    if (keys == 1 || time <= times[0])
+    {
+        for (int c = 0; c < comps; c++)
+            out[c] = value[c][0];
+        return;
+    }
+    if (time >= times[keys - 1])
+    {
+        for (int c = 0; c < comps; c++)
+            out[c] = value[c][keys - 1];
+        return;
+    }
+
+    float t = (time - times[k]) / (times[k + 1] - times[k]);
+
+    if (mode == KEY_LINEAR)
+    {
+        for (int c = 0; c < 3; c++)
+            out[c] = value[c][k] + t * (value[c][k + 1] - value[c][k]);
+    }
+    else if (mode == KEY_BEZIER)
+    {
+        float u = 1.0f - t;
+        float b0 = u * u * u, b1 = 3.0f * u * u * t, b2 = 3.0f * u * t * t, b3 = t * t * t;
+        for (int c = 0; c < 3; c++)
+            out[c] = b0 * value[c][k] + b1 * handle_out[c][k] + b2 * handle_in[c][k + 1] + b3 * value[c][k + 1];
+    }
+    else
+    {
+        quat q = slerp_fast(key_quat(k), key_quat(k + 1), t);
+        out[0] = q.x;
+        out[1] = q.y;
+        out[2] = q.z;
+        out[3] = q.w;
+    }
+}
+
+quat KeyframeTrack::key_quat(int k) const
+{
+    return {value[0][k], value[1][k], value[2][k], value[3][k]};
+}
+
+void KeyframeTrack::rotation_span(float time, int &cursor, quat &a, quat &b, float &t) const
+{
+    if (times.empty() || comps != 4)
+    {
+        a = b = quat::identity();
+        t = 0.0f;
+        return;
+    }
+    cursor = segment(time, cursor);
+    int last = (int)times.size() - 1;
+    if (last == 0 || time <= times[0])
+    {
+        a = b = key_quat(0);
+        t = 0.0f;
+    }
+    else if (time >= times[last])
+    {
+        a = b = key_quat(last);
+        t = 0.0f;
+    }
+    else
+    {
+        a = key_quat(cursor);
+        b = key_quat(cursor + 1);
+        t = (time - times[cursor]) / (times[cursor + 1] - times[cursor]);
+    }
+}
+
+void KeyframeTrack::sample(float time, int &cursor, float *out) const
+{
+    if (times.empty())
+        return;
+    cursor = segment(time, cursor);
+    evaluate(cursor, time, out);
+}
+
+void KeyframeTrack::sample(float time, float *out) const
+{
+    if (times.empty())
+        return;
+    int k = (int)(std::upper_bound(times.begin(), times.end(), time) - times.begin()) - 1;
+    evaluate(std::max(0, std::min(k, (int)times.size() - 2)), time, out);
+}
+
+float AnimationClip::duration() const
+{
+    return std::max(position.end_time(), std::max(rotation.end_time(), scale.end_time()));
+}
+
+// Instances per pass: rotation key pairs are gathered, then slerped together
+static const int SAMPLE_BLOCK = 64;
+
+void sample_animation(AnimatedInstance *instances, int count, mat4 *out)
+{
+    quat from[SAMPLE_BLOCK], to[SAMPLE_BLOCK], rotation[SAMPLE_BLOCK];
+    float blend[SAMPLE_BLOCK];
+
+    for (int first = 0; first < count; first += SAMPLE_BLOCK)
+    {
+        int n = std::min(SAMPLE_BLOCK, count - first);
+        for (int j = 0; j < n; j++)
+        {
+            AnimatedInstance &inst = instances[first + j];
+            const AnimationClip &clip = *inst.clip;
+
+            float length = clip.duration();
+            if (clip.loop && length > 0.0f && (inst.time >= length || inst.time < 0.0f))
+            {
+                inst.time = std::fmod(inst.time, length);
+                if (inst.time < 0.0f)
+                    inst.time += length;
+            }
+            clip.rotation.rotation_span(inst.time, inst.cursor.rotation, from[j], to[j], blend[j]);
+        }
+
+        slerp_batch(from, to, blend, n, rotation);
+
+        for (int j = 0; j < n; j++)
+        {
+            AnimatedInstance &inst = instances[first + j];
+            float p[3] = {0.0f, 0.0f, 0.0f};
+            float s[3] = {1.0f, 1.0f, 1.0f};
+            inst.clip->position.sample(inst.time, inst.cursor.position, p);
+            inst.clip->scale.sample(inst.time, inst.cursor.scale, s);
+
+            // Rotation columns scaled per axis, then the translation
+            mat4 &m = out[first + j];
+            m = rotation[j].to_matrix();
+            for (int c = 0; c < 3; c++)
+                for (int r = 0; r < 3; r++)
+                    m.m[c * 4 + r] *= s[c];
+            m.m[12] = p[0];
+            m.m[13] = p[1];
+            m.m[14] = p[2];
+        }
+    }
+}
+
+// --------------------
+// Arc-length paths
+// --------------------
+
+BezierPath::BezierPath() {}
+
+// Forward differences of one cubic segment at step h: writes steps + 1
+// samples (positions, and tangents when not null) at u = 0, h, .., 1
+static void forward_difference(const float *k, int steps, float *xyz, float *tangents)
+{
+    float h = 1.0f / steps;
+    for (int c = 0; c < 3; c++)
+    {
+        float a = k[c], b = k[3 + c], cc = k[6 + c], d = k[9 + c];
+        float f = d;
+        float d1 = a * h * h * h + b * h * h + cc * h;
+        float d2 = 6.0f * a * h * h * h + 2.0f * b * h * h;
+        float d3 = 6.0f * a * h * h * h;
+        float g = cc;
+        float g1 = 3.0f * a * h * h + 2.0f * b * h;
+        float g2 = 6.0f * a * h * h;
+        for (int i = 0; i <= steps; i++)
+        {
+            xyz[i * 3 + c] = f;
+            f += d1;
+            d1 += d2;
+            d2 += d3;
+            if (tangents)
+            {
+                tangents[i * 3 + c] = g;
+                g += g1;
+                g1 += g2;
+            }
+        }
+    }
+}
+
+bool BezierPath::build(const vec3_t *points, int count, int samples)
+{
+    if (count < 4 || (count - 1) % 3 != 0 || samples < 1)
+        return false;
+    for (int i = 0; i < count; i++)
+        if (!std::isfinite(points[i].x) || !std::isfinite(points[i].y) || !std::isfinite(points[i].z))
+            return false;
+
+    int segments = (count - 1) / 3;
+    coeffs.resize(segments * 12);
+    for (int s = 0; s < segments; s++)
+    {
+        const vec3_t *p = points + s * 3;
+        float *k = &coeffs[s * 12];
+        const float p0[3] = {p[0].x, p[0].y, p[0].z}, p1[3] = {p[1].x, p[1].y, p[1].z};
+        const float p2[3] = {p[2].x, p[2].y, p[2].z}, p3[3] = {p[3].x, p[3].y, p[3].z};
+        for (int c = 0; c < 3; c++)
+        {
+            k[c] = -p0[c] + 3.0f * p1[c] - 3.0f * p2[c] + p3[c];
+            k[3 + c] = 3.0f * p0[c] - 6.0f * p1[c] + 3.0f * p2[c];
+            k[6 + c] = -3.0f * p0[c] + 3.0f * p1[c];
+            k[9 + c] = p0[c];
+        }
+    }
+
+    // Cumulative chord length at even steps of t
+    int n = segments * samples;
+    arc.assign(n + 1, 0.0f);
+    std::vector<float> run((samples + 1) * 3);
+    double total = 0.0;
+    for (int s = 0; s < segments; s++)
+    {
+        forward_difference(&coeffs[s * 12], samples, run.data(), nullptr);
+        for (int i = 1; i <= samples; i++)
+        {
+            float dx = run[i * 3] - run[i * 3 - 3], dy = run[i * 3 + 1] - run[i * 3 - 2], dz = run[i * 3 + 2] - run[i * 3 - 1];
+            total += std::sqrt(dx * dx + dy * dy + dz * dz);
+            arc[s * samples + i] = (float)total;
+        }
+    }
+
+    // Invert: t at n + 1 evenly spaced distances
+    uniform_t.assign(n + 1, 0.0f);
+    float step_t = 1.0f / samples;
+    int j = 0;
+    for (int i = 0; i <= n; i++)
+    {
+        float target = arc[n] * i / n;
+        while (j < n - 1 && arc[j + 1] < target)
+            j++;
+        float span = arc[j + 1] - arc[j];
+        float f = span > 0.0f ? (target - arc[j]) / span : 0.0f;
+        uniform_t[i] = (j + std::max(0.0f, std::min(1.0f, f))) * step_t;
+    }
+    uniform_t[n] = (float)segments;
+    return true;
+}
+
+float BezierPath::t_at(float distance) const
+{
+    if (uniform_t.empty())
+        return 0.0f;
+    int n = (int)uniform_t.size() - 1;
+    float total = arc.back();
+    if (!(distance > 0.0f) || !(total > 0.0f))
+        return 0.0f;
+    if (distance >= total)
+        return uniform_t[n];
+
+    float f = distance / total * n;
+    int i = std::min((int)f, n - 1);
+    return uniform_t[i] + (f - i) * (uniform_t[i + 1] - uniform_t[i]);
+}
+
+// Segment holding t and the local parameter u in [0, 1]
+int BezierPath::locate(float t, float &u) const
+{
+    int segments = segment_count();
+    int s = std::max(0, std::min(segments - 1, (int)std::floor(t)));
+    u = std::max(0.0f, std::min(1.0f, t - s));
+    return s;
+}
+
+vec3_t BezierPath::position(float t) const
+{
+    if (coeffs.empty())
+        return vec3_t(0, 0, 0);
+    float u;
+    const float *k = &coeffs[locate(t, u) * 12];
+    return vec3_t(
+        ((k[0] * u + k[3]) * u + k[6]) * u + k[9],
+        ((k[1] * u + k[4]) * u + k[7]) * u + k[10],
+        ((k[2] * u + k[5]) * u + k[8]) * u + k[11]);
+}
+
+vec3_t BezierPath::tangent(float t) const
+{
+    if (coeffs.empty())
+        return vec3_t(0, 0, 0);
+    float u;
+    const float *k = &coeffs[locate(t, u) * 12];
+    return vec3_t(
+        (3.0f * k[0] * u + 2.0f * k[3]) * u + k[6],
+        (3.0f * k[1] * u + 2.0f * k[4]) * u + k[7],
+        (3.0f * k[2] * u + 2.0f * k[5]) * u + k[8]);
+}
+
+void BezierPath::evaluate_at(const float *distances, int count, float *xyz, float *tangents) const
+{
+    if (coeffs.empty())
+    {
+        std::fill(xyz, xyz + count * 3, 0.0f);
+        if (tangents)
+            std::fill(tangents, tangents + count * 3, 0.0f);
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        float u;
+        const float *k = &coeffs[locate(t_at(distances[i]), u) * 12];
+        for (int c = 0; c < 3; c++)
+        {
+            xyz[i * 3 + c] = ((k[c] * u + k[3 + c]) * u + k[6 + c]) * u + k[9 + c];
+            if (tangents)
+                tangents[i * 3 + c] = (3.0f * k[c] * u + 2.0f * k[3 + c]) * u + k[6 + c];
+        }
+    }
+}
+
+void BezierPath::evaluate_uniform(int steps, float *xyz, float *tangents) const
+{
+    if (steps < 1)
+        return;
+    // Each segment writes steps + 1 samples; the next one overwrites the
+    // last with its (equal) first
+    for (int s = 0; s < segment_count(); s++)
+        forward_difference(&coeffs[s * 12], steps, xyz + s * steps * 3, tangents ? tangents + s * steps * 3 : nullptr);
+}
@@ -0,0 +1,541 @@
+#include "bvh.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+static const int BVH_BINS = 12;
+static const int BVH_LEAF_SIZE = 4;
+
+static void grow(AABB &box, const AABB &other)
+{
+    for (int k = 0; k < 3; k++)
+    {
+        box.min[k] = std::min(box.min[k], other.min[k]);
+        box.max[k] = std::max(box.max[k], other.max[k]);
+    }
+}
+
+static AABB empty_box()
+{
+    AABB box;
+    for (int k = 0; k < 3; k++)
+    {
+        box.min[k] = FLT_MAX;
+        box.max[k] = -FLT_MAX;
+    }
+    return box;
+}
+
+static float half_area(const AABB &box)
+{
+    float dx = box.max[0] - box.min[0];
+    float dy = box.max[1] - box.min[1];
+    float dz = box.max[2] - box.min[2];
+    if (dx < 0.0f || dy < 0.0f || dz < 0.0f)
+        return 0.0f;
+    return dx * dy + dy * dz + dz * dx;
+}
+
+// 0 = outside, 1 = straddling, 2 = inside. Bits of mask are planes the
+// parent was already fully inside of; those are skipped and inherited.
+static int classify(const Frustum &f, const AABB &box, unsigned &mask)
+{
+    int result = 2;
+    for (int i = 0; i < 6; i++)
+    {
+        if (mask & (1u << i))
+            continue;
+
+        const Plane &p = f.planes[i];
+        float cx = 0.5f * (box.min[0] + box.max[0]);
+        float cy = 0.5f * (box.min[1] + box.max[1]);
+        float cz = 0.5f * (box.min[2] + box.max[2]);
+        float ex = 0.5f * (box.max[0] - box.min[0]);
+        float ey = 0.5f * (box.max[1] - box.min[1]);
+        float ez = 0.5f * (box.max[2] - box.min[2]);
+
+        float dist = p.nx * cx + p.ny * cy + p.nz * cz + p.d;
+        float reach = std::fabs(p.nx) * ex + std::fabs(p.ny) * ey + std::fabs(p.nz) * ez;
+
+        if (dist < -reach)
+            return 0;
+        if (dist >= reach)
+            mask |= 1u << i;
+        else
+            result = 1;
+    }
+    return result;
+}
+
+// Slab test against the box grown by pad; returns the entry t or -1 on a miss
+static float ray_box(const AABB &box, float pad, const float origin[3], const float inv_dir[3], float t_max)
+{
+    float t0 = 0.0f;
+    float t1 = t_max;
+    for (int k = 0; k < 3; k++)
+    {
+        float a = (box.min[k] - pad - origin[k]) * inv_dir[k];
+        float b = (box.max[k] + pad - origin[k]) * inv_dir[k];
+        if (a > b)
+            std::swap(a, b);
+        t0 = std::max(t0, a);
+        t1 = std::min(t1, b);
+        if (t0 > t1)
+            return -1.0f;
+    }
+    return t0;
+}
+
+// Closest approach between the ray origin + t * dir (t >= 0, |dir| = 1)
+// and segment a-b (Ericson, Real-Time Collision Detection 5.1.9)
+static float ray_segment(const float origin[3], const float dir[3], const float a[3], const float b[3], float &t_out)
+{
+    float e[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float r[3] = {origin[0] - a[0], origin[1] - a[1], origin[2] - a[2]};
+
+    float ee = e[0] * e[0] + e[1] * e[1] + e[2] * e[2];
+    float f = e[0] * r[0] + e[1] * r[1] + e[2] * r[2];
+    float c = dir[0] * r[0] + dir[1] * r[1] + dir[2] * r[2];
+    float bd = dir[0] * e[0] + dir[1] * e[1] + dir[2] * e[2];
+
+    float t = 0.0f;
+    float s = 0.0f;
+    if (ee <= 1e-12f)
+    {
+        t = std::max(0.0f, -c);
+    }
+    else
+    {
+        float denom = ee - bd * bd;
+        if (denom > 1e-12f)
+            t = std::max(0.0f, (bd * f - c * ee) / denom);
+
+        s = (bd * t + f) / ee;
+        if (s < 0.0f)
+        {
+            s = 0.0f;
+            t = std::max(0.0f, -c);
+        }
+        else if (s > 1.0f)
+        {
+            s = 1.0f;
+            t = std::max(0.0f, bd - c);
+        }
+    }
+
+    float dx = origin[0] + t * dir[0] - (a[0] + s * e[0]);
+    float dy = origin[1] + t * dir[1] - (a[1] + s * e[1]);
+    float dz = origin[2] + t * dir[2] - (a[2] + s * e[2]);
+
+    t_out = t;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+// --------------------
+// Build / refit
+// --------------------
+
+SceneBVH::SceneBVH() {}
+
+void SceneBVH::clear()
+{
+    nodes.clear();
+    items.clear();
+    object_bounds.clear();
+}
+
+void SceneBVH::build(const SceneObject *objects, int count)
+{
+    clear();
+
+    object_bounds.resize(count);
+    std::vector<float> centroids(count * 3);
+    for (int i = 0; i < count; i++)
+    {
+        const Mesh *mesh = objects[i].mesh;
+        if (!mesh || mesh->empty())
+        {
+            object_bounds[i] = empty_box();
+            continue;
+        }
+
+        AABB box = transform_aabb(mesh->aabb(), objects[i].model);
+        object_bounds[i] = box;
+        for (int k = 0; k < 3; k++)
+            centroids[i * 3 + k] = 0.5f * (box.min[k] + box.max[k]);
+        items.push_back(i);
+    }
+
+    if (items.empty())
+        return;
+
+    nodes.reserve(items.size() * 2);
+    nodes.push_back(BvhNode());
+    build_node(0, 0, (int)items.size(), centroids);
+}
+
+void SceneBVH::build_node(int index, int first, int count, const std::vector<float> &centroids)
+{
+    AABB box = empty_box();
+    AABB centre_box = empty_box();
+    for (int i = first; i < first + count; i++)
+    {
+        grow(box, object_bounds[items[i]]);
+        const float *c = &centroids[items[i] * 3];
+        AABB point = {{c[0], c[1], c[2]}, {c[0], c[1], c[2]}};
+        grow(centre_box, point);
+    }
+
+    nodes[index].box = box;
+    nodes[index].left = -1;
+    nodes[index].first = first;
+    nodes[index].count = count;
+
+    if (count <= BVH_LEAF_SIZE)
+        return;
+
+    // Binned SAH over all three axes
+    int best_axis = -1;
+    int best_split = 0;
+    float best_cost = FLT_MAX;
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float lo = centre_box.min[axis];
+        float extent = centre_box.max[axis] - lo;
+        if (extent <= 0.0f)
+            continue;
+
+        float scale = BVH_BINS / extent;
+        AABB bin_box[BVH_BINS];
+        int bin_count[BVH_BINS] = {};
+        for (int b = 0; b < BVH_BINS; b++)
+            bin_box[b] = empty_box();
+
+        for (int i = first; i < first + count; i++)
+        {
+            int b = std::min(BVH_BINS - 1, (int)((centroids[items[i] * 3 + axis] - lo) * scale));
+            bin_count[b]++;
+            grow(bin_box[b], object_bounds[items[i]]);
+        }
+
+        // Sweep from the right to get suffix areas, then from the left
+        float right_area[BVH_BINS];
+        int right_count[BVH_BINS];
+        AABB acc = empty_box();
+        int n = 0;
+        for (int b = BVH_BINS - 1; b > 0; b--)
+        {
+            grow(acc, bin_box[b]);
+            n += bin_count[b];
+            right_area[b] = half_area(acc);
+            right_count[b] = n;
+        }
+
+        acc = empty_box();
+        n = 0;
+        for (int b = 0; b < BVH_BINS - 1; b++)
+        {
+            grow(acc, bin_box[b]);
+            n += bin_count[b];
+            if (n == 0 || right_count[b + 1] == 0)
+                continue;
+
+            float cost = n * half_area(acc) + right_count[b + 1] * right_area[b + 1];
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_axis = axis;
+                best_split = b + 1;
+            }
+        }
+    }
+
+    int mid;
+    if (best_axis < 0)
+    {
+        // All centroids coincide: halve the range so depth stays bounded
+        mid = first + count / 2;
+    }
+    else
+    {
+        if (best_cost >= count * half_area(box) && count <= BVH_LEAF_SIZE * 2)
+            return;
+
+        float lo = centre_box.min[best_axis];
+        float scale = BVH_BINS / (centre_box.max[best_axis] - lo);
+        int *split = std::partition(
+            items.data() + first, items.data() + first + count,
+            [&](int obj) {
+                int b = std::min(BVH_BINS - 1, (int)((centroids[obj * 3 + best_axis] - lo) * scale));
+                return b < best_split;
+            });
+        mid = (int)(split - items.data());
+    }
+
+    int left = (int)nodes.size();
+    nodes.push_back(BvhNode());
+    nodes.push_back(BvhNode());
+    nodes[index].left = left;
+
+    build_node(left, first, mid - first, centroids);
+    build_node(left + 1, mid, first + count - mid, centroids);
+}
+
+void SceneBVH::refit(const SceneObject *objects)
+{
+    for (int obj : items)
+        object_bounds[obj] = transform_aabb(objects[obj].mesh->aabb(), objects[obj].model);
+
+    // Children are always stored after their parent
+    for (int i = (int)nodes.size() - 1; i >= 0; i--)
+        fit_node(i);
+}
+
+void SceneBVH::fit_node(int index)
+{
+    BvhNode &n = nodes[index];
+    if (n.left >= 0)
+    {
+        n.box = nodes[n.left].box;
+        grow(n.box, nodes[n.left + 1].box);
+        return;
+    }
+
+    n.box = empty_box();
+    for (int i = n.first; i < n.first + n.count; i++)
+        grow(n.box, object_bounds[items[i]]);
+}
+
+// --------------------
+// Queries
+// --------------------
+
+void SceneBVH::query_frustum(const Frustum &f, std::vector<int> &out) const
+{
+    if (nodes.empty())
+        return;
+
+    static thread_local std::vector<std::pair<int, unsigned>> stack;
+    stack.clear();
+    stack.push_back({0, 0u});
+
+    while (!stack.empty())
+    {
+        int index = stack.back().first;
+        unsigned mask = stack.back().second;
+        stack.pop_back();
+
+        const BvhNode &n = nodes[index];
+        int side = classify(f, n.box, mask);
+        if (side == 0)
+            continue;
+
+        if (side == 2 || n.left < 0)
+        {
+            for (int i = n.first; i < n.first + n.count; i++)
+            {
+                // Leaves holding several objects still test each one
+                unsigned item_mask = mask;
+                if (side == 2 || classify(f, object_bounds[items[i]], item_mask) != 0)
+                    out.push_back(items[i]);
+            }
+            continue;
+        }
+
+        stack.push_back({n.left + 1, mask});
+        stack.push_back({n.left, mask});
+    }
+}
+
+void pick_object_edge(
+    const SceneObject &object,
+    int object_index,
+    const float origin[3],
+    const float dir[3],
+    float radius,
+    EdgePick &best)
+{
+    const Mesh *mesh = object.mesh;
+    if (!mesh)
+        return;
+
+    const float *xyz = mesh->position_data();
+    const int(*edges)[2] = mesh->edge_data();
+    const float *m = object.model.m;
+
+    static thread_local std::vector<float> world;
+    world.resize(mesh->vertex_count() * 3);
+    for (int v = 0; v < mesh->vertex_count(); v++)
+    {
+        const float *p = xyz + v * 3;
+        for (int k = 0; k < 3; k++)
+            world[v * 3 + k] = m[k] * p[0] + m[4 + k] * p[1] + m[8 + k] * p[2] + m[12 + k];
+    }
+
+    for (int e = 0; e < mesh->edge_count(); e++)
+    {
+        float t;
+        float d = ray_segment(origin, dir, &world[edges[e][0] * 3], &world[edges[e][1] * 3], t);
+        if (d > radius)
+            continue;
+
+        if (best.object < 0 || t < best.t || (t == best.t && d < best.distance))
+        {
+            best.object = object_index;
+            best.edge = e;
+            best.distance = d;
+            best.t = t;
+        }
+    }
+}
+
+EdgePick SceneBVH::pick_edge(
+    const SceneObject *objects,
+    const float origin[3],
+    const float dir[3],
+    float radius) const
+{
+    EdgePick best = {-1, -1, 0.0f, FLT_MAX};
+    if (nodes.empty())
+        return best;
+
+    float inv_dir[3];
+    for (int k = 0; k < 3; k++)
+        inv_dir[k] = dir[k] != 0.0f ? 1.0f / dir[k] : FLT_MAX;
+
+    // Entry t of the padded box; anything entering after the best hit is skipped
+    static thread_local std::vector<std::pair<float, int>> stack;
+    stack.clear();
+
+    float t_root = ray_box(nodes[0].box, radius, origin, inv_dir, FLT_MAX);
+    if (t_root >= 0.0f)
+        stack.push_back({t_root, 0});
+
+    while (!stack.empty())
+    {
+        float t_enter = stack.back().first;
+        const BvhNode &n = nodes[stack.back().second];
+        stack.pop_back();
+
+        if (t_enter > best.t)
+            continue;
+
+        if (n.left < 0)
+        {
+            for (int i = n.first; i < n.first + n.count; i++)
+            {
+                int obj = items[i];
+                if (ray_box(object_bounds[obj], radius, origin, inv_dir, best.t) >= 0.0f)
+                    pick_object_edge(objects[obj], obj, origin, dir, radius, best);
+            }
+            continue;
+        }
+
+        float ta = ray_box(nodes[n.left].box, radius, origin, inv_dir, best.t);
+        float tb = ray_box(nodes[n.left + 1].box, radius, origin, inv_dir, best.t);
+
+        // Push the farther child first so the nearer one is visited next
+        if (ta >= 0.0f && tb >= 0.0f && ta < tb)
+        {
+            stack.push_back({tb, n.left + 1});
+            stack.push_back({ta, n.left});
+        }
+        else
+        {
+            if (ta >= 0.0f)
+                stack.push_back({ta, n.left});
+            if (tb >= 0.0f)
+                stack.push_back({tb, n.left + 1});
+        }
+    }
+    return best;
+}
+
+void SceneBVH::select_rect(
+    const SceneObject *objects,
+    const mat4 &view,
+    const mat4 &projection,
+    float x0, float y0,
+    float x1, float y1,
+    int screen_width,
+    int screen_height,
+    std::vector<int> &out) const
+{
+    // Pixels to NDC (screen y points down)
+    float nx0 = 2.0f * std::min(x0, x1) / screen_width - 1.0f;
+    float nx1 = 2.0f * std::max(x0, x1) / screen_width - 1.0f;
+    float ny0 = 1.0f - 2.0f * std::max(y0, y1) / screen_height;
+    float ny1 = 1.0f - 2.0f * std::min(y0, y1) / screen_height;
+
+    mat4 view_projection = multiply(projection, view);
+    Frustum rect = Frustum::from_matrix_rect(view_projection, nx0, ny0, nx1, ny1);
+
+    static thread_local std::vector<int> candidates;
+    candidates.clear();
+    query_frustum(rect, candidates);
+
+    for (int obj : candidates)
+    {
+        // Local-space planes so vertices are tested untransformed
+        Frustum local = Frustum::from_matrix_rect(
+            multiply(view_projection, objects[obj].model), nx0, ny0, nx1, ny1);
+
+        const Mesh *mesh = objects[obj].mesh;
+        const float *xyz = mesh->position_data();
+        for (int v = 0; v < mesh->vertex_count(); v++)
+        {
+            if (frustum_intersects_sphere(local, xyz + v * 3, 0.0f))
+            {
+                out.push_back(obj);
+                break;
+            }
+        }
+    }
+}
+
+bool ray_from_screen(
+    const mat4 &view,
+    const mat4 &projection,
+    float px, float py,
+    int screen_width,
+    int screen_height,
+    float origin[3],
+    float dir[3])
+{
+    mat4 inv;
+    if (!invert(multiply(projection, view), inv))
+        return false;
+
+    float nx = 2.0f * px / screen_width - 1.0f;
+    float ny = 1.0f - 2.0f * py / screen_height;
+
+    // Unproject the pixel on the near and far planes
+    float p[2][3];
+    for (int i = 0; i < 2; i++)
+    {
+        float nz = i == 0 ? -1.0f : 1.0f;
+        const float *m = inv.m;
+        float w = m[3] * nx + m[7] * ny + m[11] * nz + m[15];
+        if (std::fabs(w) < 1e-12f)
+            return false;
+        for (int k = 0; k < 3; k++)
+            p[i][k] = (m[k] * nx + m[4 + k] * ny + m[8 + k] * nz + m[12 + k]) / w;
+    }
+
+    float len = 0.0f;
+    for (int k = 0; k < 3; k++)
+    {
+        origin[k] = p[0][k];
+        dir[k] = p[1][k] - p[0][k];
+        len += dir[k] * dir[k];
+    }
+    if (len <= 0.0f)
+        return false;
+
+    len = 1.0f / std::sqrt(len);
+    for (int k = 0; k < 3; k++)
+        dir[k] *= len;
+    return true;
+}
@@ -100,4 +100,142 @@ void draw_line_f(Canvas &c, float x0, float y0, float x1, float y1, float intens
         x += x_inc;
         y += y_inc;
     }
-}
\ No newline at end of file
+}
+
+// One DDA step of draw_line_f: the centre sample plus the thickness samples
+static void splat_step(Canvas &c, float x, float y, float perp_x, float perp_y, float intensity, float thickness)
+{
+    for (float t = -thickness / 2; t <= thickness / 2; t += 1.0f)
+        set_pixel_f(c, x + t * perp_x, y + t * perp_y, intensity);
+    set_pixel_f(c, x, y, intensity);
+}
+
+void draw_polyline_f(Canvas &c, const float *xy, int count, float intensity, float thickness)
+{
+    if (count <= 0)
+        return;
+    if (count == 1)
+    {
+        set_pixel_f(c, xy[0], xy[1], intensity);
+        return;
+    }
+
+    float perp_x = 0.0f;
+    float perp_y = 0.0f;
+
+    // Each segment stops one step short of its end; the next segment starts there
+    for (int i = 0; i + 1 < count; i++)
+    {
+        float x = xy[i * 2];
+        float y = xy[i * 2 + 1];
+        float dx = xy[i * 2 + 2] - x;
+        float dy = xy[i * 2 + 3] - y;
+        float steps = std::max(std::abs(dx), std::abs(dy));
+        if (steps == 0)
+            continue;
+
+        float x_inc = dx / steps;
+        float y_inc = dy / steps;
+
+        float len = std::sqrt(dx * dx + dy * dy);
+        perp_x = -dy / len;
+        perp_y = dx / len;
+
+        for (int j = 0; j < steps; j++)
+        {
+            splat_step(c, x, y, perp_x, perp_y, intensity, thickness);
+            x += x_inc;
+            y += y_inc;
+        }
+    }
+
+    const float *first = xy;
+    const float *last = xy + (count - 1) * 2;
+    bool closed = count > 2 && first[0] == last[0] && first[1] == last[1];
+    if (!closed)
+        splat_step(c, last[0], last[1], perp_x, perp_y, intensity, thickness);
+}
+
+#ifdef TINY3D_DEPTH_CUE
+void draw_line_f_cued(Canvas &c, float x0, float y0, float x1, float y1,
+                      float intensity0, float intensity1, float thickness)
+{
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float steps = std::max(std::abs(dx), std::abs(dy));
+
+    if (steps == 0)
+    {
+        set_pixel_f(c, x0, y0, intensity0);
+        return;
+    }
+
+    float x_inc = dx / steps;
+    float y_inc = dy / steps;
+    float i_inc = (intensity1 - intensity0) / steps;
+
+    float len = std::sqrt(dx * dx + dy * dy);
+    float perp_x = -dy / len;
+    float perp_y = dx / len;
+
+    float x = x0;
+    float y = y0;
+    float intensity = intensity0;
+
+    for (int i = 0; i <= steps; i++)
+    {
+        splat_step(c, x, y, perp_x, perp_y, intensity, thickness);
+        x += x_inc;
+        y += y_inc;
+        intensity += i_inc;
+    }
+}
+
+void draw_polyline_f_cued(Canvas &c, const float *xy, const float *intensity, int count, float thickness)
+{
+    if (count <= 0)
+        return;
+    if (count == 1)
+    {
+        set_pixel_f(c, xy[0], xy[1], intensity[0]);
+        return;
+    }
+
+    float perp_x = 0.0f;
+    float perp_y = 0.0f;
+
+    for (int i = 0; i + 1 < count; i++)
+    {
+        float x = xy[i * 2];
+        float y = xy[i * 2 + 1];
+        float dx = xy[i * 2 + 2] - x;
+        float dy = xy[i * 2 + 3] - y;
+        float steps = std::max(std::abs(dx), std::abs(dy));
+        if (steps == 0)
+            continue;
+
+        float x_inc = dx / steps;
+        float y_inc = dy / steps;
+        float v = intensity[i];
+        float v_inc = (intensity[i + 1] - v) / steps;
+
+        float len = std::sqrt(dx * dx + dy * dy);
+        perp_x = -dy / len;
+        perp_y = dx / len;
+
+        for (int j = 0; j < steps; j++)
+        {
+            splat_step(c, x, y, perp_x, perp_y, v, thickness);
+            x += x_inc;
+            y += y_inc;
+            v += v_inc;
+        }
+    }
+
+    const float *first = xy;
+    const float *last = xy + (count - 1) * 2;
+    bool closed = count > 2 && first[0] == last[0] && first[1] == last[1];
+    if (!closed)
+        splat_step(c, last[0], last[1], perp_x, perp_y, intensity[count - 1], thickness);
+}
+#endif
@@ -0,0 +1,821 @@
+#include "chunked_scene.h"
+#include "culling.h"
+#include "points.h"
+#include "renderer.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+static_assert(sizeof(ChunkedSceneHeader) == 64, "ChunkedSceneHeader layout changed");
+static_assert(sizeof(ChunkRecord) == 56, "ChunkRecord layout changed");
+
+static const uint64_t CHUNK_ALIGN = 4096;
+
+static uint64_t align_up(uint64_t offset, uint64_t alignment)
+{
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+static long long cell_key(int x, int y, int z)
+{
+    // 21 bits per axis is plenty for a chunk grid
+    return ((long long)(x & 0x1fffff) << 42) | ((long long)(y & 0x1fffff) << 21) | (long long)(z & 0x1fffff);
+}
+
+// --------------------
+// Writer
+// --------------------
+
+// Working-set estimate per gathered vertex (spill record, index, local
+// slot, position) and per gathered edge (spill record, index, local pair),
+// used to size batches
+static const uint64_t BATCH_VERTEX_BYTES = 48;
+static const uint64_t BATCH_EDGE_BYTES = 40;
+
+// Spill records: an id with its kind in the top two bits
+static const uint64_t SPILL_VERTEX = 0;
+static const uint64_t SPILL_EDGE = 1ull << 62;
+static const uint64_t SPILL_USED = 2ull << 62; // vertex used by another cell's edge
+static const uint64_t SPILL_ID = SPILL_EDGE - 1;
+static const size_t SPILL_BUFFER_BYTES = (size_t)64 << 20;
+
+static bool seek_to(FILE *f, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(f, (long long)offset, SEEK_SET) == 0;
+#else
+    return fseeko(f, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+/*
+ * Temporary file with one contiguous region of records per batch, sized
+ * from the counting pass. Records are buffered per batch and appended at
+ * that batch's cursor, so one pass over the input distributes everything
+ * and each batch is later read back as one sequential run.
+ */
+struct SpillFile
+{
+    FILE *file;
+    std::vector<uint64_t> cursor; // next record per batch
+    std::vector<uint64_t> end;    // region end per batch
+    std::vector<std::vector<uint64_t>> pending;
+    size_t buffer_records;
+    bool ok;
+
+    SpillFile(const std::vector<uint64_t> &region_sizes)
+        : file(std::tmpfile()), buffer_records(0), ok(file != nullptr)
+    {
+        uint64_t at = 0;
+        for (size_t b = 0; b < region_sizes.size(); b++)
+        {
+            cursor.push_back(at);
+            at += region_sizes[b];
+            end.push_back(at);
+        }
+        pending.resize(region_sizes.size());
+        buffer_records = std::max<size_t>(64, SPILL_BUFFER_BYTES / 8 / std::max<size_t>(1, pending.size()));
+    }
+
+    ~SpillFile()
+    {
+        if (file)
+            std::fclose(file);
+    }
+
+    void flush(int b)
+    {
+        std::vector<uint64_t> &buf = pending[b];
+        if (buf.empty() || !ok)
+            return;
+        ok = cursor[b] + buf.size() <= end[b] && seek_to(file, cursor[b] * 8) &&
+             std::fwrite(buf.data(), 8, buf.size(), file) == buf.size();
+        cursor[b] += buf.size();
+        buf.clear();
+    }
+
+    void put(int b, uint64_t record)
+    {
+        pending[b].push_back(record);
+        if (pending[b].size() >= buffer_records)
+            flush(b);
+    }
+
+    bool read(int b, uint64_t region_size, std::vector<uint64_t> &out)
+    {
+        out.resize((size_t)region_size);
+        return ok && (region_size == 0 ||
+                      (seek_to(file, (end[b] - region_size) * 8) &&
+                       std::fread(out.data(), 8, out.size(), file) == out.size()));
+    }
+
+private:
+    SpillFile(const SpillFile &);
+    SpillFile &operator=(const SpillFile &);
+};
+
+struct CellGrid
+{
+    float lo[3], extent[3];
+    int cells;
+
+    long long key(const float *p) const
+    {
+        int c[3];
+        for (int k = 0; k < 3; k++)
+        {
+            // Clamped before the cast: a NaN or infinite t must not reach (int)
+            float t = extent[k] > 0.0f ? (p[k] - lo[k]) / extent[k] : 0.0f;
+            t = t > 0.0f ? std::min(t, 1.0f) : 0.0f;
+            c[k] = std::min((int)(t * cells), cells - 1);
+        }
+        return cell_key(c[0], c[1], c[2]);
+    }
+};
+
+static int find_chunk(const std::vector<long long> &cells, long long key)
+{
+    return (int)(std::lower_bound(cells.begin(), cells.end(), key) - cells.begin());
+}
+
+template <typename Index>
+static bool edge_valid(const Index *e, uint64_t vertex_count)
+{
+    // Negative int indices wrap to huge values and fail the range test
+    return (uint64_t)e[0] < vertex_count && (uint64_t)e[1] < vertex_count && e[0] != e[1];
+}
+
+/*
+ * Out-of-core writer: the input is only read (a mapped file works), and
+ * the writer holds the chunk table plus one batch of chunks. Passes over
+ * the input: bounds, vertices per cell, edges per cell, then one
+ * distribution pass that spills vertex and edge ids to a temporary file,
+ * grouped by batch of consecutive cells. Each batch is then read back in
+ * one sequential run and written out.
+ */
+template <typename Index>
+static bool write_chunks(
+    const float *xyz,
+    uint64_t vertex_count,
+    const Index (*edges)[2],
+    uint64_t edge_count,
+    int cells_per_axis,
+    const char *path,
+    size_t batch_bytes)
+{
+    if (vertex_count == 0 || vertex_count > SPILL_ID || edge_count > SPILL_ID ||
+        cells_per_axis <= 0 || cells_per_axis > 0x1fffff)
+        return false;
+
+    ChunkedSceneHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CHUNKED_SCENE_MAGIC, 4);
+    header.version = CHUNKED_SCENE_VERSION;
+
+    for (int k = 0; k < 3; k++)
+    {
+        header.bounds_min[k] = xyz[k];
+        header.bounds_max[k] = xyz[k];
+        header.grid_dims[k] = cells_per_axis;
+    }
+    for (uint64_t i = 0; i < vertex_count; i++)
+        for (int k = 0; k < 3; k++)
+        {
+            if (!std::isfinite(xyz[i * 3 + k]))
+                return false;
+            header.bounds_min[k] = std::min(header.bounds_min[k], xyz[i * 3 + k]);
+            header.bounds_max[k] = std::max(header.bounds_max[k], xyz[i * 3 + k]);
+        }
+
+    CellGrid grid;
+    grid.cells = cells_per_axis;
+    for (int k = 0; k < 3; k++)
+    {
+        grid.lo[k] = header.bounds_min[k];
+        grid.extent[k] = header.bounds_max[k] - header.bounds_min[k];
+    }
+
+    // ---- Non-empty cells and their sizes ----
+    std::vector<long long> cells;
+    std::vector<uint64_t> cell_vertices;
+    {
+        std::vector<std::pair<long long, uint64_t>> counts;
+        std::vector<long long> block;
+        for (uint64_t i = 0; i < vertex_count;)
+        {
+            // Sort keys a block at a time so memory stays O(cells)
+            block.clear();
+            for (; i < vertex_count && block.size() < (1u << 20); i++)
+                block.push_back(grid.key(xyz + i * 3));
+            std::sort(block.begin(), block.end());
+            for (size_t j = 0; j < block.size();)
+            {
+                size_t k = j;
+                while (k < block.size() && block[k] == block[j])
+                    k++;
+                counts.push_back(std::make_pair(block[j], (uint64_t)(k - j)));
+                j = k;
+            }
+            if (counts.size() > (1u << 20) || i == vertex_count)
+            {
+                std::sort(counts.begin(), counts.end());
+                size_t out = 0;
+                for (size_t j = 0; j < counts.size(); j++)
+                {
+                    if (out > 0 && counts[out - 1].first == counts[j].first)
+                        counts[out - 1].second += counts[j].second;
+                    else
+                        counts[out++] = counts[j];
+                }
+                counts.resize(out);
+            }
+        }
+        for (size_t j = 0; j < counts.size(); j++)
+        {
+            cells.push_back(counts[j].first);
+            cell_vertices.push_back(counts[j].second);
+        }
+    }
+
+    int chunk_count = (int)cells.size();
+    std::vector<uint64_t> cell_edges(chunk_count, 0), cell_used(chunk_count, 0);
+    for (uint64_t e = 0; e < edge_count; e++)
+    {
+        if (!edge_valid(edges[e], vertex_count))
+            continue;
+        long long key_a = grid.key(xyz + (uint64_t)edges[e][0] * 3);
+        long long key_b = grid.key(xyz + (uint64_t)edges[e][1] * 3);
+        cell_edges[find_chunk(cells, key_a)]++;
+        if (key_b != key_a)
+            cell_used[find_chunk(cells, key_b)]++;
+    }
+
+    // ---- Batches of consecutive cells (at least one cell each) ----
+    std::vector<int> batch_first, batch_of(chunk_count);
+    std::vector<uint64_t> batch_records;
+    for (int c = 0; c < chunk_count;)
+    {
+        uint64_t bytes = 0, records_in = 0;
+        batch_first.push_back(c);
+        do
+        {
+            bytes += cell_vertices[c] * BATCH_VERTEX_BYTES + cell_edges[c] * BATCH_EDGE_BYTES + cell_used[c] * 8;
+            records_in += cell_vertices[c] + cell_edges[c] + cell_used[c];
+            batch_of[c++] = (int)batch_records.size();
+        } while (c < chunk_count &&
+                 bytes + cell_vertices[c] * BATCH_VERTEX_BYTES + cell_edges[c] * BATCH_EDGE_BYTES +
+                         cell_used[c] * 8 <= batch_bytes);
+        batch_records.push_back(records_in);
+    }
+    int batch_count = (int)batch_records.size();
+    batch_first.push_back(chunk_count);
+
+    // ---- Distribute ids to their batch (vertices before edges in each) ----
+    SpillFile spill(batch_records);
+    for (uint64_t i = 0; i < vertex_count && spill.ok; i++)
+        spill.put(batch_of[find_chunk(cells, grid.key(xyz + i * 3))], SPILL_VERTEX | i);
+    for (uint64_t e = 0; e < edge_count && spill.ok; e++)
+    {
+        if (!edge_valid(edges[e], vertex_count))
+            continue;
+        long long key_a = grid.key(xyz + (uint64_t)edges[e][0] * 3);
+        long long key_b = grid.key(xyz + (uint64_t)edges[e][1] * 3);
+        spill.put(batch_of[find_chunk(cells, key_a)], SPILL_EDGE | e);
+        if (key_b != key_a)
+            spill.put(batch_of[find_chunk(cells, key_b)], SPILL_USED | (uint64_t)edges[e][1]);
+    }
+    for (int b = 0; b < batch_count; b++)
+        spill.flush(b);
+    if (!spill.ok)
+        return false;
+
+    // ---- Layout ----
+    header.chunk_count = (uint32_t)chunk_count;
+    header.chunk_table_offset = sizeof(header);
+    std::vector<ChunkRecord> records(chunk_count);
+
+    FILE *f = std::fopen(path, "wb");
+    if (!f)
+        return false;
+
+    uint64_t offset = align_up(sizeof(header) + sizeof(ChunkRecord) * (uint64_t)chunk_count, CHUNK_ALIGN);
+
+    // Records are rewritten at the end, once offsets and bounds are known
+    static const char ZERO[CHUNK_ALIGN] = {0};
+    bool ok = true;
+    for (uint64_t written = 0; written < offset && ok;)
+    {
+        size_t n = (size_t)std::min<uint64_t>(CHUNK_ALIGN, offset - written);
+        ok = std::fwrite(ZERO, 1, n, f) == n;
+        written += n;
+    }
+
+    std::vector<std::vector<uint64_t>> chunk_vertices, chunk_edges;
+    std::vector<std::vector<char>> used_elsewhere; // own vertex is an endpoint of another chunk's edge
+    std::vector<char> used_here;
+    std::vector<uint64_t> borrowed;
+    int written = 0;
+    std::vector<float> positions;
+    std::vector<uint32_t> pairs;
+
+    std::vector<uint64_t> spilled;
+
+    for (int batch = 0; batch < batch_count && ok; batch++)
+    {
+        // ---- Read the batch back and group it by chunk ----
+        int first = batch_first[batch], last = batch_first[batch + 1];
+        ok = spill.read(batch, batch_records[batch], spilled);
+
+        chunk_vertices.assign(last - first, std::vector<uint64_t>());
+        chunk_edges.assign(last - first, std::vector<uint64_t>());
+        used_elsewhere.assign(last - first, std::vector<char>());
+        for (int c = first; c < last; c++)
+        {
+            chunk_vertices[c - first].reserve((size_t)cell_vertices[c]);
+            chunk_edges[c - first].reserve((size_t)cell_edges[c]);
+            used_elsewhere[c - first].assign((size_t)cell_vertices[c], 0);
+        }
+
+        // Vertex ids arrive in ascending order, and before any edge record
+        for (size_t r = 0; r < spilled.size() && ok; r++)
+        {
+            uint64_t kind = spilled[r] & ~SPILL_ID, id = spilled[r] & SPILL_ID;
+            if (kind == SPILL_VERTEX)
+            {
+                chunk_vertices[find_chunk(cells, grid.key(xyz + id * 3)) - first].push_back(id);
+            }
+            else if (kind == SPILL_EDGE)
+            {
+                chunk_edges[find_chunk(cells, grid.key(xyz + (uint64_t)edges[id][0] * 3)) - first].push_back(id);
+            }
+            else
+            {
+                int c = find_chunk(cells, grid.key(xyz + id * 3)) - first;
+                const std::vector<uint64_t> &verts = chunk_vertices[c];
+                used_elsewhere[c][std::lower_bound(verts.begin(), verts.end(), id) - verts.begin()] = 1;
+            }
+        }
+
+        // ---- Write the batch ----
+        for (int c = first; c < last && ok; c++)
+        {
+            // Own vertices are in ascending scan order; border vertices
+            // borrowed from neighbouring chunks follow them, also sorted, so
+            // both local indices are binary searches
+            std::vector<uint64_t> &verts = chunk_vertices[c - first];
+            const std::vector<uint64_t> &chunk_edge_list = chunk_edges[c - first];
+            positions.clear();
+            pairs.clear();
+            borrowed.clear();
+
+            // Drop own vertices that only other chunks' edges use: they are
+            // drawn there, and kept here would read as isolated points
+            used_here.assign(verts.size(), 0);
+            for (size_t i = 0; i < chunk_edge_list.size(); i++)
+                for (int k = 0; k < 2; k++)
+                {
+                    uint64_t g = (uint64_t)edges[chunk_edge_list[i]][k];
+                    std::vector<uint64_t>::iterator it = std::lower_bound(verts.begin(), verts.end(), g);
+                    if (it != verts.end() && *it == g)
+                        used_here[it - verts.begin()] = 1;
+                }
+            size_t own = 0;
+            for (size_t i = 0; i < verts.size(); i++)
+                if (used_here[i] || !used_elsewhere[c - first][i])
+                    verts[own++] = verts[i];
+            verts.resize(own);
+            if (own == 0 && chunk_edge_list.empty())
+                continue;
+
+            for (size_t i = 0; i < chunk_edge_list.size(); i++)
+                for (int k = 0; k < 2; k++)
+                {
+                    uint64_t g = (uint64_t)edges[chunk_edge_list[i]][k];
+                    if (!std::binary_search(verts.begin(), verts.begin() + own, g))
+                        borrowed.push_back(g);
+                }
+            std::sort(borrowed.begin(), borrowed.end());
+            borrowed.erase(std::unique(borrowed.begin(), borrowed.end()), borrowed.end());
+            verts.insert(verts.end(), borrowed.begin(), borrowed.end());
+
+            for (size_t i = 0; i < chunk_edge_list.size(); i++)
+                for (int k = 0; k < 2; k++)
+                {
+                    uint64_t g = (uint64_t)edges[chunk_edge_list[i]][k];
+                    std::vector<uint64_t>::iterator end = verts.begin() + own;
+                    std::vector<uint64_t>::iterator it = std::lower_bound(verts.begin(), end, g);
+                    if (it == end || *it != g)
+                        it = std::lower_bound(end, verts.end(), g);
+                    pairs.push_back((uint32_t)(it - verts.begin()));
+                }
+            if (verts.size() > UINT32_MAX || pairs.size() / 2 > UINT32_MAX)
+            {
+                ok = false;
+                break;
+            }
+
+            ChunkRecord &rec = records[written++];
+            std::memset(&rec, 0, sizeof(rec));
+            rec.cell[0] = (int)((cells[c] >> 42) & 0x1fffff);
+            rec.cell[1] = (int)((cells[c] >> 21) & 0x1fffff);
+            rec.cell[2] = (int)(cells[c] & 0x1fffff);
+            rec.vertex_count = (uint32_t)verts.size();
+            rec.edge_count = (uint32_t)(pairs.size() / 2);
+            rec.data_offset = offset;
+
+            for (int k = 0; k < 3; k++)
+            {
+                rec.bounds_min[k] = xyz[verts[0] * 3 + k];
+                rec.bounds_max[k] = xyz[verts[0] * 3 + k];
+            }
+            for (size_t i = 0; i < verts.size(); i++)
+            {
+                const float *p = xyz + verts[i] * 3;
+                positions.insert(positions.end(), p, p + 3);
+                for (int k = 0; k < 3; k++)
+                {
+                    rec.bounds_min[k] = std::min(rec.bounds_min[k], p[k]);
+                    rec.bounds_max[k] = std::max(rec.bounds_max[k], p[k]);
+                }
+            }
+
+            uint64_t bytes = positions.size() * sizeof(float) + pairs.size() * sizeof(uint32_t);
+            ok = std::fwrite(positions.data(), sizeof(float), positions.size(), f) == positions.size() &&
+                 (pairs.empty() || std::fwrite(pairs.data(), sizeof(uint32_t), pairs.size(), f) == pairs.size());
+
+            // Pad to the next chunk boundary
+            uint64_t next = align_up(offset + bytes, CHUNK_ALIGN);
+            if (ok && next > offset + bytes)
+                ok = std::fwrite(ZERO, 1, (size_t)(next - offset - bytes), f) == next - offset - bytes;
+            offset = next;
+
+            std::vector<uint64_t>().swap(verts);
+        }
+    }
+
+    if (ok)
+    {
+        // Cells whose vertices were all drawn by neighbours hold no chunk
+        header.chunk_count = (uint32_t)written;
+        std::fseek(f, 0, SEEK_SET);
+        ok = std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+             std::fwrite(records.data(), sizeof(ChunkRecord), written, f) == (size_t)written;
+    }
+
+    return std::fclose(f) == 0 && ok;
+}
+
+bool write_chunked_scene(
+    const float *xyz,
+    int vertex_count,
+    const int (*edges)[2],
+    int edge_count,
+    int cells_per_axis,
+    const char *path,
+    size_t batch_bytes)
+{
+    if (vertex_count <= 0 || edge_count < 0)
+        return false;
+    return write_chunks(xyz, (uint64_t)vertex_count, edges, (uint64_t)edge_count, cells_per_axis, path, batch_bytes);
+}
+
+bool write_chunked_scene(
+    const float *xyz,
+    uint64_t vertex_count,
+    const uint64_t (*edges)[2],
+    uint64_t edge_count,
+    int cells_per_axis,
+    const char *path,
+    size_t batch_bytes)
+{
+    return write_chunks(xyz, vertex_count, edges, edge_count, cells_per_axis, path, batch_bytes);
+}
+
+// --------------------
+// Reader
+// --------------------
+
+ChunkedScene::ChunkedScene() : header(nullptr), records(nullptr)
+{
+}
+
+void ChunkedScene::close()
+{
+    file.close();
+    header = nullptr;
+    records = nullptr;
+    cell_keys.clear();
+    state.clear();
+}
+
+bool ChunkedScene::open(const char *path)
+{
+    close();
+    if (!file.open(path) || file.size() < sizeof(ChunkedSceneHeader))
+    {
+        file.close();
+        return false;
+    }
+
+    // Sizes are compared against what is left after each offset, so a
+    // hostile offset cannot wrap the sum past the file size
+    const ChunkedSceneHeader *h = reinterpret_cast<const ChunkedSceneHeader *>(file.data());
+    uint64_t size = file.size();
+    uint64_t table_bytes = (uint64_t)h->chunk_count * sizeof(ChunkRecord);
+
+    if (std::memcmp(h->magic, CHUNKED_SCENE_MAGIC, 4) != 0 || h->version != CHUNKED_SCENE_VERSION ||
+        (h->chunk_table_offset & 7) || h->chunk_table_offset > size || table_bytes > size - h->chunk_table_offset ||
+        h->chunk_count > (uint32_t)INT_MAX)
+    {
+        file.close();
+        return false;
+    }
+
+    const ChunkRecord *r = reinterpret_cast<const ChunkRecord *>(file.data() + h->chunk_table_offset);
+    cell_keys.resize(h->chunk_count);
+    for (uint32_t i = 0; i < h->chunk_count; i++)
+    {
+        uint64_t bytes = (uint64_t)r[i].vertex_count * 12 + (uint64_t)r[i].edge_count * 8;
+        if ((r[i].data_offset & 3) || r[i].data_offset > size || bytes > size - r[i].data_offset)
+        {
+            close();
+            return false;
+        }
+        cell_keys[i] = std::make_pair(cell_key(r[i].cell[0], r[i].cell[1], r[i].cell[2]), (int)i);
+    }
+    std::sort(cell_keys.begin(), cell_keys.end());
+    state.assign(h->chunk_count, 0);
+
+    header = h;
+    records = r;
+    return true;
+}
+
+AABB ChunkedScene::chunk_bounds(int i) const
+{
+    AABB box;
+    for (int k = 0; k < 3; k++)
+    {
+        box.min[k] = records[i].bounds_min[k];
+        box.max[k] = records[i].bounds_max[k];
+    }
+    return box;
+}
+
+size_t ChunkedScene::chunk_bytes(int i) const
+{
+    return (size_t)records[i].vertex_count * 12 + (size_t)records[i].edge_count * 8;
+}
+
+const float *ChunkedScene::chunk_positions(int i) const
+{
+    return reinterpret_cast<const float *>(file.data() + records[i].data_offset);
+}
+
+const uint32_t *ChunkedScene::chunk_edges(int i) const
+{
+    return reinterpret_cast<const uint32_t *>(
+        file.data() + records[i].data_offset + (size_t)records[i].vertex_count * 12);
+}
+
+bool ChunkedScene::check_chunk(int i) const
+{
+    static thread_local std::vector<unsigned char> covered;
+
+    if (!(state[i] & CHUNK_CHECKED))
+    {
+        // First touch: one pass over the edges, which are about to be paged
+        // in for drawing anyway
+        const ChunkRecord &r = records[i];
+        const uint32_t *pairs = chunk_edges(i);
+        covered.assign(r.vertex_count, 0);
+        bool valid = true;
+        for (uint64_t k = 0; k < (uint64_t)r.edge_count * 2 && valid; k++)
+        {
+            valid = pairs[k] < r.vertex_count;
+            if (valid)
+                covered[pairs[k]] = 1;
+        }
+
+        unsigned char flags = CHUNK_CHECKED;
+        if (valid)
+        {
+            flags |= CHUNK_VALID;
+            if (std::find(covered.begin(), covered.end(), 0) != covered.end())
+                flags |= CHUNK_POINTS;
+        }
+        state[i] = flags;
+    }
+    return (state[i] & CHUNK_VALID) != 0;
+}
+
+int ChunkedScene::chunk_points(int i, std::vector<float> &xyz) const
+{
+    static thread_local std::vector<unsigned char> covered;
+
+    xyz.clear();
+    if (!check_chunk(i) || !(state[i] & CHUNK_POINTS))
+        return 0;
+
+    const ChunkRecord &r = records[i];
+    const float *positions = chunk_positions(i);
+    const uint32_t *pairs = chunk_edges(i);
+    covered.assign(r.vertex_count, 0);
+    for (uint64_t k = 0; k < (uint64_t)r.edge_count * 2; k++)
+        covered[pairs[k]] = 1;
+    for (uint32_t v = 0; v < r.vertex_count; v++)
+        if (!covered[v])
+            xyz.insert(xyz.end(), positions + v * 3, positions + v * 3 + 3);
+    return (int)(xyz.size() / 3);
+}
+
+int ChunkedScene::find_cell(int x, int y, int z) const
+{
+    if (x < 0 || y < 0 || z < 0 ||
+        x >= header->grid_dims[0] || y >= header->grid_dims[1] || z >= header->grid_dims[2])
+        return -1;
+
+    std::pair<long long, int> key(cell_key(x, y, z), -1);
+    std::vector<std::pair<long long, int>>::const_iterator it =
+        std::lower_bound(cell_keys.begin(), cell_keys.end(), key);
+    if (it == cell_keys.end() || it->first != key.first)
+        return -1;
+    return it->second;
+}
+
+int ChunkedScene::neighbours(int i, int out[26]) const
+{
+    int n = 0;
+    const int32_t *c = records[i].cell;
+    for (int dz = -1; dz <= 1; dz++)
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                if (dx == 0 && dy == 0 && dz == 0)
+                    continue;
+                int j = find_cell(c[0] + dx, c[1] + dy, c[2] + dz);
+                if (j >= 0)
+                    out[n++] = j;
+            }
+    return n;
+}
+
+// --------------------
+// Resident-set cache
+// --------------------
+
+ChunkCache::ChunkCache(size_t budget_bytes) : budget(budget_bytes), resident(0), evicted(0)
+{
+}
+
+void ChunkCache::clear()
+{
+    lru.clear();
+    where.clear();
+    present.clear();
+    resident = 0;
+}
+
+void ChunkCache::insert_front(const ChunkedScene &scene, int chunk)
+{
+    if ((int)present.size() < scene.chunk_count())
+    {
+        present.resize(scene.chunk_count(), 0);
+        where.resize(scene.chunk_count());
+    }
+
+    lru.push_front(chunk);
+    where[chunk] = lru.begin();
+    present[chunk] = 1;
+    resident += scene.chunk_bytes(chunk);
+}
+
+void ChunkCache::evict(const ChunkedScene &scene)
+{
+    // Never evict the chunk that was just inserted
+    while (resident > budget && lru.size() > 1)
+    {
+        int victim = lru.back();
+        lru.pop_back();
+        present[victim] = 0;
+        resident -= scene.chunk_bytes(victim);
+        scene.mapping().release(scene.chunk(victim).data_offset, scene.chunk_bytes(victim));
+        evicted++;
+    }
+}
+
+void ChunkCache::touch(const ChunkedScene &scene, int chunk)
+{
+    if (chunk < (int)present.size() && present[chunk])
+    {
+        lru.splice(lru.begin(), lru, where[chunk]);
+        return;
+    }
+    insert_front(scene, chunk);
+    evict(scene);
+}
+
+bool ChunkCache::prefetch(const ChunkedScene &scene, int chunk)
+{
+    if (chunk < (int)present.size() && present[chunk])
+        return false;
+
+    // Prefetched chunks must not push out ones that are on screen
+    if (resident + scene.chunk_bytes(chunk) > budget)
+        return false;
+
+    scene.mapping().prefetch(scene.chunk(chunk).data_offset, scene.chunk_bytes(chunk));
+    insert_front(scene, chunk);
+    return true;
+}
+
+// --------------------
+// Rendering
+// --------------------
+
+void render_chunked_scene(
+    Canvas &canvas,
+    const ChunkedScene &scene,
+    ChunkCache &cache,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height,
+    ChunkRenderStats *stats)
+{
+    static thread_local std::vector<int> visible;
+    static thread_local std::vector<float> isolated;
+
+    mat4 vp = multiply(projection, view);
+    Frustum frustum = Frustum::from_matrix(vp);
+
+    ChunkRenderStats s;
+    std::memset(&s, 0, sizeof(s));
+    s.chunks_total = scene.chunk_count();
+
+    visible.clear();
+    for (int i = 0; i < scene.chunk_count(); i++)
+    {
+        if (frustum_intersects_aabb(frustum, scene.chunk_bounds(i)))
+            visible.push_back(i);
+        else
+            s.chunks_culled++;
+    }
+
+    PointOptions points = default_point_options();
+    points.threads = 1;
+
+    for (size_t v = 0; v < visible.size(); v++)
+    {
+        int i = visible[v];
+        cache.touch(scene, i);
+        if (!scene.check_chunk(i))
+        {
+            s.chunks_invalid++;
+            continue;
+        }
+
+        const ChunkRecord &r = scene.chunk(i);
+        renderer_wireframe_packed(
+            canvas,
+            scene.chunk_positions(i), (int)r.vertex_count,
+            scene.chunk_edges(i), (int)r.edge_count,
+            vp, screen_width, screen_height);
+
+        // Vertices no edge uses: all of them for point-only chunks, which
+        // are splatted in place; gathered otherwise
+        if (r.edge_count == 0)
+        {
+            render_points(canvas, nullptr, scene.chunk_positions(i), nullptr, (int)r.vertex_count, vp, points);
+            s.points_drawn += r.vertex_count;
+        }
+        else if (scene.has_points(i))
+        {
+            int n = scene.chunk_points(i, isolated);
+            render_points(canvas, nullptr, isolated.data(), nullptr, n, vp, points);
+            s.points_drawn += n;
+        }
+
+        s.chunks_drawn++;
+        s.edges_drawn += r.edge_count;
+    }
+
+    // Warm the ring around what is on screen for the next frames
+    int ring[26];
+    for (size_t v = 0; v < visible.size(); v++)
+    {
+        int n = scene.neighbours(visible[v], ring);
+        for (int k = 0; k < n; k++)
+        {
+            if (cache.prefetch(scene, ring[k]))
+                s.chunks_prefetched++;
+        }
+    }
+
+    s.resident_bytes = cache.resident_bytes();
+    if (stats)
+        *stats = s;
+}
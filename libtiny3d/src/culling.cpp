@@ -0,0 +1,190 @@
+#include "culling.h"
+#include "renderer.h"
+#include <cmath>
+#include <vector>
+
+static void normalize_plane(Plane &p)
+{
+    float len = std::sqrt(p.nx * p.nx + p.ny * p.ny + p.nz * p.nz);
+    if (len > 0.0f)
+    {
+        float inv = 1.0f / len;
+        p.nx *= inv;
+        p.ny *= inv;
+        p.nz *= inv;
+        p.d *= inv;
+    }
+}
+
+// Gribb/Hartmann: clip-space planes are sums/differences of matrix rows
+Frustum Frustum::from_matrix(const mat4 &m)
+{
+    // Column-major: row r is (m[r], m[4 + r], m[8 + r], m[12 + r])
+    float row[4][4];
+    for (int r = 0; r < 4; r++)
+        for (int c = 0; c < 4; c++)
+            row[r][c] = m.m[c * 4 + r];
+
+    Frustum f;
+    for (int i = 0; i < 6; i++)
+    {
+        int axis = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+
+        Plane &p = f.planes[i];
+        p.nx = row[3][0] + sign * row[axis][0];
+        p.ny = row[3][1] + sign * row[axis][1];
+        p.nz = row[3][2] + sign * row[axis][2];
+        p.d = row[3][3] + sign * row[axis][3];
+        normalize_plane(p);
+    }
+    return f;
+}
+
+// Same construction with x >= x0 as (row0 - x0 * row3) . p >= 0, and so on
+Frustum Frustum::from_matrix_rect(const mat4 &m, float x0, float y0, float x1, float y1)
+{
+    Frustum f = from_matrix(m);
+    const float *a = m.m;
+    const float bound[4] = {x0, x1, y0, y1};
+
+    for (int i = 0; i < 4; i++)
+    {
+        int axis = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+        float b = bound[i];
+
+        Plane &p = f.planes[i];
+        p.nx = sign * (a[axis] - b * a[3]);
+        p.ny = sign * (a[4 + axis] - b * a[7]);
+        p.nz = sign * (a[8 + axis] - b * a[11]);
+        p.d = sign * (a[12 + axis] - b * a[15]);
+        normalize_plane(p);
+    }
+    return f;
+}
+
+bool frustum_intersects_sphere(const Frustum &f, const float center[3], float radius)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        const Plane &p = f.planes[i];
+        if (p.nx * center[0] + p.ny * center[1] + p.nz * center[2] + p.d < -radius)
+            return false;
+    }
+    return true;
+}
+
+bool frustum_intersects_aabb(const Frustum &f, const AABB &box)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        const Plane &p = f.planes[i];
+
+        // Corner furthest along the plane normal
+        float x = p.nx >= 0.0f ? box.max[0] : box.min[0];
+        float y = p.ny >= 0.0f ? box.max[1] : box.min[1];
+        float z = p.nz >= 0.0f ? box.max[2] : box.min[2];
+
+        if (p.nx * x + p.ny * y + p.nz * z + p.d < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+BoundingSphere transform_sphere(const BoundingSphere &s, const mat4 &model)
+{
+    const float *m = model.m;
+    BoundingSphere out;
+    for (int k = 0; k < 3; k++)
+        out.center[k] = m[k] * s.center[0] + m[4 + k] * s.center[1] + m[8 + k] * s.center[2] + m[12 + k];
+
+    // Largest axis scale bounds any rotation/non-uniform scale
+    float sx = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+    float sy = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+    float sz = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+    float s2 = sx > sy ? (sx > sz ? sx : sz) : (sy > sz ? sy : sz);
+
+    out.radius = s.radius * std::sqrt(s2);
+    return out;
+}
+
+// Arvo: each output extent is the sum of the per-axis min/max contributions
+AABB transform_aabb(const AABB &box, const mat4 &model)
+{
+    const float *m = model.m;
+    AABB out;
+    for (int r = 0; r < 3; r++)
+    {
+        out.min[r] = m[12 + r];
+        out.max[r] = m[12 + r];
+        for (int c = 0; c < 3; c++)
+        {
+            float a = m[c * 4 + r] * box.min[c];
+            float b = m[c * 4 + r] * box.max[c];
+            out.min[r] += a < b ? a : b;
+            out.max[r] += a < b ? b : a;
+        }
+    }
+    return out;
+}
+
+int cull_objects(
+    const SceneObject *objects,
+    int count,
+    const Frustum &frustum,
+    int *visible,
+    CullStats *stats)
+{
+    int survivors = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const Mesh *mesh = objects[i].mesh;
+        if (!mesh || mesh->empty())
+            continue;
+
+        BoundingSphere s = transform_sphere(mesh->bounding_sphere(), objects[i].model);
+        if (!frustum_intersects_sphere(frustum, s.center, s.radius))
+            continue;
+
+        if (!frustum_intersects_aabb(frustum, transform_aabb(mesh->aabb(), objects[i].model)))
+            continue;
+
+        visible[survivors++] = i;
+    }
+
+    if (stats)
+    {
+        stats->tested = count;
+        stats->culled = count - survivors;
+        stats->drawn = survivors;
+    }
+    return survivors;
+}
+
+void render_scene(
+    Canvas &canvas,
+    const SceneObject *objects,
+    int count,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height,
+    CullStats *stats)
+{
+    static thread_local std::vector<int> visible;
+
+    Frustum frustum = Frustum::from_matrix(multiply(projection, view));
+
+    visible.resize(count);
+    int n = cull_objects(objects, count, frustum, visible.data(), stats);
+
+    for (int i = 0; i < n; i++)
+    {
+        const SceneObject &obj = objects[visible[i]];
+        renderer_wireframe(
+            canvas, *obj.mesh, obj.model, view, projection,
+            screen_width, screen_height);
+    }
+}
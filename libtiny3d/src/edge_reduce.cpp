@@ -0,0 +1,173 @@
+#include "edge_reduce.h"
+#include <cmath>
+
+// Matches the bounds check the raster stage applies per edge
+static const int DRAW_MARGIN = 100;
+
+// Longest run of joints tested for one merged segment
+static const int MAX_RUN = 32;
+
+static bool in_margin(const ScreenVertex &v, int screen_width, int screen_height)
+{
+    return v.x >= -DRAW_MARGIN && v.x < screen_width + DRAW_MARGIN &&
+           v.y >= -DRAW_MARGIN && v.y < screen_height + DRAW_MARGIN;
+}
+
+static float deviation(const ScreenVertex &p, const ScreenVertex &a, const ScreenVertex &b)
+{
+    float abx = (float)(b.x - a.x);
+    float aby = (float)(b.y - a.y);
+    float apx = (float)(p.x - a.x);
+    float apy = (float)(p.y - a.y);
+
+    float len2 = abx * abx + aby * aby;
+    float t = len2 > 0.0f ? (apx * abx + apy * aby) / len2 : 0.0f;
+    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+
+    float dx = apx - t * abx;
+    float dy = apy - t * aby;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Greedy: extend each segment while every skipped joint stays close to it
+static void emit_path(
+    const std::vector<int> &path,
+    const ScreenVertex *projected,
+    float max_deviation,
+    std::vector<ScreenSegment> &out)
+{
+    size_t n = path.size();
+    size_t start = 0;
+    while (start + 1 < n)
+    {
+        const ScreenVertex &a = projected[path[start]];
+        size_t end = start + 1;
+        while (end + 1 < n && end + 1 - start <= (size_t)MAX_RUN)
+        {
+            const ScreenVertex &b = projected[path[end + 1]];
+            bool fits = true;
+            for (size_t k = start + 1; k <= end && fits; k++)
+                fits = deviation(projected[path[k]], a, b) <= max_deviation;
+            if (!fits)
+                break;
+            end++;
+        }
+
+        const ScreenVertex &b = projected[path[end]];
+        if (a.x != b.x || a.y != b.y)
+            out.push_back({a, b});
+        start = end;
+    }
+}
+
+int reduce_screen_edges(
+    const ScreenVertex *projected,
+    int vertex_count,
+    const int *pairs,
+    int edge_count,
+    int screen_width,
+    int screen_height,
+    float max_deviation,
+    std::vector<ScreenSegment> &out,
+    EdgeReduceStats *stats)
+{
+    static thread_local std::vector<int> kept;
+    static thread_local std::vector<int> offsets;
+    static thread_local std::vector<int> incident;
+    static thread_local std::vector<char> used;
+    static thread_local std::vector<int> path;
+
+    EdgeReduceStats local = {};
+    local.edges_in = edge_count;
+    out.clear();
+
+    // ---- Drop edges that would be skipped or collapse to a dot ----
+    kept.clear();
+    offsets.assign(vertex_count + 1, 0);
+    for (int e = 0; e < edge_count; e++)
+    {
+        const ScreenVertex &a = projected[pairs[e * 2]];
+        const ScreenVertex &b = projected[pairs[e * 2 + 1]];
+
+        if (!in_margin(a, screen_width, screen_height) && !in_margin(b, screen_width, screen_height))
+            local.offscreen++;
+        else if (a.x == b.x && a.y == b.y)
+            local.degenerate++;
+        else
+        {
+            kept.push_back(e);
+            offsets[pairs[e * 2] + 1]++;
+            offsets[pairs[e * 2 + 1] + 1]++;
+        }
+    }
+
+    // ---- Vertex -> kept edge adjacency (CSR) ----
+    int kept_count = (int)kept.size();
+    for (int v = 0; v < vertex_count; v++)
+        offsets[v + 1] += offsets[v];
+
+    incident.resize(kept_count * 2);
+    for (int i = 0; i < kept_count; i++)
+    {
+        int e = kept[i];
+        incident[offsets[pairs[e * 2]]++] = i;
+        incident[offsets[pairs[e * 2 + 1]]++] = i;
+    }
+    for (int v = vertex_count; v > 0; v--)
+        offsets[v] = offsets[v - 1];
+    offsets[0] = 0;
+
+    auto degree = [&](int v) { return offsets[v + 1] - offsets[v]; };
+
+    // ---- Walk chains through degree-2 vertices and merge them ----
+    used.assign(kept_count, 0);
+
+    auto walk = [&](int s, int i) {
+        path.clear();
+        path.push_back(s);
+        int cur = s;
+        while (true)
+        {
+            used[i] = 1;
+            int e = kept[i];
+            cur = pairs[e * 2] == cur ? pairs[e * 2 + 1] : pairs[e * 2];
+            path.push_back(cur);
+            if (cur == s || degree(cur) != 2)
+                break;
+
+            int i0 = incident[offsets[cur]];
+            int i1 = incident[offsets[cur] + 1];
+            i = used[i0] ? i1 : i0;
+            if (used[i])
+                break;
+        }
+    };
+
+    for (int s = 0; s < vertex_count; s++)
+    {
+        if (degree(s) == 2)
+            continue;
+        for (int k = offsets[s]; k < offsets[s + 1]; k++)
+        {
+            if (used[incident[k]])
+                continue;
+            walk(s, incident[k]);
+            emit_path(path, projected, max_deviation, out);
+        }
+    }
+
+    // Closed loops of degree-2 vertices
+    for (int i = 0; i < kept_count; i++)
+    {
+        if (used[i])
+            continue;
+        walk(pairs[kept[i] * 2], i);
+        emit_path(path, projected, max_deviation, out);
+    }
+
+    local.segments_out = (int)out.size();
+    local.merged = kept_count - local.segments_out;
+    if (stats)
+        *stats = local;
+    return local.segments_out;
+}
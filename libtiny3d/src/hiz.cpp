@@ -0,0 +1,215 @@
+#include "hiz.h"
+#include "canvas.h"
+#include <algorithm>
+#include <cmath>
+
+HiZBuffer::HiZBuffer() : screen_w(0), screen_h(0), occluder_depth(0, 0) {}
+
+HiZBuffer::~HiZBuffer() {}
+
+void HiZBuffer::clear()
+{
+    screen_w = 0;
+    screen_h = 0;
+    widths.clear();
+    heights.clear();
+    levels.clear();
+}
+
+void HiZBuffer::build(const DepthBuffer &depth)
+{
+    screen_w = depth.width();
+    screen_h = depth.height();
+    if (screen_w <= 0 || screen_h <= 0)
+    {
+        clear();
+        return;
+    }
+
+    // Level 0 straight from the rasterizer's per-block far depth
+    int bw = (screen_w + 7) >> 3;
+    int bh = (screen_h + 7) >> 3;
+    widths.assign(1, bw);
+    heights.assign(1, bh);
+    levels.resize(1);
+    levels[0].resize((size_t)bw * bh);
+    for (int y = 0; y < bh; y++)
+        for (int x = 0; x < bw; x++)
+            levels[0][y * bw + x] = depth.block_max(x << 3, y << 3);
+
+    build_levels();
+}
+
+void HiZBuffer::build_levels()
+{
+    levels.resize(1);
+    widths.resize(1);
+    heights.resize(1);
+
+    while (widths.back() > 1 || heights.back() > 1)
+    {
+        int cw = widths.back(), ch = heights.back();
+        int w = (cw + 1) >> 1, h = (ch + 1) >> 1;
+        std::vector<float> next((size_t)w * h);
+        const std::vector<float> &child = levels.back();
+
+        for (int y = 0; y < h; y++)
+        {
+            int y0 = y * 2, y1 = std::min(y * 2 + 1, ch - 1);
+            for (int x = 0; x < w; x++)
+            {
+                int x0 = x * 2, x1 = std::min(x * 2 + 1, cw - 1);
+                next[y * w + x] = std::max(
+                    std::max(child[y0 * cw + x0], child[y0 * cw + x1]),
+                    std::max(child[y1 * cw + x0], child[y1 * cw + x1]));
+            }
+        }
+
+        widths.push_back(w);
+        heights.push_back(h);
+        levels.push_back(std::move(next));
+    }
+}
+
+void HiZBuffer::build_from_occluders(
+    const SceneObject *occluders,
+    int count,
+    const mat4 &view,
+    const mat4 &projection,
+    int width,
+    int height)
+{
+    if (width <= 0 || height <= 0)
+    {
+        clear();
+        return;
+    }
+
+    if (occluder_depth.width() != width || occluder_depth.height() != height)
+    {
+        occluder_depth.resize(width, height);
+        occluder_canvas.reset(new Canvas(width, height));
+    }
+    else
+    {
+        occluder_depth.clear();
+    }
+
+    // Depth only matters; flat shading with no lights is the cheapest path
+    SolidOptions options = default_solid_options();
+    options.mode = SHADE_FLAT;
+    options.ambient = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        if (!occluders[i].mesh || occluders[i].mesh->face_count() == 0)
+            continue;
+        render_mesh_solid(*occluder_canvas, occluder_depth, *occluders[i].mesh, occluders[i].model,
+                          view, projection, nullptr, 0, options);
+    }
+
+    build(occluder_depth);
+}
+
+bool HiZBuffer::rect_visible(float x0, float y0, float x1, float y1, float znear) const
+{
+    if (levels.empty())
+        return true;
+
+    // Pixels whose centres the rectangle can cover
+    if (x1 < 0.0f || y1 < 0.0f || x0 > (float)screen_w || y0 > (float)screen_h)
+        return false;
+    int px0 = (int)std::max(0.0f, x0);
+    int py0 = (int)std::max(0.0f, y0);
+    int px1 = (int)std::min((float)(screen_w - 1), x1);
+    int py1 = (int)std::min((float)(screen_h - 1), y1);
+
+    int tx0 = px0 >> 3, ty0 = py0 >> 3;
+    int tx1 = px1 >> 3, ty1 = py1 >> 3;
+    int level = 0;
+    while ((tx1 - tx0 > 1 || ty1 - ty0 > 1) && level + 1 < (int)levels.size())
+    {
+        tx0 >>= 1;
+        ty0 >>= 1;
+        tx1 >>= 1;
+        ty1 >>= 1;
+        level++;
+    }
+
+    for (int y = ty0; y <= ty1; y++)
+        for (int x = tx0; x <= tx1; x++)
+            if (znear < farthest(level, x, y))
+                return true;
+    return false;
+}
+
+bool HiZBuffer::box_visible(const AABB &box, const mat4 &view_projection) const
+{
+    if (levels.empty())
+        return true;
+
+    const float *m = view_projection.m;
+    float x0 = INFINITY, y0 = INFINITY, x1 = -INFINITY, y1 = -INFINITY;
+    float znear = INFINITY;
+
+    for (int c = 0; c < 8; c++)
+    {
+        float p[3] = {
+            (c & 1) ? box.max[0] : box.min[0],
+            (c & 2) ? box.max[1] : box.min[1],
+            (c & 4) ? box.max[2] : box.min[2]};
+        float cx = m[0] * p[0] + m[4] * p[1] + m[8] * p[2] + m[12];
+        float cy = m[1] * p[0] + m[5] * p[1] + m[9] * p[2] + m[13];
+        float cz = m[2] * p[0] + m[6] * p[1] + m[10] * p[2] + m[14];
+        float cw = m[3] * p[0] + m[7] * p[1] + m[11] * p[2] + m[15];
+
+        // A corner in front of the near plane: the projected rectangle is unbounded
+        if (cz + cw < 0.0f || cw <= 0.0f)
+            return true;
+
+        float inv_w = 1.0f / cw;
+        float sx = (cx * inv_w + 1.0f) * 0.5f * screen_w;
+        float sy = (1.0f - cy * inv_w) * 0.5f * screen_h;
+        x0 = std::min(x0, sx);
+        x1 = std::max(x1, sx);
+        y0 = std::min(y0, sy);
+        y1 = std::max(y1, sy);
+        znear = std::min(znear, cz * inv_w * 0.5f + 0.5f);
+    }
+
+    return rect_visible(x0, y0, x1, y1, znear);
+}
+
+int occlusion_cull(
+    const HiZBuffer &hiz,
+    const SceneObject *objects,
+    const int *candidates,
+    int count,
+    const mat4 &view,
+    const mat4 &projection,
+    int *visible,
+    OcclusionStats *stats)
+{
+    mat4 vp = multiply(projection, view);
+    int kept = 0;
+    int occluded = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const SceneObject &obj = objects[candidates[i]];
+        if (obj.mesh && !obj.mesh->empty() &&
+            !hiz.box_visible(transform_aabb(obj.mesh->aabb(), obj.model), vp))
+        {
+            occluded++;
+            continue;
+        }
+        visible[kept++] = candidates[i];
+    }
+
+    if (stats)
+    {
+        stats->tested = count;
+        stats->occluded = occluded;
+        stats->visible = kept;
+    }
+    return kept;
+}
@@ -1,24 +1,95 @@
 #include "lighting.h"
+#include "simd.h"
 #include <cmath>
+#include <algorithm>
 
-float Lambert_edge(
-    const vec3_t &v1,
-    const vec3_t &v2,
-    const Light &light)
+Light::Light()
+    : direction(), intensity(0.0f), type(LIGHT_DIRECTIONAL), position(), range(0.0f), spot_inner(0.0f), spot_outer(0.0f)
 {
-    vec3_t e(
-        v2.x - v1.x,
-        v2.y - v1.y,
-        v2.z - v1.z);
+}
 
-    e.normalize_fast();
+Light::Light(const vec3_t &direction, float intensity)
+    : direction(direction), intensity(intensity), type(LIGHT_DIRECTIONAL), position(), range(0.0f),
+      spot_inner(0.0f), spot_outer(0.0f)
+{
+}
+
+Light Light::point(const vec3_t &position, float intensity, float range)
+{
+    Light l;
+    l.intensity = intensity;
+    l.type = LIGHT_POINT;
+    l.position = position;
+    l.range = range;
+    return l;
+}
+
+Light Light::spot(const vec3_t &position, const vec3_t &direction, float intensity, float range,
+                  float inner, float outer)
+{
+    Light l = point(position, intensity, range);
+    l.type = LIGHT_SPOT;
+    l.direction = direction;
+    l.spot_inner = inner;
+    l.spot_outer = outer;
+    return l;
+}
+
+float light_falloff(const Light &light, const float p[3], float cos_inner, float cos_outer,
+                    const float axis[3], float to_p[3])
+{
+    float d[3] = {p[0] - light.position.x, p[1] - light.position.y, p[2] - light.position.z};
+    float dist2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    float range2 = light.range * light.range;
+    if (!(dist2 < range2) || dist2 <= 0.0f)
+        return 0.0f;
+
+    float inv = 1.0f / std::sqrt(dist2);
+    for (int k = 0; k < 3; k++)
+        to_p[k] = d[k] * inv;
+
+    // Smooth window reaching 0 at range
+    float falloff = 1.0f - dist2 / range2;
+    falloff *= falloff;
+
+    if (light.type == LIGHT_SPOT)
+    {
+        float c = to_p[0] * axis[0] + to_p[1] * axis[1] + to_p[2] * axis[2];
+        if (c <= cos_outer)
+            return 0.0f;
+        if (c < cos_inner)
+        {
+            float t = (c - cos_outer) / (cos_inner - cos_outer);
+            falloff *= t * t * (3.0f - 2.0f * t);
+        }
+    }
+    return falloff;
+}
+
+// Unit edge e, midpoint mid
+static float lambert_term(const vec3_t &e, const float mid[3], const Light &light)
+{
+    float dir[3] = {light.direction.x, light.direction.y, light.direction.z};
+    float falloff = 1.0f;
+
+    if (light.type != LIGHT_DIRECTIONAL)
+    {
+        float len = std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+        float axis[3] = {0.0f, 0.0f, 0.0f};
+        if (len > 0.0f)
+            for (int k = 0; k < 3; k++)
+                axis[k] = dir[k] / len;
+        falloff = light_falloff(light, mid, std::cos(light.spot_inner), std::cos(light.spot_outer), axis, dir);
+        if (falloff <= 0.0f)
+            return 0.0f;
+    }
 
     float dot =
-        e.x * light.direction.x +
-        e.y * light.direction.y +
-        e.z * light.direction.z;
+        e.x * dir[0] +
+        e.y * dir[1] +
+        e.z * dir[2];
 
-    float intensity = std::fabs(dot) * light.intensity;
+    float intensity = std::fabs(dot) * light.intensity * falloff;
 
     if (intensity < 0.0f)
         intensity = 0.0f;
@@ -28,17 +99,42 @@ float Lambert_edge(
     return intensity;
 }
 
+float lambert_edge(
+    const vec3_t &v1,
+    const vec3_t &v2,
+    const Light &light)
+{
+    vec3_t e(
+        v2.x - v1.x,
+        v2.y - v1.y,
+        v2.z - v1.z);
+    float mid[3] = {(v1.x + v2.x) * 0.5f, (v1.y + v2.y) * 0.5f, (v1.z + v2.z) * 0.5f};
+
+    e.normalize_fast();
+
+    return lambert_term(e, mid, light);
+}
+
 float lambert_edge_multi(
     const vec3_t &v1,
     const vec3_t &v2,
     const Light *lights,
     int light_count)
 {
+    // Normalize once, not once per light
+    vec3_t e(
+        v2.x - v1.x,
+        v2.y - v1.y,
+        v2.z - v1.z);
+    float mid[3] = {(v1.x + v2.x) * 0.5f, (v1.y + v2.y) * 0.5f, (v1.z + v2.z) * 0.5f};
+
+    e.normalize_fast();
+
     float total = 0.0f;
 
     for (int i = 0; i < light_count; i++)
     {
-        total += lambert_edge(v1, v2, lights[i]);
+        total += lambert_term(e, mid, lights[i]);
     }
 
     // Clamp final intensity
@@ -46,4 +142,469 @@ float lambert_edge_multi(
         total = 1.0f;
 
     return total;
-}
\ No newline at end of file
+}
+
+// --------------------
+// Batch (SoA) path
+// --------------------
+
+void LightBatch::assign(const Light *lights, int count)
+{
+    dx.clear();
+    dy.clear();
+    dz.clear();
+    intensity.clear();
+    for (int i = 0; i < count; i++)
+    {
+        if (lights[i].type != LIGHT_DIRECTIONAL)
+            continue;
+        dx.push_back(lights[i].direction.x);
+        dy.push_back(lights[i].direction.y);
+        dz.push_back(lights[i].direction.z);
+        intensity.push_back(std::max(0.0f, lights[i].intensity));
+    }
+}
+
+void lambert_edges_batch(
+    const float *x0, const float *y0, const float *z0,
+    const float *x1, const float *y1, const float *z1,
+    int edge_count,
+    const LightBatch &lights,
+    float *out)
+{
+    int light_count = lights.count();
+    int i = 0;
+
+#ifdef TINY3D_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 three_halves = _mm_set1_ps(1.5f);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    for (; i + 4 <= edge_count; i += 4)
+    {
+        __m128 ex = _mm_sub_ps(_mm_loadu_ps(x1 + i), _mm_loadu_ps(x0 + i));
+        __m128 ey = _mm_sub_ps(_mm_loadu_ps(y1 + i), _mm_loadu_ps(y0 + i));
+        __m128 ez = _mm_sub_ps(_mm_loadu_ps(z1 + i), _mm_loadu_ps(z0 + i));
+
+        // 1 / |e| from rsqrt plus one Newton step; zero-length edges get 0
+        __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_mul_ps(ez, ez));
+        __m128 r = _mm_rsqrt_ps(len2);
+        r = _mm_mul_ps(r, _mm_sub_ps(three_halves, _mm_mul_ps(_mm_mul_ps(half, len2), _mm_mul_ps(r, r))));
+        r = _mm_and_ps(r, _mm_cmpgt_ps(len2, zero));
+        ex = _mm_mul_ps(ex, r);
+        ey = _mm_mul_ps(ey, r);
+        ez = _mm_mul_ps(ez, r);
+
+        __m128 total = zero;
+        for (int l = 0; l < light_count; l++)
+        {
+            __m128 d = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(lights.dx[l])), _mm_mul_ps(ey, _mm_set1_ps(lights.dy[l]))),
+                _mm_mul_ps(ez, _mm_set1_ps(lights.dz[l])));
+            d = _mm_mul_ps(_mm_and_ps(d, abs_mask), _mm_set1_ps(lights.intensity[l]));
+            total = _mm_add_ps(total, _mm_min_ps(d, one));
+        }
+        _mm_storeu_ps(out + i, _mm_min_ps(total, one));
+    }
+#endif
+
+    for (; i < edge_count; i++)
+    {
+        float ex = x1[i] - x0[i], ey = y1[i] - y0[i], ez = z1[i] - z0[i];
+        float len2 = ex * ex + ey * ey + ez * ez;
+        float r = len2 > 0.0f ? 1.0f / std::sqrt(len2) : 0.0f;
+        ex *= r;
+        ey *= r;
+        ez *= r;
+
+        float total = 0.0f;
+        for (int l = 0; l < light_count; l++)
+        {
+            float d = std::fabs(ex * lights.dx[l] + ey * lights.dy[l] + ez * lights.dz[l]) * lights.intensity[l];
+            total += std::min(d, 1.0f);
+        }
+        out[i] = std::min(total, 1.0f);
+    }
+}
+
+static const int GATHER_BLOCK = 256;
+
+// Endpoints of edges [first, first + n) into six SoA rows
+static void gather_edges(const float *xyz, const uint32_t *edges, int first, int n, float soa[6][GATHER_BLOCK])
+{
+    for (int k = 0; k < n; k++)
+    {
+        const float *a = xyz + edges[(first + k) * 2] * 3;
+        const float *b = xyz + edges[(first + k) * 2 + 1] * 3;
+        soa[0][k] = a[0];
+        soa[1][k] = a[1];
+        soa[2][k] = a[2];
+        soa[3][k] = b[0];
+        soa[4][k] = b[1];
+        soa[5][k] = b[2];
+    }
+}
+
+void lambert_edges_indexed(
+    const float *xyz,
+    const uint32_t *edges,
+    int edge_count,
+    const LightBatch &lights,
+    float *out)
+{
+    float soa[6][GATHER_BLOCK];
+
+    for (int first = 0; first < edge_count; first += GATHER_BLOCK)
+    {
+        int n = std::min(GATHER_BLOCK, edge_count - first);
+        gather_edges(xyz, edges, first, n, soa);
+        lambert_edges_batch(soa[0], soa[1], soa[2], soa[3], soa[4], soa[5], n, lights, out + first);
+    }
+}
+
+// --------------------
+// Spherical harmonics
+// --------------------
+
+static const float SH_PI = 3.14159265f;
+
+// Real SH basis constants, bands 0-2
+static const float SH_C0 = 0.282095f;
+static const float SH_C1 = 0.488603f;
+static const float SH_C2 = 1.092548f;
+static const float SH_C20 = 0.315392f;
+static const float SH_C22 = 0.546274f;
+
+static void sh_basis(float x, float y, float z, float b[9])
+{
+    b[0] = SH_C0;
+    b[1] = SH_C1 * y;
+    b[2] = SH_C1 * z;
+    b[3] = SH_C1 * x;
+    b[4] = SH_C2 * x * y;
+    b[5] = SH_C2 * y * z;
+    b[6] = SH_C20 * (3.0f * z * z - 1.0f);
+    b[7] = SH_C2 * x * z;
+    b[8] = SH_C22 * (x * x - y * y);
+}
+
+void LightSH::project(const Light *lights, int count)
+{
+    // |cos| = 0.5 P0 + 0.625 P2 + ...; by the addition theorem band l
+    // scales Y_lm(d) by 4 pi / (2l + 1) times the Legendre coefficient
+    const float band0 = 4.0f * SH_PI * 0.5f;
+    const float band2 = 0.8f * SH_PI * 0.625f;
+
+    std::fill(coeffs, coeffs + 9, 0.0f);
+    for (int i = 0; i < count; i++)
+    {
+        const Light &l = lights[i];
+        if (l.type != LIGHT_DIRECTIONAL || !(l.intensity > 0.0f))
+            continue;
+
+        // lambert_edge does not normalize the direction: its length scales the light
+        float len = std::sqrt(l.direction.x * l.direction.x + l.direction.y * l.direction.y + l.direction.z * l.direction.z);
+        if (!(len > 0.0f))
+            continue;
+        float weight = l.intensity * len;
+
+        float b[9];
+        sh_basis(l.direction.x / len, l.direction.y / len, l.direction.z / len, b);
+        coeffs[0] += weight * band0 * b[0];
+        for (int k = 4; k < 9; k++)
+            coeffs[k] += weight * band2 * b[k];
+    }
+}
+
+float lambert_edge_sh(
+    const vec3_t &v1,
+    const vec3_t &v2,
+    const LightSH &sh)
+{
+    float x = v2.x - v1.x, y = v2.y - v1.y, z = v2.z - v1.z;
+    float len2 = x * x + y * y + z * z;
+    if (!(len2 > 0.0f))
+        return 0.0f;
+    float r = 1.0f / std::sqrt(len2);
+
+    float b[9];
+    sh_basis(x * r, y * r, z * r, b);
+    float total = 0.0f;
+    for (int k = 0; k < 9; k++)
+        total += sh.coeffs[k] * b[k];
+    return std::max(0.0f, std::min(total, 1.0f));
+}
+
+void lambert_edges_sh(
+    const float *x0, const float *y0, const float *z0,
+    const float *x1, const float *y1, const float *z1,
+    int edge_count,
+    const LightSH &sh,
+    float *out)
+{
+    // Coefficients with the basis constants folded in
+    const float *c = sh.coeffs;
+    const float k0 = c[0] * SH_C0 - c[6] * SH_C20;
+    const float kx = c[3] * SH_C1, ky = c[1] * SH_C1, kz = c[2] * SH_C1;
+    const float kxy = c[4] * SH_C2, kyz = c[5] * SH_C2, kxz = c[7] * SH_C2;
+    const float kzz = c[6] * SH_C20 * 3.0f;
+    const float kxx = c[8] * SH_C22, kyy = -c[8] * SH_C22;
+    int i = 0;
+
+#ifdef TINY3D_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 three_halves = _mm_set1_ps(1.5f);
+
+    for (; i + 4 <= edge_count; i += 4)
+    {
+        __m128 ex = _mm_sub_ps(_mm_loadu_ps(x1 + i), _mm_loadu_ps(x0 + i));
+        __m128 ey = _mm_sub_ps(_mm_loadu_ps(y1 + i), _mm_loadu_ps(y0 + i));
+        __m128 ez = _mm_sub_ps(_mm_loadu_ps(z1 + i), _mm_loadu_ps(z0 + i));
+
+        __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_mul_ps(ez, ez));
+        __m128 live = _mm_cmpgt_ps(len2, zero);
+        __m128 r = _mm_rsqrt_ps(len2);
+        r = _mm_mul_ps(r, _mm_sub_ps(three_halves, _mm_mul_ps(_mm_mul_ps(half, len2), _mm_mul_ps(r, r))));
+        r = _mm_and_ps(r, live);
+        ex = _mm_mul_ps(ex, r);
+        ey = _mm_mul_ps(ey, r);
+        ez = _mm_mul_ps(ez, r);
+
+        __m128 linear = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(kx)), _mm_mul_ps(ey, _mm_set1_ps(ky))),
+                                   _mm_mul_ps(ez, _mm_set1_ps(kz)));
+        __m128 cross = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(ex, ey), _mm_set1_ps(kxy)),
+                                             _mm_mul_ps(_mm_mul_ps(ey, ez), _mm_set1_ps(kyz))),
+                                  _mm_mul_ps(_mm_mul_ps(ex, ez), _mm_set1_ps(kxz)));
+        __m128 square = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(ex, ex), _mm_set1_ps(kxx)),
+                                              _mm_mul_ps(_mm_mul_ps(ey, ey), _mm_set1_ps(kyy))),
+                                   _mm_mul_ps(_mm_mul_ps(ez, ez), _mm_set1_ps(kzz)));
+        __m128 total = _mm_add_ps(_mm_add_ps(_mm_set1_ps(k0), linear), _mm_add_ps(cross, square));
+        total = _mm_and_ps(_mm_max_ps(zero, _mm_min_ps(total, one)), live);
+        _mm_storeu_ps(out + i, total);
+    }
+#endif
+
+    for (; i < edge_count; i++)
+    {
+        float ex = x1[i] - x0[i], ey = y1[i] - y0[i], ez = z1[i] - z0[i];
+        float len2 = ex * ex + ey * ey + ez * ez;
+        if (!(len2 > 0.0f))
+        {
+            out[i] = 0.0f;
+            continue;
+        }
+        float r = 1.0f / std::sqrt(len2);
+        ex *= r;
+        ey *= r;
+        ez *= r;
+
+        float total = k0 + kx * ex + ky * ey + kz * ez +
+                      kxy * ex * ey + kyz * ey * ez + kxz * ex * ez +
+                      kxx * ex * ex + kyy * ey * ey + kzz * ez * ez;
+        out[i] = std::max(0.0f, std::min(total, 1.0f));
+    }
+}
+
+void lambert_edges_sh_indexed(
+    const float *xyz,
+    const uint32_t *edges,
+    int edge_count,
+    const LightSH &sh,
+    float *out)
+{
+    float soa[6][GATHER_BLOCK];
+
+    for (int first = 0; first < edge_count; first += GATHER_BLOCK)
+    {
+        int n = std::min(GATHER_BLOCK, edge_count - first);
+        gather_edges(xyz, edges, first, n, soa);
+        lambert_edges_sh(soa[0], soa[1], soa[2], soa[3], soa[4], soa[5], n, sh, out + first);
+    }
+}
+
+// --------------------
+// Light grid
+// --------------------
+
+static const int MAX_GRID_CELLS = 1 << 18;
+
+LightGrid::LightGrid() : origin{0.0f, 0.0f, 0.0f}, cell(1.0f), dims{0, 0, 0} {}
+
+void LightGrid::build(const Light *lights, int count, float cell_size)
+{
+    local.clear();
+    spot_cos.clear();
+    cell_offsets.clear();
+    cell_lights.clear();
+    dims[0] = dims[1] = dims[2] = 0;
+    directional.assign(lights, count);
+
+    float lo[3] = {INFINITY, INFINITY, INFINITY};
+    float hi[3] = {-INFINITY, -INFINITY, -INFINITY};
+    float range_sum = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        const Light &l = lights[i];
+        if (l.type == LIGHT_DIRECTIONAL || !(l.range > 0.0f) || !(l.intensity > 0.0f))
+            continue;
+
+        Light copy = l;
+        float len = std::sqrt(l.direction.x * l.direction.x + l.direction.y * l.direction.y + l.direction.z * l.direction.z);
+        if (len > 0.0f)
+            copy.direction = vec3_t(l.direction.x / len, l.direction.y / len, l.direction.z / len);
+        local.push_back(copy);
+        spot_cos.push_back(std::cos(l.spot_inner));
+        spot_cos.push_back(std::cos(l.spot_outer));
+
+        float p[3] = {l.position.x, l.position.y, l.position.z};
+        for (int k = 0; k < 3; k++)
+        {
+            lo[k] = std::min(lo[k], p[k] - l.range);
+            hi[k] = std::max(hi[k], p[k] + l.range);
+        }
+        range_sum += l.range;
+    }
+    if (local.empty())
+        return;
+
+    cell = cell_size > 0.0f ? cell_size : range_sum / local.size();
+    for (;;)
+    {
+        long long total = 1;
+        for (int k = 0; k < 3; k++)
+        {
+            dims[k] = std::max(1, (int)std::ceil((hi[k] - lo[k]) / cell));
+            total *= dims[k];
+        }
+        if (total <= MAX_GRID_CELLS)
+            break;
+        cell *= 1.25f;
+    }
+    for (int k = 0; k < 3; k++)
+        origin[k] = lo[k];
+
+    // Two passes over each light's cell box: count, then fill (CSR)
+    int cells = cell_count();
+    cell_offsets.assign(cells + 1, 0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        std::vector<int> cursor;
+        if (pass == 1)
+        {
+            for (int c = 0; c < cells; c++)
+                cell_offsets[c + 1] += cell_offsets[c];
+            cell_lights.resize(cell_offsets[cells]);
+            cursor.assign(cell_offsets.begin(), cell_offsets.end() - 1);
+        }
+
+        for (int i = 0; i < (int)local.size(); i++)
+        {
+            const Light &l = local[i];
+            float p[3] = {l.position.x, l.position.y, l.position.z};
+            int c0[3], c1[3];
+            for (int k = 0; k < 3; k++)
+            {
+                c0[k] = std::max(0, std::min(dims[k] - 1, (int)((p[k] - l.range - origin[k]) / cell)));
+                c1[k] = std::max(0, std::min(dims[k] - 1, (int)((p[k] + l.range - origin[k]) / cell)));
+            }
+            for (int z = c0[2]; z <= c1[2]; z++)
+                for (int y = c0[1]; y <= c1[1]; y++)
+                    for (int x = c0[0]; x <= c1[0]; x++)
+                    {
+                        int c = (z * dims[1] + y) * dims[0] + x;
+                        if (pass == 0)
+                            cell_offsets[c + 1]++;
+                        else
+                            cell_lights[cursor[c]++] = i;
+                    }
+        }
+    }
+}
+
+int LightGrid::cell_index(const float p[3]) const
+{
+    if (local.empty())
+        return -1;
+
+    int c[3];
+    for (int k = 0; k < 3; k++)
+    {
+        float f = (p[k] - origin[k]) / cell;
+        if (!(f >= 0.0f) || f >= (float)dims[k])
+            return -1;
+        c[k] = (int)f;
+    }
+    return (c[2] * dims[1] + c[1]) * dims[0] + c[0];
+}
+
+int LightGrid::lights_at(const float p[3], const int *&indices) const
+{
+    int c = cell_index(p);
+    if (c < 0)
+    {
+        indices = nullptr;
+        return 0;
+    }
+    indices = cell_lights.data() + cell_offsets[c];
+    return cell_offsets[c + 1] - cell_offsets[c];
+}
+
+void LightGrid::shade_edges(
+    const float *xyz,
+    const uint32_t *edges,
+    int edge_count,
+    float *out,
+    LightGridStats *stats) const
+{
+    if (directional.count() > 0)
+        lambert_edges_indexed(xyz, edges, edge_count, directional, out);
+    else
+        std::fill(out, out + edge_count, 0.0f);
+
+    long long tests = 0;
+    if (!local.empty())
+    {
+        for (int e = 0; e < edge_count; e++)
+        {
+            const float *a = xyz + edges[e * 2] * 3;
+            const float *b = xyz + edges[e * 2 + 1] * 3;
+            float mid[3] = {(a[0] + b[0]) * 0.5f, (a[1] + b[1]) * 0.5f, (a[2] + b[2]) * 0.5f};
+
+            const int *ids;
+            int n = lights_at(mid, ids);
+            if (n == 0)
+                continue;
+            tests += n;
+
+            float d[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            float len2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+            if (!(len2 > 0.0f))
+                continue;
+            float inv = 1.0f / std::sqrt(len2);
+
+            float total = out[e];
+            for (int k = 0; k < n && total < 1.0f; k++)
+            {
+                const Light &l = local[ids[k]];
+                float axis[3] = {l.direction.x, l.direction.y, l.direction.z};
+                float to_p[3];
+                float falloff = light_falloff(l, mid, spot_cos[ids[k] * 2], spot_cos[ids[k] * 2 + 1], axis, to_p);
+                if (falloff <= 0.0f)
+                    continue;
+                float dot = (d[0] * to_p[0] + d[1] * to_p[1] + d[2] * to_p[2]) * inv;
+                total += std::min(1.0f, std::fabs(dot) * l.intensity * falloff);
+            }
+            out[e] = std::min(total, 1.0f);
+        }
+    }
+
+    if (stats)
+    {
+        stats->edges = edge_count;
+        stats->light_tests = tests;
+    }
+}
@@ -0,0 +1,377 @@
+#include "lod.h"
+#include "canvas.h"
+#include "culling.h"
+#include "renderer.h"
+#include <algorithm>
+#include <cmath>
+
+static float distance3(const float *a, const float *b)
+{
+    float dx = a[0] - b[0];
+    float dy = a[1] - b[1];
+    float dz = a[2] - b[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static float point_segment_distance(const float *p, const float *a, const float *b)
+{
+    float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float ap[3] = {p[0] - a[0], p[1] - a[1], p[2] - a[2]};
+    float len2 = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+    float t = len2 > 0.0f ? (ap[0] * ab[0] + ap[1] * ab[1] + ap[2] * ab[2]) / len2 : 0.0f;
+    t = std::min(1.0f, std::max(0.0f, t));
+
+    float q[3] = {a[0] + t * ab[0], a[1] + t * ab[1], a[2] + t * ab[2]};
+    return distance3(p, q);
+}
+
+static int find_root(std::vector<int> &parent, int v)
+{
+    while (parent[v] != v)
+    {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+// Greedy straightening of path[0..n): each emitted edge skips every vertex
+// that stays within max_error of it
+static void straighten_path(
+    const std::vector<int> &path,
+    const float *xyz,
+    float max_error,
+    EdgeSet &out)
+{
+    bool inserted;
+    size_t start = 0;
+    while (start + 1 < path.size())
+    {
+        size_t end = start + 1;
+        while (end + 1 < path.size())
+        {
+            size_t next = end + 1;
+            bool fits = true;
+            for (size_t k = start + 1; k < next && fits; k++)
+                fits = point_segment_distance(&xyz[path[k] * 3], &xyz[path[start] * 3], &xyz[path[next] * 3]) <= max_error;
+            if (!fits)
+                break;
+            end = next;
+        }
+        if (path[start] != path[end])
+            out.insert(path[start], path[end], inserted);
+        start = end;
+    }
+}
+
+bool simplify_wireframe(const Mesh &src, float max_error, Mesh &out)
+{
+    out.clear();
+    int n = src.vertex_count();
+    int edge_count = src.edge_count();
+    if (n == 0)
+        return false;
+
+    const float *xyz = src.position_data();
+    const int(*edges)[2] = src.edge_data();
+
+    // ---- Short-edge collapse (union-find, shortest first) ----
+    std::vector<int> parent(n);
+    std::vector<int> members(n, 1);
+    std::vector<float> sum(xyz, xyz + n * 3);
+    std::vector<float> drift(n, 0.0f); // bound on member distance from the cluster centroid
+    for (int v = 0; v < n; v++)
+        parent[v] = v;
+
+    std::vector<std::pair<float, int>> by_length;
+    by_length.reserve(edge_count);
+    for (int e = 0; e < edge_count; e++)
+    {
+        float len = distance3(&xyz[edges[e][0] * 3], &xyz[edges[e][1] * 3]);
+        if (len < max_error)
+            by_length.push_back({len, e});
+    }
+    std::sort(by_length.begin(), by_length.end());
+
+    for (const auto &item : by_length)
+    {
+        int ra = find_root(parent, edges[item.second][0]);
+        int rb = find_root(parent, edges[item.second][1]);
+        if (ra == rb)
+            continue;
+
+        float ca[3], cb[3], c[3];
+        int total = members[ra] + members[rb];
+        for (int k = 0; k < 3; k++)
+        {
+            ca[k] = sum[ra * 3 + k] / members[ra];
+            cb[k] = sum[rb * 3 + k] / members[rb];
+            c[k] = (sum[ra * 3 + k] + sum[rb * 3 + k]) / total;
+        }
+
+        float merged = std::max(drift[ra] + distance3(ca, c), drift[rb] + distance3(cb, c));
+        if (merged > max_error)
+            continue;
+
+        parent[rb] = ra;
+        members[ra] = total;
+        drift[ra] = merged;
+        for (int k = 0; k < 3; k++)
+            sum[ra * 3 + k] += sum[rb * 3 + k];
+    }
+
+    std::vector<int> cluster(n, -1);
+    std::vector<float> cxyz;
+    for (int v = 0; v < n; v++)
+    {
+        int r = find_root(parent, v);
+        if (cluster[r] < 0)
+        {
+            cluster[r] = (int)cxyz.size() / 3;
+            for (int k = 0; k < 3; k++)
+                cxyz.push_back(sum[r * 3 + k] / members[r]);
+        }
+        cluster[v] = cluster[r];
+    }
+    int m = (int)cxyz.size() / 3;
+
+    EdgeSet collapsed(edge_count);
+    bool inserted;
+    for (int e = 0; e < edge_count; e++)
+    {
+        int a = cluster[edges[e][0]];
+        int b = cluster[edges[e][1]];
+        if (a != b)
+            collapsed.insert(a, b, inserted);
+    }
+
+    // ---- Chain straightening ----
+    const std::vector<int> &pairs = collapsed.edge_pairs();
+    int cedges = collapsed.size();
+
+    std::vector<int> offsets(m + 1, 0);
+    for (int e = 0; e < cedges * 2; e++)
+        offsets[pairs[e] + 1]++;
+    for (int v = 0; v < m; v++)
+        offsets[v + 1] += offsets[v];
+    std::vector<int> incident(cedges * 2);
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (int e = 0; e < cedges; e++)
+    {
+        incident[fill[pairs[e * 2]]++] = e;
+        incident[fill[pairs[e * 2 + 1]]++] = e;
+    }
+
+    std::vector<char> used(cedges, 0);
+    EdgeSet result(cedges);
+    std::vector<int> path;
+
+    // Walks from s along e while the current vertex has degree 2
+    auto walk = [&](int s, int e) {
+        path.clear();
+        path.push_back(s);
+        int cur = s;
+        while (true)
+        {
+            used[e] = 1;
+            cur = pairs[e * 2] == cur ? pairs[e * 2 + 1] : pairs[e * 2];
+            path.push_back(cur);
+            if (cur == s || offsets[cur + 1] - offsets[cur] != 2)
+                break;
+
+            int e0 = incident[offsets[cur]];
+            int e1 = incident[offsets[cur] + 1];
+            e = used[e0] ? e1 : e0;
+            if (used[e])
+                break;
+        }
+    };
+
+    // Open chains between anchors (degree != 2)
+    for (int s = 0; s < m; s++)
+    {
+        if (offsets[s + 1] - offsets[s] == 2)
+            continue;
+        for (int i = offsets[s]; i < offsets[s + 1]; i++)
+        {
+            if (used[incident[i]])
+                continue;
+            walk(s, incident[i]);
+            straighten_path(path, cxyz.data(), max_error, result);
+        }
+    }
+
+    // Whatever is left forms closed loops; never reduce one below a triangle
+    for (int e = 0; e < cedges; e++)
+    {
+        if (used[e])
+            continue;
+        walk(pairs[e * 2], e);
+
+        EdgeSet loop(8);
+        straighten_path(path, cxyz.data(), max_error, loop);
+        if (loop.size() < 3)
+        {
+            for (size_t k = 0; k + 1 < path.size(); k++)
+                result.insert(path[k], path[k + 1], inserted);
+        }
+        else
+        {
+            const std::vector<int> &lp = loop.edge_pairs();
+            for (int k = 0; k < loop.size(); k++)
+                result.insert(lp[k * 2], lp[k * 2 + 1], inserted);
+        }
+    }
+
+    // ---- Compact to vertices still referenced ----
+    std::vector<int> &rp = result.edge_pairs();
+    std::vector<int> remap(m, -1);
+    std::vector<float> out_xyz;
+    for (int &v : rp)
+    {
+        if (remap[v] < 0)
+        {
+            remap[v] = (int)out_xyz.size() / 3;
+            out_xyz.insert(out_xyz.end(), &cxyz[v * 3], &cxyz[v * 3] + 3);
+        }
+        v = remap[v];
+    }
+
+    return out.build(
+        out_xyz.data(), (int)out_xyz.size() / 3,
+        reinterpret_cast<const int(*)[2]>(rp.data()), result.size());
+}
+
+// --------------------
+// LodMesh
+// --------------------
+
+LodMesh::LodMesh() : base_radius(0.0f) {}
+
+void LodMesh::clear()
+{
+    levels.clear();
+    errors.clear();
+    base_radius = 0.0f;
+}
+
+void LodMesh::generate(const Mesh &base, int max_levels, float finest_error)
+{
+    clear();
+    add_level(base, 0.0f);
+
+    float radius = base_radius;
+    float error = finest_error > 0.0f ? finest_error : radius / 128.0f;
+
+    for (; error < radius && level_count() < max_levels; error *= 2.0f)
+    {
+        Mesh coarse;
+        if (!simplify_wireframe(base, error, coarse))
+            break;
+
+        if (coarse.edge_count() > levels.back().edge_count() * 0.9f)
+            continue;
+
+        add_level(coarse, error);
+    }
+}
+
+void LodMesh::add_level(const Mesh &mesh, float error)
+{
+    if (levels.empty())
+        base_radius = mesh.bounding_sphere().radius;
+    levels.push_back(mesh);
+    errors.push_back(error);
+}
+
+int LodMesh::select(float radius_px, int current, float pixel_error, float hysteresis) const
+{
+    int count = level_count();
+    if (count == 0)
+        return -1;
+    if (base_radius <= 0.0f)
+        return 0;
+
+    // World error to pixels at the object's current screen size
+    float scale = radius_px / base_radius;
+
+    auto coarsest_within = [&](float tolerance) {
+        int k = 0;
+        while (k + 1 < count && errors[k + 1] * scale <= tolerance)
+            k++;
+        return k;
+    };
+
+    if (current < 0 || current >= count)
+        return coarsest_within(pixel_error);
+
+    // Coarsen only once comfortably under the tolerance...
+    int coarser = coarsest_within(pixel_error * (1.0f - hysteresis));
+    if (coarser > current)
+        return coarser;
+
+    // ...and refine only once clearly over it
+    if (errors[current] * scale > pixel_error * (1.0f + hysteresis))
+        return coarsest_within(pixel_error);
+
+    return current;
+}
+
+float projected_radius(
+    const BoundingSphere &world_sphere,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_height)
+{
+    const float *c = world_sphere.center;
+    const float *v = view.m;
+    float depth = -(v[2] * c[0] + v[6] * c[1] + v[10] * c[2] + v[14]);
+
+    if (depth <= world_sphere.radius)
+        return 1e30f;
+
+    // projection.m[5] is the vertical focal scale (2n / (top - bottom))
+    return world_sphere.radius * projection.m[5] * 0.5f * screen_height / depth;
+}
+
+void render_lod_scene(
+    Canvas &canvas,
+    LodObject *objects,
+    int count,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height,
+    float pixel_error,
+    LodRenderStats *stats)
+{
+    LodRenderStats local = {};
+    Frustum frustum = Frustum::from_matrix(multiply(projection, view));
+
+    for (int i = 0; i < count; i++)
+    {
+        LodObject &obj = objects[i];
+        if (!obj.lod || obj.lod->level_count() == 0)
+            continue;
+
+        BoundingSphere s = transform_sphere(obj.lod->level(0).bounding_sphere(), obj.model);
+        if (!frustum_intersects_sphere(frustum, s.center, s.radius))
+        {
+            local.objects_culled++;
+            continue;
+        }
+
+        float radius_px = projected_radius(s, view, projection, screen_height);
+        obj.level = obj.lod->select(radius_px, obj.level, pixel_error);
+
+        const Mesh &mesh = obj.lod->level(obj.level);
+        renderer_wireframe(canvas, mesh, obj.model, view, projection, screen_width, screen_height);
+
+        local.objects_drawn++;
+        local.level_histogram[std::min(obj.level, 7)]++;
+        local.edges_drawn += mesh.edge_count();
+    }
+
+    if (stats)
+        *stats = local;
+}
@@ -0,0 +1,167 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : base(nullptr), length(0)
+{
+#ifdef _WIN32
+    file_handle = nullptr;
+    mapping_handle = nullptr;
+#else
+    fd = -1;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char *path)
+{
+    close();
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    file_handle = file;
+    mapping_handle = mapping;
+    base = static_cast<const unsigned char *>(view);
+    length = (size_t)file_size.QuadPart;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (base)
+        UnmapViewOfFile(base);
+    if (mapping_handle)
+        CloseHandle((HANDLE)mapping_handle);
+    if (file_handle)
+        CloseHandle((HANDLE)file_handle);
+
+    base = nullptr;
+    length = 0;
+    file_handle = nullptr;
+    mapping_handle = nullptr;
+}
+
+void MappedFile::advise_sequential() const
+{
+    // FILE_FLAG_SEQUENTIAL_SCAN is set at open time
+}
+
+void MappedFile::prefetch(size_t, size_t) const
+{
+}
+
+void MappedFile::release(size_t offset, size_t bytes) const
+{
+    // Drops the pages from this process's working set; they stay in the file cache
+    if (base && offset < length)
+        VirtualUnlock((LPVOID)(base + offset), bytes < length - offset ? bytes : length - offset);
+}
+
+#else
+
+bool MappedFile::open(const char *path)
+{
+    close();
+
+    int file = ::open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(file, &st) != 0 || st.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    void *view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (view == MAP_FAILED)
+    {
+        ::close(file);
+        return false;
+    }
+
+    fd = file;
+    base = static_cast<const unsigned char *>(view);
+    length = (size_t)st.st_size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (base)
+        munmap((void *)base, length);
+    if (fd >= 0)
+        ::close(fd);
+
+    base = nullptr;
+    length = 0;
+    fd = -1;
+}
+
+// madvise wants page-aligned ranges
+static void advise_range(const unsigned char *base, size_t length, size_t offset, size_t bytes, int advice)
+{
+    if (!base || offset >= length)
+        return;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = offset & ~(page - 1);
+    size_t end = offset + bytes < length ? offset + bytes : length;
+    madvise((void *)(base + begin), end - begin, advice);
+}
+
+void MappedFile::advise_sequential() const
+{
+    advise_range(base, length, 0, length, MADV_SEQUENTIAL);
+}
+
+void MappedFile::prefetch(size_t offset, size_t bytes) const
+{
+    advise_range(base, length, offset, bytes, MADV_WILLNEED);
+}
+
+void MappedFile::release(size_t offset, size_t bytes) const
+{
+    advise_range(base, length, offset, bytes, MADV_DONTNEED);
+}
+
+#endif
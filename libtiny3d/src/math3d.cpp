@@ -1,4 +1,5 @@
 ﻿#include "math3d.h"
+#include "simd.h"
 #include <cmath>
 
 static float fast_sqrt(float x)
@@ -46,7 +47,7 @@ void vec3_t::normalize_fast()
     float len2 = x * x + y * y + z * z;
     if (len2 > 0.0f)
     {
-        float invLen = fast_sqrt(len2);
+        float invLen = 1.0f / fast_sqrt(len2);
         x *= invLen;
         y *= invLen;
         z *= invLen;
@@ -167,6 +168,21 @@ mat4 multiply(const mat4 &a, const mat4 &b)
 {
     mat4 r{};
 
+#ifdef TINY3D_SSE2
+    // Column j of the result is a's columns weighted by b's column j,
+    // summed in the same order as the scalar loop
+    __m128 a0 = _mm_loadu_ps(a.m), a1 = _mm_loadu_ps(a.m + 4);
+    __m128 a2 = _mm_loadu_ps(a.m + 8), a3 = _mm_loadu_ps(a.m + 12);
+    for (int col = 0; col < 4; col++)
+    {
+        const float *bc = b.m + col * 4;
+        __m128 c = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+        c = _mm_add_ps(c, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+        c = _mm_add_ps(c, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+        c = _mm_add_ps(c, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+        _mm_storeu_ps(r.m + col * 4, c);
+    }
+#else
     for (int col = 0; col < 4; col++)
     {
         for (int row = 0; row < 4; row++)
@@ -178,6 +194,7 @@ mat4 multiply(const mat4 &a, const mat4 &b)
                 a.m[3 * 4 + row] * b.m[col * 4 + 3];
         }
     }
+#endif
 
     return r;
 }
@@ -222,3 +239,207 @@ vec3_t multiply(const mat4 &m, const vec3_t &v)
 
     return r;
 }
+
+bool invert(const mat4 &m, mat4 &out)
+{
+    const float *a = m.m;
+    float inv[16];
+
+    // Cofactor expansion; the layout (row/column major) does not matter
+    inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+    inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+    inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+    inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+    inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+    inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+    inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+    inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+    inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+    inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+    inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+    inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+    inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+    inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+    inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] - a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+    inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] + a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+    float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+    if (std::fabs(det) < 1e-12f)
+        return false;
+
+    float inv_det = 1.0f / det;
+    for (int i = 0; i < 16; i++)
+        out.m[i] = inv[i] * inv_det;
+    return true;
+}
+
+// --------------------
+// Quaternions
+// --------------------
+
+quat quat::identity()
+{
+    return {0.0f, 0.0f, 0.0f, 1.0f};
+}
+
+quat quat::axis_angle(const vec3_t &axis, float angle)
+{
+    float len2 = axis.x * axis.x + axis.y * axis.y + axis.z * axis.z;
+    if (!(len2 > 0.0f))
+        return identity();
+    float s = sinf(angle * 0.5f) / sqrtf(len2);
+    return {axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f)};
+}
+
+mat4 quat::to_matrix() const
+{
+    float xx = x * x, yy = y * y, zz = z * z;
+    float xy = x * y, xz = x * z, yz = y * z;
+    float wx = w * x, wy = w * y, wz = w * z;
+
+    mat4 m = {};
+    m.m[0] = 1.0f - 2.0f * (yy + zz);
+    m.m[1] = 2.0f * (xy + wz);
+    m.m[2] = 2.0f * (xz - wy);
+    m.m[4] = 2.0f * (xy - wz);
+    m.m[5] = 1.0f - 2.0f * (xx + zz);
+    m.m[6] = 2.0f * (yz + wx);
+    m.m[8] = 2.0f * (xz + wy);
+    m.m[9] = 2.0f * (yz - wx);
+    m.m[10] = 1.0f - 2.0f * (xx + yy);
+    m.m[15] = 1.0f;
+    return m;
+}
+
+quat multiply(const quat &a, const quat &b)
+{
+    return {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+
+quat normalize(const quat &q)
+{
+    float len2 = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+    if (!(len2 > 0.0f))
+        return quat::identity();
+    float inv = 1.0f / sqrtf(len2);
+    return {q.x * inv, q.y * inv, q.z * inv, q.w * inv};
+}
+
+// Normalized wa * a + wb * b
+static quat blend(const quat &a, const quat &b, float wa, float wb)
+{
+    return normalize({wa * a.x + wb * b.x, wa * a.y + wb * b.y, wa * a.z + wb * b.z, wa * a.w + wb * b.w});
+}
+
+static float dot(const quat &a, const quat &b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+quat nlerp(const quat &a, const quat &b, float t)
+{
+    float d = dot(a, b);
+    return blend(a, b, 1.0f - t, d < 0.0f ? -t : t);
+}
+
+quat slerp(const quat &a, const quat &b, float t)
+{
+    float d = dot(a, b);
+    float sign = d < 0.0f ? -1.0f : 1.0f;
+    d = fabsf(d);
+
+    // Nearly parallel: nlerp is exact to float precision
+    if (d > 0.9995f)
+        return blend(a, b, 1.0f - t, sign * t);
+
+    float theta = acosf(d);
+    float inv_sin = 1.0f / sinf(theta);
+    return blend(a, b, sinf((1.0f - t) * theta) * inv_sin, sign * sinf(t * theta) * inv_sin);
+}
+
+// Remapped t for slerp_fast: t + t (t - 0.5) (t - 1) k, with k a fit in
+// |a . b| and (t - 0.5)^2 (after Kapoulkine, "Approximating slerp")
+static float slerp_fast_t(float d, float t)
+{
+    float A = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+    float B = 0.848013f + d * (-1.06021f + d * 0.215638f);
+    float k = A * (t - 0.5f) * (t - 0.5f) + B;
+    return t + t * (t - 0.5f) * (t - 1.0f) * k;
+}
+
+quat slerp_fast(const quat &a, const quat &b, float t)
+{
+    float d = dot(a, b);
+    float u = slerp_fast_t(fabsf(d), t);
+    return blend(a, b, 1.0f - u, d < 0.0f ? -u : u);
+}
+
+void slerp_batch(const quat *a, const quat *b, const float *t, int count, quat *out)
+{
+    int i = 0;
+
+#ifdef TINY3D_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 three_halves = _mm_set1_ps(1.5f);
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        // quat is four packed floats: transpose to x, y, z, w rows
+        __m128 ax = _mm_loadu_ps(&a[i].x), ay = _mm_loadu_ps(&a[i + 1].x);
+        __m128 az = _mm_loadu_ps(&a[i + 2].x), aw = _mm_loadu_ps(&a[i + 3].x);
+        _MM_TRANSPOSE4_PS(ax, ay, az, aw);
+        __m128 bx = _mm_loadu_ps(&b[i].x), by = _mm_loadu_ps(&b[i + 1].x);
+        __m128 bz = _mm_loadu_ps(&b[i + 2].x), bw = _mm_loadu_ps(&b[i + 3].x);
+        _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+        __m128 tt = _mm_loadu_ps(t + i);
+
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+                              _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+        __m128 sign = _mm_and_ps(d, sign_mask);
+        d = _mm_andnot_ps(sign_mask, d);
+
+        __m128 A = _mm_add_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(-1.43519f)));
+        A = _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, A));
+        A = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, A));
+        __m128 B = _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)));
+        B = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, B));
+        __m128 c = _mm_sub_ps(tt, half);
+        __m128 k = _mm_add_ps(_mm_mul_ps(A, _mm_mul_ps(c, c)), B);
+        __m128 u = _mm_add_ps(tt, _mm_mul_ps(_mm_mul_ps(tt, c), _mm_mul_ps(_mm_sub_ps(tt, one), k)));
+
+        __m128 wa = _mm_sub_ps(one, u);
+        __m128 wb = _mm_xor_ps(u, sign);
+        __m128 x = _mm_add_ps(_mm_mul_ps(wa, ax), _mm_mul_ps(wb, bx));
+        __m128 y = _mm_add_ps(_mm_mul_ps(wa, ay), _mm_mul_ps(wb, by));
+        __m128 z = _mm_add_ps(_mm_mul_ps(wa, az), _mm_mul_ps(wb, bz));
+        __m128 w = _mm_add_ps(_mm_mul_ps(wa, aw), _mm_mul_ps(wb, bw));
+
+        // rsqrt plus one Newton step
+        __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                 _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+        __m128 r = _mm_rsqrt_ps(len2);
+        r = _mm_mul_ps(r, _mm_sub_ps(three_halves, _mm_mul_ps(_mm_mul_ps(half, len2), _mm_mul_ps(r, r))));
+        r = _mm_and_ps(r, _mm_cmpgt_ps(len2, zero));
+        x = _mm_mul_ps(x, r);
+        y = _mm_mul_ps(y, r);
+        z = _mm_mul_ps(z, r);
+        w = _mm_mul_ps(w, r);
+
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(&out[i].x, x);
+        _mm_storeu_ps(&out[i + 1].x, y);
+        _mm_storeu_ps(&out[i + 2].x, z);
+        _mm_storeu_ps(&out[i + 3].x, w);
+    }
+#endif
+
+    for (; i < count; i++)
+        out[i] = slerp_fast(a[i], b[i], t[i]);
+}
@@ -0,0 +1,403 @@
+#include "mesh.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+static long long edge_key(int a, int b)
+{
+    if (a > b)
+        std::swap(a, b);
+    // Built unsigned: loaders hash indices before they are range-checked
+    return (long long)(((unsigned long long)(unsigned int)a << 32) | (unsigned int)b);
+}
+
+static unsigned long long hash_key(long long key)
+{
+    unsigned long long h = (unsigned long long)key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+EdgeSet::EdgeSet(int expected_edges)
+{
+    int capacity = 16;
+    while (capacity < expected_edges * 2)
+        capacity <<= 1;
+    keys.assign(capacity, -1);
+    slots.assign(capacity, -1);
+    mask = capacity - 1;
+    pairs.reserve(expected_edges > 0 ? expected_edges * 2 : 0);
+}
+
+void EdgeSet::grow()
+{
+    int capacity = (mask + 1) * 2;
+    keys.assign(capacity, -1);
+    slots.assign(capacity, -1);
+    mask = capacity - 1;
+
+    for (int e = 0; e < size(); e++)
+    {
+        long long key = edge_key(pairs[e * 2], pairs[e * 2 + 1]);
+        int h = (int)(hash_key(key) & (unsigned long long)mask);
+        while (keys[h] != -1)
+            h = (h + 1) & mask;
+        keys[h] = key;
+        slots[h] = e;
+    }
+}
+
+int EdgeSet::insert(int a, int b, bool &inserted)
+{
+    // Keep load factor <= 1/2
+    if ((size() + 1) * 2 > mask + 1)
+        grow();
+
+    long long key = edge_key(a, b);
+    int h = (int)(hash_key(key) & (unsigned long long)mask);
+    while (keys[h] != -1)
+    {
+        if (keys[h] == key)
+        {
+            inserted = false;
+            return slots[h];
+        }
+        h = (h + 1) & mask;
+    }
+
+    int e = size();
+    keys[h] = key;
+    slots[h] = e;
+    pairs.push_back(a < b ? a : b);
+    pairs.push_back(a < b ? b : a);
+    inserted = true;
+    return e;
+}
+
+int EdgeSet::find(int a, int b) const
+{
+    long long key = edge_key(a, b);
+    int h = (int)(hash_key(key) & (unsigned long long)mask);
+    while (keys[h] != -1)
+    {
+        if (keys[h] == key)
+            return slots[h];
+        h = (h + 1) & mask;
+    }
+    return -1;
+}
+
+static std::atomic<unsigned long long> next_generation(1);
+
+Mesh::Mesh() : vertex_total(0), build_generation(0)
+{
+    clear();
+}
+
+void Mesh::clear()
+{
+    build_generation = next_generation++;
+    vertex_total = 0;
+    positions.clear();
+    edge_pairs.clear();
+    face_offsets.clear();
+    face_index_list.clear();
+    edge_face_pairs.clear();
+    vertex_edge_offsets.assign(1, 0);
+    vertex_edge_list.clear();
+
+    std::memset(&box, 0, sizeof(box));
+    std::memset(&sphere, 0, sizeof(sphere));
+    std::memset(&stats, 0, sizeof(stats));
+}
+
+bool Mesh::build(
+    const vec3_t *vertices,
+    int vertex_count,
+    const int (*edges)[2],
+    int edge_count)
+{
+    std::vector<float> xyz(vertex_count > 0 ? vertex_count * 3 : 0);
+    for (int i = 0; i < vertex_count; i++)
+    {
+        xyz[i * 3 + 0] = vertices[i].x;
+        xyz[i * 3 + 1] = vertices[i].y;
+        xyz[i * 3 + 2] = vertices[i].z;
+    }
+    return build(xyz.data(), vertex_count, edges, edge_count);
+}
+
+bool Mesh::build(
+    const float *xyz,
+    int vertex_count,
+    const int (*edges)[2],
+    int edge_count,
+    const int *face_sizes,
+    int face_count,
+    const int *face_indices)
+{
+    clear();
+
+    if (vertex_count < 0 || edge_count < 0 || face_count < 0)
+        return false;
+
+    // ---- Validate positions ----
+    for (int i = 0; i < vertex_count * 3; i++)
+    {
+        if (!std::isfinite(xyz[i]))
+            stats.invalid_positions++;
+    }
+
+    // ---- Collect candidate edges (explicit + face boundaries) ----
+    std::vector<long long> keys;
+    keys.reserve(edge_count);
+
+    for (int i = 0; i < edge_count; i++)
+    {
+        int a = edges[i][0];
+        int b = edges[i][1];
+        if (a < 0 || a >= vertex_count || b < 0 || b >= vertex_count)
+        {
+            stats.invalid_indices++;
+            continue;
+        }
+        if (a == b)
+        {
+            stats.degenerate_edges++;
+            continue;
+        }
+        keys.push_back(edge_key(a, b));
+    }
+
+    // Explicit duplicates are input errors; shared face edges are not
+    std::sort(keys.begin(), keys.end());
+    size_t explicit_unique = std::unique(keys.begin(), keys.end()) - keys.begin();
+    stats.duplicate_edges = (int)(keys.size() - explicit_unique);
+    keys.resize(explicit_unique);
+
+    if (face_count > 0)
+    {
+        face_offsets.resize(face_count + 1);
+        face_offsets[0] = 0;
+        for (int f = 0; f < face_count; f++)
+        {
+            if (face_sizes[f] < 3)
+                stats.invalid_faces++;
+            face_offsets[f + 1] = face_offsets[f] + std::max(face_sizes[f], 0);
+        }
+
+        face_index_list.assign(face_indices, face_indices + face_offsets[face_count]);
+
+        for (int f = 0; f < face_count; f++)
+        {
+            int n = face_size(f);
+            const int *fv = face_vertices(f);
+            for (int k = 0; k < n; k++)
+            {
+                int a = fv[k];
+                int b = fv[(k + 1) % n];
+                if (a < 0 || a >= vertex_count || b < 0 || b >= vertex_count)
+                {
+                    stats.invalid_indices++;
+                    continue;
+                }
+                if (a != b)
+                    keys.push_back(edge_key(a, b));
+            }
+        }
+    }
+
+    if (stats.invalid_indices || stats.invalid_positions || stats.invalid_faces)
+    {
+        MeshBuildStats failed = stats;
+        clear();
+        stats = failed;
+        return false;
+    }
+
+    vertex_total = vertex_count;
+    positions.assign(xyz, xyz + vertex_count * 3);
+
+    finish(keys);
+    return true;
+}
+
+bool Mesh::adopt(
+    std::vector<float> &&xyz,
+    std::vector<int> &&edges,
+    std::vector<int> &&faces_offsets,
+    std::vector<int> &&faces_indices,
+    std::vector<int> &&edges_faces)
+{
+    clear();
+
+    int vertex_count = (int)xyz.size() / 3;
+    int edge_total = (int)edges.size() / 2;
+
+    for (size_t i = 0; i < xyz.size(); i++)
+    {
+        if (!std::isfinite(xyz[i]))
+            stats.invalid_positions++;
+    }
+
+    for (int e = 0; e < edge_total; e++)
+    {
+        int a = edges[e * 2];
+        int b = edges[e * 2 + 1];
+        if (a < 0 || a >= vertex_count || b < 0 || b >= vertex_count)
+            stats.invalid_indices++;
+        else if (a == b)
+            stats.degenerate_edges++;
+        else if (a > b)
+            std::swap(edges[e * 2], edges[e * 2 + 1]);
+    }
+
+    for (size_t i = 0; i < faces_indices.size(); i++)
+    {
+        if (faces_indices[i] < 0 || faces_indices[i] >= vertex_count)
+            stats.invalid_indices++;
+    }
+
+    for (size_t f = 0; f + 1 < faces_offsets.size(); f++)
+    {
+        if (faces_offsets[f + 1] - faces_offsets[f] < 3)
+            stats.invalid_faces++;
+    }
+
+    bool edge_faces_ok = edges_faces.empty() || (int)edges_faces.size() == edge_total * 2;
+
+    if (stats.invalid_indices || stats.invalid_positions || stats.invalid_faces ||
+        stats.degenerate_edges || !edge_faces_ok)
+    {
+        MeshBuildStats failed = stats;
+        clear();
+        stats = failed;
+        return false;
+    }
+
+    vertex_total = vertex_count;
+    positions = std::move(xyz);
+    edge_pairs = std::move(edges);
+    face_offsets = std::move(faces_offsets);
+    face_index_list = std::move(faces_indices);
+    edge_face_pairs = std::move(edges_faces);
+
+    compute_adjacency();
+    compute_bounds();
+    return true;
+}
+
+void Mesh::finish(std::vector<long long> &edge_keys)
+{
+    // Canonical order: sorted by (a, b), duplicates removed
+    std::sort(edge_keys.begin(), edge_keys.end());
+    size_t unique_count = std::unique(edge_keys.begin(), edge_keys.end()) - edge_keys.begin();
+    edge_keys.resize(unique_count);
+
+    edge_pairs.resize(unique_count * 2);
+    for (size_t i = 0; i < unique_count; i++)
+    {
+        edge_pairs[i * 2 + 0] = (int)(edge_keys[i] >> 32);
+        edge_pairs[i * 2 + 1] = (int)(edge_keys[i] & 0xffffffffLL);
+    }
+
+    // ---- Edge -> face adjacency ----
+    if (face_count() > 0)
+    {
+        edge_face_pairs.assign(unique_count * 2, -1);
+
+        for (int f = 0; f < face_count(); f++)
+        {
+            int n = face_size(f);
+            const int *fv = face_vertices(f);
+            for (int k = 0; k < n; k++)
+            {
+                int a = fv[k];
+                int b = fv[(k + 1) % n];
+                if (a == b)
+                    continue;
+
+                long long key = edge_key(a, b);
+                int e = (int)(std::lower_bound(edge_keys.begin(), edge_keys.end(), key) - edge_keys.begin());
+
+                if (edge_face_pairs[e * 2] < 0)
+                    edge_face_pairs[e * 2] = f;
+                else if (edge_face_pairs[e * 2 + 1] < 0)
+                    edge_face_pairs[e * 2 + 1] = f;
+                else
+                    stats.nonmanifold_edges++;
+            }
+        }
+    }
+
+    compute_adjacency();
+    compute_bounds();
+}
+
+void Mesh::compute_adjacency()
+{
+    int n = vertex_total;
+    int ec = edge_count();
+
+    vertex_edge_offsets.assign(n + 1, 0);
+    for (int e = 0; e < ec; e++)
+    {
+        vertex_edge_offsets[edge_pairs[e * 2] + 1]++;
+        vertex_edge_offsets[edge_pairs[e * 2 + 1] + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+        vertex_edge_offsets[v + 1] += vertex_edge_offsets[v];
+
+    vertex_edge_list.resize(ec * 2);
+    std::vector<int> cursor(vertex_edge_offsets.begin(), vertex_edge_offsets.end() - 1);
+    for (int e = 0; e < ec; e++)
+    {
+        vertex_edge_list[cursor[edge_pairs[e * 2]]++] = e;
+        vertex_edge_list[cursor[edge_pairs[e * 2 + 1]]++] = e;
+    }
+}
+
+void Mesh::compute_bounds()
+{
+    if (vertex_total == 0)
+        return;
+
+    const float *p = positions.data();
+    for (int k = 0; k < 3; k++)
+    {
+        box.min[k] = p[k];
+        box.max[k] = p[k];
+    }
+
+    for (int i = 1; i < vertex_total; i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            float v = p[i * 3 + k];
+            if (v < box.min[k])
+                box.min[k] = v;
+            if (v > box.max[k])
+                box.max[k] = v;
+        }
+    }
+
+    // Sphere around the box centre, tight to the furthest vertex
+    float r2 = 0.0f;
+    for (int k = 0; k < 3; k++)
+        sphere.center[k] = (box.min[k] + box.max[k]) * 0.5f;
+
+    for (int i = 0; i < vertex_total; i++)
+    {
+        float dx = p[i * 3 + 0] - sphere.center[0];
+        float dy = p[i * 3 + 1] - sphere.center[1];
+        float dz = p[i * 3 + 2] - sphere.center[2];
+        float d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 > r2)
+            r2 = d2;
+    }
+    sphere.radius = std::sqrt(r2);
+}
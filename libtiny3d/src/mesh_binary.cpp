@@ -0,0 +1,252 @@
+#include "mesh_binary.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static_assert(sizeof(MeshFileHeader) == 80, "MeshFileHeader layout changed");
+
+static uint64_t align16(uint64_t offset)
+{
+    return (offset + 15) & ~(uint64_t)15;
+}
+
+static bool write_padded(FILE *f, const void *data, size_t bytes, uint64_t &offset)
+{
+    static const unsigned char ZERO[16] = {0};
+
+    uint64_t aligned = align16(offset);
+    if (aligned > offset && std::fwrite(ZERO, 1, (size_t)(aligned - offset), f) != aligned - offset)
+        return false;
+    if (bytes && std::fwrite(data, 1, bytes, f) != bytes)
+        return false;
+
+    offset = aligned + bytes;
+    return true;
+}
+
+bool write_mesh_binary(const Mesh &mesh, const char *path, bool quantize_positions)
+{
+    int vertex_count = mesh.vertex_count();
+    int edge_count = mesh.edge_count();
+    const AABB &box = mesh.aabb();
+    const BoundingSphere &sphere = mesh.bounding_sphere();
+
+    MeshFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MESH_FILE_MAGIC, 4);
+    header.version = MESH_FILE_VERSION;
+    header.vertex_count = (uint32_t)vertex_count;
+    header.edge_count = (uint32_t)edge_count;
+    for (int k = 0; k < 3; k++)
+    {
+        header.bounds_min[k] = box.min[k];
+        header.bounds_max[k] = box.max[k];
+        header.sphere[k] = sphere.center[k];
+    }
+    header.sphere[3] = sphere.radius;
+
+    if (quantize_positions)
+        header.flags |= MESH_FILE_QUANTIZED;
+    if (vertex_count <= 65536)
+        header.flags |= MESH_FILE_INDEX16;
+
+    size_t position_bytes = (size_t)vertex_count * 3 * (quantize_positions ? 2 : 4);
+    size_t edge_bytes = (size_t)edge_count * 2 * ((header.flags & MESH_FILE_INDEX16) ? 2 : 4);
+    header.positions_offset = align16(sizeof(header));
+    header.edges_offset = align16(header.positions_offset + position_bytes);
+
+    // ---- Encode sections ----
+    std::vector<uint16_t> q16;
+    const void *positions = mesh.position_data();
+    if (quantize_positions)
+    {
+        q16.resize((size_t)vertex_count * 3);
+        const float *p = mesh.position_data();
+        for (int k = 0; k < 3; k++)
+        {
+            float extent = box.max[k] - box.min[k];
+            float scale = extent > 0.0f ? 65535.0f / extent : 0.0f;
+            for (int i = 0; i < vertex_count; i++)
+                q16[i * 3 + k] = (uint16_t)std::lround((p[i * 3 + k] - box.min[k]) * scale);
+        }
+        positions = q16.data();
+    }
+
+    std::vector<uint16_t> e16;
+    const void *edges = mesh.edge_data();
+    if (header.flags & MESH_FILE_INDEX16)
+    {
+        e16.resize((size_t)edge_count * 2);
+        const int(*src)[2] = mesh.edge_data();
+        for (int e = 0; e < edge_count; e++)
+        {
+            e16[e * 2] = (uint16_t)src[e][0];
+            e16[e * 2 + 1] = (uint16_t)src[e][1];
+        }
+        edges = e16.data();
+    }
+
+    FILE *f = std::fopen(path, "wb");
+    if (!f)
+        return false;
+
+    uint64_t offset = 0;
+    bool ok = write_padded(f, &header, sizeof(header), offset) &&
+              write_padded(f, positions, position_bytes, offset) &&
+              write_padded(f, edges, edge_bytes, offset);
+
+    return std::fclose(f) == 0 && ok;
+}
+
+MeshView::MeshView() : base(nullptr), header(nullptr)
+{
+}
+
+void MeshView::close()
+{
+    file.close();
+    base = nullptr;
+    header = nullptr;
+}
+
+bool MeshView::open(const char *path)
+{
+    close();
+    if (!file.open(path))
+        return false;
+    if (!attach(file.data(), file.size()))
+    {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+bool MeshView::attach(const unsigned char *data, size_t size)
+{
+    base = nullptr;
+    header = nullptr;
+
+    if (size < sizeof(MeshFileHeader))
+        return false;
+
+    const MeshFileHeader *h = reinterpret_cast<const MeshFileHeader *>(data);
+    if (std::memcmp(h->magic, MESH_FILE_MAGIC, 4) != 0 || h->version != MESH_FILE_VERSION)
+        return false;
+
+    bool q = (h->flags & MESH_FILE_QUANTIZED) != 0;
+    bool i16 = (h->flags & MESH_FILE_INDEX16) != 0;
+    uint64_t position_bytes = (uint64_t)h->vertex_count * 3 * (q ? 2 : 4);
+    uint64_t edge_bytes = (uint64_t)h->edge_count * 2 * (i16 ? 2 : 4);
+
+    // Offsets are compared against what is left of the buffer so that a
+    // hostile offset cannot wrap the sum past size
+    if ((h->positions_offset & 15) || (h->edges_offset & 15) ||
+        h->positions_offset < sizeof(MeshFileHeader) ||
+        h->edges_offset < sizeof(MeshFileHeader) ||
+        h->positions_offset > size || position_bytes > size - h->positions_offset ||
+        h->edges_offset > size || edge_bytes > size - h->edges_offset ||
+        h->vertex_count > (uint32_t)INT_MAX || h->edge_count > (uint32_t)INT_MAX ||
+        (i16 && h->vertex_count > 65536))
+        return false;
+
+    base = data;
+    header = h;
+    return true;
+}
+
+bool MeshView::validate() const
+{
+    if (!header)
+        return false;
+
+    uint32_t max_index = 0;
+    uint64_t index_count = (uint64_t)header->edge_count * 2;
+    if (index16())
+    {
+        const uint16_t *p = static_cast<const uint16_t *>(edge_data());
+        for (uint64_t i = 0; i < index_count; i++)
+            max_index = std::max(max_index, (uint32_t)p[i]);
+    }
+    else
+    {
+        const uint32_t *p = static_cast<const uint32_t *>(edge_data());
+        for (uint64_t i = 0; i < index_count; i++)
+            max_index = std::max(max_index, p[i]);
+    }
+    return index_count == 0 || max_index < header->vertex_count;
+}
+
+AABB MeshView::aabb() const
+{
+    AABB box;
+    for (int k = 0; k < 3; k++)
+    {
+        box.min[k] = header->bounds_min[k];
+        box.max[k] = header->bounds_max[k];
+    }
+    return box;
+}
+
+BoundingSphere MeshView::bounding_sphere() const
+{
+    BoundingSphere s;
+    for (int k = 0; k < 3; k++)
+        s.center[k] = header->sphere[k];
+    s.radius = header->sphere[3];
+    return s;
+}
+
+mat4 MeshView::dequantize_matrix() const
+{
+    if (!quantized())
+        return mat4::identity();
+
+    const float *lo = header->bounds_min;
+    const float *hi = header->bounds_max;
+    return multiply(
+        mat4::translation(lo[0], lo[1], lo[2]),
+        mat4::scale(
+            (hi[0] - lo[0]) / 65535.0f,
+            (hi[1] - lo[1]) / 65535.0f,
+            (hi[2] - lo[2]) / 65535.0f));
+}
+
+void MeshView::position(int i, float out[3]) const
+{
+    if (quantized())
+    {
+        const uint16_t *q = static_cast<const uint16_t *>(position_data()) + i * 3;
+        for (int k = 0; k < 3; k++)
+        {
+            float extent = header->bounds_max[k] - header->bounds_min[k];
+            out[k] = header->bounds_min[k] + q[k] * (extent / 65535.0f);
+        }
+    }
+    else
+    {
+        const float *p = static_cast<const float *>(position_data()) + i * 3;
+        out[0] = p[0];
+        out[1] = p[1];
+        out[2] = p[2];
+    }
+}
+
+void MeshView::edge(int e, int &a, int &b) const
+{
+    if (index16())
+    {
+        const uint16_t *p = static_cast<const uint16_t *>(edge_data()) + e * 2;
+        a = p[0];
+        b = p[1];
+    }
+    else
+    {
+        const uint32_t *p = static_cast<const uint32_t *>(edge_data()) + e * 2;
+        a = (int)p[0];
+        b = (int)p[1];
+    }
+}
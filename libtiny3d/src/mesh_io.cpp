@@ -0,0 +1,767 @@
+#include "mesh_io.h"
+#include "mesh.h"
+#include "mapped_file.h"
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <utility>
+
+// --------------------
+// Tokenizer helpers
+// --------------------
+
+static inline bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline void skip_spaces(const char *&p, const char *end)
+{
+    while (p < end && is_space(*p))
+        p++;
+}
+
+static inline void skip_line(const char *&p, const char *end)
+{
+    while (p < end && *p != '\n')
+        p++;
+    if (p < end)
+        p++;
+}
+
+static inline void skip_token(const char *&p, const char *end)
+{
+    while (p < end && !is_space(*p) && *p != '\n')
+        p++;
+}
+
+static bool parse_int(const char *&p, const char *end, long long &out)
+{
+    const char *s = p;
+    bool neg = false;
+    if (s < end && (*s == '-' || *s == '+'))
+    {
+        neg = *s == '-';
+        s++;
+    }
+    if (s >= end || !is_digit(*s))
+        return false;
+
+    long long v = 0;
+    while (s < end && is_digit(*s))
+    {
+        int d = *s++ - '0';
+        if (v > (LLONG_MAX - d) / 10)
+            return false;
+        v = v * 10 + d;
+    }
+
+    out = neg ? -v : v;
+    p = s;
+    return true;
+}
+
+static bool parse_number(const char *&p, const char *end, double &out)
+{
+    static const double POW10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    const char *s = p;
+    bool neg = false;
+    if (s < end && (*s == '-' || *s == '+'))
+    {
+        neg = *s == '-';
+        s++;
+    }
+
+    // Up to 19 significant digits in an integer mantissa
+    unsigned long long mant = 0;
+    int digits = 0;
+    int exp10 = 0;
+    bool any = false;
+
+    while (s < end && is_digit(*s))
+    {
+        if (digits < 19)
+        {
+            mant = mant * 10 + (*s - '0');
+            if (mant)
+                digits++;
+        }
+        else
+        {
+            exp10++;
+        }
+        any = true;
+        s++;
+    }
+
+    if (s < end && *s == '.')
+    {
+        s++;
+        while (s < end && is_digit(*s))
+        {
+            if (digits < 19)
+            {
+                mant = mant * 10 + (*s - '0');
+                if (mant)
+                    digits++;
+                exp10--;
+            }
+            any = true;
+            s++;
+        }
+    }
+
+    if (!any)
+        return false;
+
+    if (s < end && (*s == 'e' || *s == 'E'))
+    {
+        const char *e = s + 1;
+        long long ev;
+        if (parse_int(e, end, ev))
+        {
+            exp10 += (int)(ev > 1000 ? 1000 : (ev < -1000 ? -1000 : ev));
+            s = e;
+        }
+    }
+
+    double v = (double)mant;
+    if (exp10 >= 0 && exp10 <= 22)
+        v *= POW10[exp10];
+    else if (exp10 < 0 && exp10 >= -22)
+        v /= POW10[-exp10];
+    else
+        v *= std::pow(10.0, exp10);
+
+    out = neg ? -v : v;
+    p = s;
+    return true;
+}
+
+// --------------------
+// Streaming mesh builder
+// --------------------
+
+struct MeshStream
+{
+    std::vector<float> positions;
+    std::vector<int> face_offsets;
+    std::vector<int> face_indices;
+    std::vector<int> edge_faces;
+    EdgeSet edges;
+    int skipped;
+
+    MeshStream() : skipped(0)
+    {
+        face_offsets.push_back(0);
+    }
+
+    void add_face(const int *idx, int n)
+    {
+        if (n < 3)
+        {
+            skipped++;
+            return;
+        }
+
+        int f = (int)face_offsets.size() - 1;
+        face_indices.insert(face_indices.end(), idx, idx + n);
+        face_offsets.push_back((int)face_indices.size());
+
+        for (int k = 0; k < n; k++)
+        {
+            int a = idx[k];
+            int b = idx[k + 1 < n ? k + 1 : 0];
+            if (a == b)
+                continue;
+
+            bool inserted;
+            int e = edges.insert(a, b, inserted);
+            if (inserted)
+            {
+                edge_faces.push_back(f);
+                edge_faces.push_back(-1);
+            }
+            else if (edge_faces[e * 2 + 1] < 0 && edge_faces[e * 2] != f)
+            {
+                edge_faces[e * 2 + 1] = f;
+            }
+        }
+    }
+
+    void add_edge(int a, int b)
+    {
+        if (a == b)
+            return;
+
+        bool inserted;
+        edges.insert(a, b, inserted);
+        if (inserted)
+        {
+            edge_faces.push_back(-1);
+            edge_faces.push_back(-1);
+        }
+    }
+
+    bool finish(Mesh &out, MeshLoadInfo *info)
+    {
+        int face_count = (int)face_offsets.size() - 1;
+        if (face_count == 0)
+        {
+            face_offsets.clear();
+            edge_faces.clear();
+        }
+
+        if (info)
+        {
+            info->vertices = (int)positions.size() / 3;
+            info->faces = face_count;
+            info->edges = edges.size();
+            info->skipped = skipped;
+        }
+
+        if (!out.adopt(
+                std::move(positions),
+                std::move(edges.edge_pairs()),
+                std::move(face_offsets),
+                std::move(face_indices),
+                std::move(edge_faces)))
+        {
+            if (info)
+                info->error = "index out of range or invalid coordinate";
+            return false;
+        }
+        return true;
+    }
+};
+
+static void reset_info(MeshLoadInfo *info, long long bytes)
+{
+    if (info)
+    {
+        std::memset(info, 0, sizeof(*info));
+        info->bytes = bytes;
+    }
+}
+
+static bool fail(MeshLoadInfo *info, const char *message)
+{
+    if (info)
+        info->error = message;
+    return false;
+}
+
+// --------------------
+// OBJ
+// --------------------
+
+// "12", "12/4", "12//7", "-1/2/3": only the position index is used
+static bool parse_obj_index(const char *&p, const char *end, int vertex_count, int &out)
+{
+    long long v;
+    if (!parse_int(p, end, v))
+        return false;
+    skip_token(p, end);
+
+    // Checked before narrowing: a huge index must not wrap onto a real vertex
+    if (v == 0 || v > vertex_count || v < -(long long)vertex_count)
+        return false;
+    out = v > 0 ? (int)(v - 1) : vertex_count + (int)v;
+    return true;
+}
+
+bool parse_obj(const char *text, size_t length, Mesh &out, MeshLoadInfo *info)
+{
+    reset_info(info, (long long)length);
+
+    MeshStream stream;
+    std::vector<int> poly;
+
+    const char *p = text;
+    const char *end = text + length;
+
+    while (p < end)
+    {
+        skip_spaces(p, end);
+        if (p + 1 >= end || *p == '\n')
+        {
+            skip_line(p, end);
+            continue;
+        }
+
+        char c = p[0];
+        bool keyword_end = is_space(p[1]);
+
+        if (c == 'v' && keyword_end)
+        {
+            p += 2;
+            double xyz[3];
+            bool ok = true;
+            for (int k = 0; k < 3 && ok; k++)
+            {
+                skip_spaces(p, end);
+                ok = parse_number(p, end, xyz[k]);
+            }
+            if (!ok)
+                return fail(info, "malformed vertex");
+
+            stream.positions.push_back((float)xyz[0]);
+            stream.positions.push_back((float)xyz[1]);
+            stream.positions.push_back((float)xyz[2]);
+        }
+        else if ((c == 'f' || c == 'l') && keyword_end)
+        {
+            p += 2;
+            int vertex_count = (int)stream.positions.size() / 3;
+            poly.clear();
+
+            while (true)
+            {
+                skip_spaces(p, end);
+                if (p >= end || *p == '\n')
+                    break;
+
+                int index;
+                if (!parse_obj_index(p, end, vertex_count, index))
+                {
+                    stream.skipped++;
+                    skip_token(p, end);
+                    continue;
+                }
+                poly.push_back(index);
+            }
+
+            if (c == 'f')
+            {
+                stream.add_face(poly.data(), (int)poly.size());
+            }
+            else
+            {
+                for (size_t k = 1; k < poly.size(); k++)
+                    stream.add_edge(poly[k - 1], poly[k]);
+            }
+        }
+        else if (c != '#' && !(c == 'v' && (p[1] == 'n' || p[1] == 't' || p[1] == 'p')) &&
+                 c != 'o' && c != 'g' && c != 's')
+        {
+            // usemtl, mtllib, curves, ... are not wireframe data
+            stream.skipped++;
+        }
+
+        skip_line(p, end);
+    }
+
+    return stream.finish(out, info);
+}
+
+bool load_obj(const char *path, Mesh &out, MeshLoadInfo *info)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        reset_info(info, 0);
+        return fail(info, "cannot open file");
+    }
+    file.advise_sequential();
+
+    return parse_obj(reinterpret_cast<const char *>(file.data()), file.size(), out, info);
+}
+
+// --------------------
+// PLY
+// --------------------
+
+enum PlyType
+{
+    PLY_NONE,
+    PLY_INT8,
+    PLY_UINT8,
+    PLY_INT16,
+    PLY_UINT16,
+    PLY_INT32,
+    PLY_UINT32,
+    PLY_FLOAT32,
+    PLY_FLOAT64
+};
+
+enum PlyFormat
+{
+    PLY_ASCII,
+    PLY_BINARY_LE,
+    PLY_BINARY_BE
+};
+
+struct PlyProperty
+{
+    PlyType type;
+    PlyType count_type; // PLY_NONE unless this is a list
+    int role;           // vertex: 0..2 = x,y,z; face/edge: 0 = indices / vertex1, 1 = vertex2; -1 = ignored
+};
+
+struct PlyElement
+{
+    int kind; // 0 = vertex, 1 = face, 2 = edge, -1 = other
+    long long count;
+    std::vector<PlyProperty> properties;
+};
+
+static const int PLY_SIZES[] = {0, 1, 1, 2, 2, 4, 4, 4, 8};
+
+static bool token_is(const char *p, const char *end, const char *word)
+{
+    size_t n = std::strlen(word);
+    return (size_t)(end - p) >= n && std::memcmp(p, word, n) == 0 &&
+           (p + n == end || is_space(p[n]) || p[n] == '\n');
+}
+
+static PlyType parse_ply_type(const char *&p, const char *end)
+{
+    static const struct
+    {
+        const char *name;
+        PlyType type;
+    } TYPES[] = {
+        {"char", PLY_INT8}, {"int8", PLY_INT8}, {"uchar", PLY_UINT8}, {"uint8", PLY_UINT8},
+        {"short", PLY_INT16}, {"int16", PLY_INT16}, {"ushort", PLY_UINT16}, {"uint16", PLY_UINT16},
+        {"int", PLY_INT32}, {"int32", PLY_INT32}, {"uint", PLY_UINT32}, {"uint32", PLY_UINT32},
+        {"float", PLY_FLOAT32}, {"float32", PLY_FLOAT32}, {"double", PLY_FLOAT64}, {"float64", PLY_FLOAT64}};
+
+    skip_spaces(p, end);
+    for (size_t i = 0; i < sizeof(TYPES) / sizeof(TYPES[0]); i++)
+    {
+        if (token_is(p, end, TYPES[i].name))
+        {
+            p += std::strlen(TYPES[i].name);
+            return TYPES[i].type;
+        }
+    }
+    return PLY_NONE;
+}
+
+static double read_binary(const unsigned char *p, PlyType type, bool big_endian)
+{
+    unsigned char b[8];
+    int n = PLY_SIZES[type];
+
+    // Host is assumed little endian (x86 / ARM)
+    for (int i = 0; i < n; i++)
+        b[i] = big_endian ? p[n - 1 - i] : p[i];
+
+    switch (type)
+    {
+    case PLY_INT8:
+        return (double)(signed char)b[0];
+    case PLY_UINT8:
+        return (double)b[0];
+    case PLY_INT16:
+    {
+        short v;
+        std::memcpy(&v, b, 2);
+        return v;
+    }
+    case PLY_UINT16:
+    {
+        unsigned short v;
+        std::memcpy(&v, b, 2);
+        return v;
+    }
+    case PLY_INT32:
+    {
+        int v;
+        std::memcpy(&v, b, 4);
+        return v;
+    }
+    case PLY_UINT32:
+    {
+        unsigned int v;
+        std::memcpy(&v, b, 4);
+        return v;
+    }
+    case PLY_FLOAT32:
+    {
+        float v;
+        std::memcpy(&v, b, 4);
+        return v;
+    }
+    case PLY_FLOAT64:
+    {
+        double v;
+        std::memcpy(&v, b, 8);
+        return v;
+    }
+    default:
+        return 0.0;
+    }
+}
+
+// Reads one scalar in either encoding; advances p
+static bool read_ply_value(
+    const unsigned char *&p,
+    const unsigned char *end,
+    PlyFormat format,
+    PlyType type,
+    double &out)
+{
+    if (format == PLY_ASCII)
+    {
+        const char *s = reinterpret_cast<const char *>(p);
+        const char *e = reinterpret_cast<const char *>(end);
+        while (s < e && (is_space(*s) || *s == '\n'))
+            s++;
+        if (!parse_number(s, e, out))
+            return false;
+        p = reinterpret_cast<const unsigned char *>(s);
+        return true;
+    }
+
+    int n = PLY_SIZES[type];
+    if (end - p < n)
+        return false;
+    out = read_binary(p, type, format == PLY_BINARY_BE);
+    p += n;
+    return true;
+}
+
+bool parse_ply(const unsigned char *data, size_t length, Mesh &out, MeshLoadInfo *info)
+{
+    reset_info(info, (long long)length);
+
+    const char *p = reinterpret_cast<const char *>(data);
+    const char *end = p + length;
+
+    if (!token_is(p, end, "ply"))
+        return fail(info, "not a PLY file");
+    skip_line(p, end);
+
+    // ---- Header ----
+    PlyFormat format = PLY_ASCII;
+    std::vector<PlyElement> elements;
+    bool header_done = false;
+
+    while (p < end && !header_done)
+    {
+        skip_spaces(p, end);
+
+        if (token_is(p, end, "format"))
+        {
+            p += 6;
+            skip_spaces(p, end);
+            if (token_is(p, end, "ascii"))
+                format = PLY_ASCII;
+            else if (token_is(p, end, "binary_little_endian"))
+                format = PLY_BINARY_LE;
+            else if (token_is(p, end, "binary_big_endian"))
+                format = PLY_BINARY_BE;
+            else
+                return fail(info, "unknown PLY format");
+        }
+        else if (token_is(p, end, "element"))
+        {
+            p += 7;
+            skip_spaces(p, end);
+
+            PlyElement el;
+            el.kind = -1;
+            if (token_is(p, end, "vertex"))
+                el.kind = 0;
+            else if (token_is(p, end, "face"))
+                el.kind = 1;
+            else if (token_is(p, end, "edge"))
+                el.kind = 2;
+            skip_token(p, end);
+            skip_spaces(p, end);
+            if (!parse_int(p, end, el.count) || el.count < 0)
+                return fail(info, "bad element count");
+            elements.push_back(el);
+        }
+        else if (token_is(p, end, "property"))
+        {
+            if (elements.empty())
+                return fail(info, "property before element");
+
+            p += 8;
+            skip_spaces(p, end);
+
+            PlyProperty prop;
+            prop.count_type = PLY_NONE;
+            if (token_is(p, end, "list"))
+            {
+                p += 4;
+                prop.count_type = parse_ply_type(p, end);
+                if (prop.count_type == PLY_NONE)
+                    return fail(info, "bad list count type");
+            }
+            prop.type = parse_ply_type(p, end);
+            if (prop.type == PLY_NONE)
+                return fail(info, "bad property type");
+
+            skip_spaces(p, end);
+            PlyElement &el = elements.back();
+            prop.role = -1;
+            if (el.kind == 0 && prop.count_type == PLY_NONE)
+            {
+                if (token_is(p, end, "x"))
+                    prop.role = 0;
+                else if (token_is(p, end, "y"))
+                    prop.role = 1;
+                else if (token_is(p, end, "z"))
+                    prop.role = 2;
+            }
+            else if (el.kind == 1 && prop.count_type != PLY_NONE &&
+                     (token_is(p, end, "vertex_indices") || token_is(p, end, "vertex_index")))
+            {
+                prop.role = 0;
+            }
+            else if (el.kind == 2 && prop.count_type == PLY_NONE)
+            {
+                if (token_is(p, end, "vertex1"))
+                    prop.role = 0;
+                else if (token_is(p, end, "vertex2"))
+                    prop.role = 1;
+            }
+            el.properties.push_back(prop);
+        }
+        else if (token_is(p, end, "end_header"))
+        {
+            header_done = true;
+        }
+        // comment, obj_info: ignored
+
+        skip_line(p, end);
+    }
+
+    if (!header_done)
+        return fail(info, "missing end_header");
+
+    // ---- Body ----
+    MeshStream stream;
+    std::vector<int> poly;
+
+    const unsigned char *q = reinterpret_cast<const unsigned char *>(p);
+    const unsigned char *qend = data + length;
+
+    for (size_t ei = 0; ei < elements.size(); ei++)
+    {
+        const PlyElement &el = elements[ei];
+
+        // The header count is not trusted: every item takes at least one
+        // byte per value (binary) or a digit and a separator (ASCII), so a
+        // count the remaining data cannot hold fails before any allocation
+        size_t min_bytes = 0;
+        for (size_t pi = 0; pi < el.properties.size(); pi++)
+        {
+            const PlyProperty &prop = el.properties[pi];
+            PlyType first = prop.count_type != PLY_NONE ? prop.count_type : prop.type;
+            min_bytes += format == PLY_ASCII ? 2 : PLY_SIZES[first];
+        }
+        if (min_bytes == 0)
+        {
+            if (el.kind == 0 && el.count > 0)
+                return fail(info, "PLY vertex element has no properties");
+            continue;
+        }
+        // An ASCII file may end without a final separator
+        size_t remaining = (size_t)(qend - q) + (format == PLY_ASCII ? 1 : 0);
+        if ((unsigned long long)el.count > remaining / min_bytes)
+            return fail(info, "truncated PLY data");
+
+        if (el.kind == 0)
+            stream.positions.reserve(stream.positions.size() + (size_t)el.count * 3);
+
+        for (long long item = 0; item < el.count; item++)
+        {
+            float xyz[3] = {0.0f, 0.0f, 0.0f};
+            int ends[2] = {0, 0};
+            poly.clear();
+
+            for (size_t pi = 0; pi < el.properties.size(); pi++)
+            {
+                const PlyProperty &prop = el.properties[pi];
+                double v;
+
+                if (prop.count_type != PLY_NONE)
+                {
+                    if (!read_ply_value(q, qend, format, prop.count_type, v))
+                        return fail(info, "truncated PLY data");
+                    if (!(v >= 0.0 && v <= INT_MAX))
+                        return fail(info, "bad PLY list count");
+                    int n = (int)v;
+                    for (int k = 0; k < n; k++)
+                    {
+                        if (!read_ply_value(q, qend, format, prop.type, v))
+                            return fail(info, "truncated PLY data");
+                        if (prop.role != 0)
+                            continue;
+                        if (!(v >= INT_MIN && v <= INT_MAX))
+                            return fail(info, "PLY index out of range");
+                        poly.push_back((int)v);
+                    }
+                    continue;
+                }
+
+                if (!read_ply_value(q, qend, format, prop.type, v))
+                    return fail(info, "truncated PLY data");
+
+                if (el.kind == 0 && prop.role >= 0)
+                    xyz[prop.role] = (float)v;
+                else if (el.kind == 2 && prop.role >= 0)
+                {
+                    if (!(v >= INT_MIN && v <= INT_MAX))
+                        return fail(info, "PLY index out of range");
+                    ends[prop.role] = (int)v;
+                }
+            }
+
+            if (el.kind == 0)
+            {
+                stream.positions.push_back(xyz[0]);
+                stream.positions.push_back(xyz[1]);
+                stream.positions.push_back(xyz[2]);
+            }
+            else if (el.kind == 1)
+            {
+                stream.add_face(poly.data(), (int)poly.size());
+            }
+            else if (el.kind == 2)
+            {
+                stream.add_edge(ends[0], ends[1]);
+            }
+        }
+    }
+
+    return stream.finish(out, info);
+}
+
+bool load_ply(const char *path, Mesh &out, MeshLoadInfo *info)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        reset_info(info, 0);
+        return fail(info, "cannot open file");
+    }
+    file.advise_sequential();
+
+    return parse_ply(file.data(), file.size(), out, info);
+}
+
+bool load_mesh(const char *path, Mesh &out, MeshLoadInfo *info)
+{
+    const char *dot = std::strrchr(path, '.');
+    if (dot && (std::strcmp(dot, ".ply") == 0 || std::strcmp(dot, ".PLY") == 0))
+        return load_ply(path, out, info);
+    if (dot && (std::strcmp(dot, ".obj") == 0 || std::strcmp(dot, ".OBJ") == 0))
+        return load_obj(path, out, info);
+
+    reset_info(info, 0);
+    return fail(info, "unknown mesh extension");
+}
@@ -0,0 +1,100 @@
+#include "morph.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstring>
+
+// Untouched vertices allowed inside a run before it is split
+static const int MAX_RUN_GAP = 2;
+
+MorphSet::MorphSet() {}
+
+void MorphSet::set_base(const float *xyz, int vertex_count)
+{
+    base.assign(xyz, xyz + (size_t)vertex_count * 3);
+    targets.clear();
+}
+
+void MorphSet::set_base(const Mesh &mesh)
+{
+    set_base(mesh.position_data(), mesh.vertex_count());
+}
+
+void MorphSet::clear()
+{
+    base.clear();
+    targets.clear();
+}
+
+int MorphSet::add_target(const float *xyz, int count, float epsilon)
+{
+    if (count != vertex_count())
+        return -1;
+
+    Target target;
+    float limit2 = epsilon * epsilon;
+    int run_end = -1; // one past the last moved vertex of the open run
+    for (int v = 0; v < count; v++)
+    {
+        float d[3] = {xyz[v * 3] - base[v * 3], xyz[v * 3 + 1] - base[v * 3 + 1], xyz[v * 3 + 2] - base[v * 3 + 2]};
+        float len2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+        if (!(len2 > limit2))
+            continue;
+
+        if (target.runs.empty() || v - run_end > MAX_RUN_GAP)
+            target.runs.push_back({v, 0, (int)target.deltas.size()});
+        Run &run = target.runs.back();
+        // Zero deltas for the skipped vertices of a short gap
+        for (int gap = run.first + run.count; gap < v; gap++)
+        {
+            target.deltas.insert(target.deltas.end(), {0.0f, 0.0f, 0.0f});
+            run.count++;
+        }
+        target.deltas.insert(target.deltas.end(), {d[0], d[1], d[2]});
+        run.count++;
+        run_end = v + 1;
+    }
+
+    targets.push_back(std::move(target));
+    return target_count() - 1;
+}
+
+int MorphSet::target_vertices(int t) const
+{
+    return (int)targets[t].deltas.size() / 3;
+}
+
+// out[i] += w * delta[i] for n floats
+static void accumulate(float *out, const float *delta, float w, int n)
+{
+    int i = 0;
+#ifdef TINY3D_SSE2
+    const __m128 weight = _mm_set1_ps(w);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 a = _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(weight, _mm_loadu_ps(delta + i)));
+        __m128 b = _mm_add_ps(_mm_loadu_ps(out + i + 4), _mm_mul_ps(weight, _mm_loadu_ps(delta + i + 4)));
+        _mm_storeu_ps(out + i, a);
+        _mm_storeu_ps(out + i + 4, b);
+    }
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(weight, _mm_loadu_ps(delta + i))));
+#endif
+    for (; i < n; i++)
+        out[i] += w * delta[i];
+}
+
+void MorphSet::blend(const float *weights, float *out) const
+{
+    if (!base.empty())
+        std::memcpy(out, base.data(), base.size() * sizeof(float));
+
+    for (int t = 0; t < target_count(); t++)
+    {
+        float w = weights[t];
+        if (w == 0.0f)
+            continue;
+        const Target &target = targets[t];
+        for (const Run &run : target.runs)
+            accumulate(out + run.first * 3, target.deltas.data() + run.offset, w, run.count * 3);
+    }
+}
@@ -0,0 +1,296 @@
+#include "points.h"
+#include "canvas.h"
+#include "raster.h"
+#include "simd.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static const int BAND_ROWS = 32;
+static const int CHUNK_POINTS = 1 << 20; // bounds the binned splat storage
+
+PointOptions default_point_options()
+{
+    PointOptions o;
+    o.intensity = 1.0f;
+    o.size = 1.0f;
+    o.size_by_distance = false;
+    o.reference_distance = 1.0f;
+    o.max_size = 8.0f;
+    o.threads = 0;
+    return o;
+}
+
+struct Splat
+{
+    int x, y; // top-left pixel, may be off screen for large splats
+    int side;
+    float z;
+    float value;
+};
+
+// --------------------
+// Projection
+// --------------------
+
+struct PointSetup
+{
+    float m[16];
+    float width, height;
+    float intensity;
+    float size, size_scale, max_size; // size_scale = 0: fixed size
+};
+
+template <typename Emit>
+static void emit_point(const PointSetup &s, const float *intensity, int i,
+                       float sx, float sy, float z, float w, Emit &emit)
+{
+    float side = s.size;
+    if (s.size_scale > 0.0f)
+        side = std::min(s.max_size, std::max(1.0f, s.size * s.size_scale / w));
+    int n = std::max(1, (int)(side + 0.5f));
+
+    Splat splat;
+    splat.x = (int)sx - (n - 1) / 2;
+    splat.y = (int)sy - (n - 1) / 2;
+    splat.side = n;
+    splat.z = z;
+    splat.value = intensity ? s.intensity * intensity[i] : s.intensity;
+    emit(splat);
+}
+
+// Projects points [begin, end), calling emit for each one that lands on screen;
+// returns how many were clipped
+template <typename Emit>
+static long long project_points(const PointSetup &s, const float *xyz, const float *intensity,
+                                int begin, int end, Emit emit)
+{
+    const float *m = s.m;
+    long long clipped = 0;
+    int i = begin;
+
+#ifdef TINY3D_SSE2
+    const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]), m3 = _mm_set1_ps(m[3]);
+    const __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]), m7 = _mm_set1_ps(m[7]);
+    const __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]), m11 = _mm_set1_ps(m[11]);
+    const __m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]), m15 = _mm_set1_ps(m[15]);
+    const __m128 half_w = _mm_set1_ps(0.5f * s.width), half_h = _mm_set1_ps(0.5f * s.height);
+    const __m128 width = _mm_set1_ps(s.width), height = _mm_set1_ps(s.height);
+    const __m128 one = _mm_set1_ps(1.0f), half = _mm_set1_ps(0.5f), zero = _mm_setzero_ps();
+
+    for (; i + 4 <= end; i += 4)
+    {
+        // x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3 -> x, y, z
+        const float *p = xyz + (size_t)i * 3;
+        __m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4), c = _mm_loadu_ps(p + 8);
+        __m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                                  _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                                  _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+        __m128 cx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_add_ps(_mm_mul_ps(m8, z), m12));
+        __m128 cy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_add_ps(_mm_mul_ps(m9, z), m13));
+        __m128 cz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_add_ps(_mm_mul_ps(m10, z), m14));
+        __m128 cw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m3, x), _mm_mul_ps(m7, y)), _mm_add_ps(_mm_mul_ps(m11, z), m15));
+
+        // Inside the depth range: -w <= z <= w with w > 0
+        __m128 keep = _mm_and_ps(_mm_cmpgt_ps(cw, zero),
+                                 _mm_and_ps(_mm_cmpge_ps(cz, _mm_sub_ps(zero, cw)), _mm_cmple_ps(cz, cw)));
+        if (!_mm_movemask_ps(keep))
+        {
+            clipped += 4;
+            continue;
+        }
+
+        __m128 inv_w = _mm_div_ps(one, cw);
+        __m128 sx = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(cx, inv_w), one), half_w);
+        __m128 sy = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(cy, inv_w)), half_h);
+        __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(cz, inv_w), half), half);
+        keep = _mm_and_ps(keep, _mm_and_ps(
+                                    _mm_and_ps(_mm_cmpge_ps(sx, zero), _mm_cmplt_ps(sx, width)),
+                                    _mm_and_ps(_mm_cmpge_ps(sy, zero), _mm_cmplt_ps(sy, height))));
+
+        int bits = _mm_movemask_ps(keep);
+        clipped += 4 - ((bits & 1) + ((bits >> 1) & 1) + ((bits >> 2) & 1) + (bits >> 3));
+        if (!bits)
+            continue;
+
+        float fx[4], fy[4], fz[4], fw[4];
+        _mm_storeu_ps(fx, sx);
+        _mm_storeu_ps(fy, sy);
+        _mm_storeu_ps(fz, depth);
+        _mm_storeu_ps(fw, cw);
+        for (int k = 0; k < 4; k++)
+            if (bits & (1 << k))
+                emit_point(s, intensity, i + k, fx[k], fy[k], fz[k], fw[k], emit);
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        const float *p = xyz + (size_t)i * 3;
+        float cx = m[0] * p[0] + m[4] * p[1] + m[8] * p[2] + m[12];
+        float cy = m[1] * p[0] + m[5] * p[1] + m[9] * p[2] + m[13];
+        float cz = m[2] * p[0] + m[6] * p[1] + m[10] * p[2] + m[14];
+        float cw = m[3] * p[0] + m[7] * p[1] + m[11] * p[2] + m[15];
+        if (!(cw > 0.0f && cz >= -cw && cz <= cw))
+        {
+            clipped++;
+            continue;
+        }
+
+        float inv_w = 1.0f / cw;
+        float sx = (cx * inv_w + 1.0f) * 0.5f * s.width;
+        float sy = (1.0f - cy * inv_w) * 0.5f * s.height;
+        if (!(sx >= 0.0f && sx < s.width && sy >= 0.0f && sy < s.height))
+        {
+            clipped++;
+            continue;
+        }
+        emit_point(s, intensity, i, sx, sy, cz * inv_w * 0.5f + 0.5f, cw, emit);
+    }
+    return clipped;
+}
+
+// --------------------
+// Splatting
+// --------------------
+
+// Draws the part of the splat inside rows [row0, row1)
+static void draw_splat(Canvas &canvas, DepthBuffer *depth, int width, const Splat &s, int row0, int row1)
+{
+    int x0 = std::max(0, s.x), x1 = std::min(width, s.x + s.side);
+    int y0 = std::max(row0, s.y), y1 = std::min(row1, s.y + s.side);
+
+    if (!depth)
+    {
+        for (int y = y0; y < y1; y++)
+        {
+            float *crow = canvas.pixels[y];
+            for (int x = x0; x < x1; x++)
+                crow[x] += s.value;
+        }
+        return;
+    }
+
+    for (int y = y0; y < y1; y++)
+    {
+        float *crow = canvas.pixels[y];
+        float *zrow = depth->row(y);
+        for (int x = x0; x < x1; x++)
+        {
+            if (s.z < zrow[x])
+            {
+                zrow[x] = s.z;
+                crow[x] = s.value;
+            }
+        }
+    }
+}
+
+void render_points(
+    Canvas &canvas,
+    DepthBuffer *depth,
+    const float *xyz,
+    const float *point_intensity,
+    int count,
+    const mat4 &mvp,
+    const PointOptions &options,
+    PointStats *stats)
+{
+    int width = canvas.width;
+    int height = canvas.height;
+    if (depth)
+    {
+        width = std::min(width, depth->width());
+        height = std::min(height, depth->height());
+    }
+
+    PointSetup setup;
+    std::copy(mvp.m, mvp.m + 16, setup.m);
+    setup.width = (float)width;
+    setup.height = (float)height;
+    setup.intensity = options.intensity;
+    setup.size = options.size;
+    setup.size_scale = options.size_by_distance ? options.reference_distance : 0.0f;
+    setup.max_size = options.max_size;
+
+    int threads = options.threads;
+    if (threads <= 0)
+        threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, (count + 65535) / 65536));
+
+    long long clipped = 0;
+
+    if (threads == 1)
+    {
+        // No binning: splat straight from the projection loop
+        clipped = project_points(setup, xyz, point_intensity, 0, count, [&](const Splat &s) {
+            draw_splat(canvas, depth, width, s, 0, height);
+        });
+    }
+    else
+    {
+        int bands = (height + BAND_ROWS - 1) / BAND_ROWS;
+        std::vector<std::vector<std::vector<Splat>>> bins(threads, std::vector<std::vector<Splat>>(bands));
+        std::vector<long long> thread_clipped(threads, 0);
+
+        for (int chunk = 0; chunk < count; chunk += CHUNK_POINTS)
+        {
+            int chunk_end = std::min(count, chunk + CHUNK_POINTS);
+            int per_thread = (chunk_end - chunk + threads - 1) / threads;
+
+            // ---- Project and bin: thread t owns points [begin, end) ----
+            auto project = [&](int t) {
+                for (std::vector<Splat> &band : bins[t])
+                    band.clear();
+                int begin = std::min(chunk_end, chunk + t * per_thread);
+                int end = std::min(chunk_end, begin + per_thread);
+                thread_clipped[t] += project_points(setup, xyz, point_intensity, begin, end, [&](const Splat &s) {
+                    int b0 = std::max(0, s.y) / BAND_ROWS;
+                    int b1 = std::min(height - 1, s.y + s.side - 1) / BAND_ROWS;
+                    for (int b = b0; b <= b1; b++)
+                        bins[t][b].push_back(s);
+                });
+            };
+
+            // ---- Splat: each band drawn by one thread, in point order ----
+            std::atomic<int> next(0);
+            auto splat = [&]() {
+                for (int b = next++; b < bands; b = next++)
+                {
+                    int row0 = b * BAND_ROWS, row1 = std::min(height, row0 + BAND_ROWS);
+                    for (int t = 0; t < threads; t++)
+                        for (const Splat &s : bins[t][b])
+                            draw_splat(canvas, depth, width, s, row0, row1);
+                }
+            };
+
+            std::vector<std::thread> pool;
+            for (int t = 1; t < threads; t++)
+                pool.emplace_back(project, t);
+            project(0);
+            for (std::thread &th : pool)
+                th.join();
+
+            pool.clear();
+            for (int t = 1; t < threads; t++)
+                pool.emplace_back(splat);
+            splat();
+            for (std::thread &th : pool)
+                th.join();
+        }
+
+        for (long long c : thread_clipped)
+            clipped += c;
+    }
+
+    if (stats)
+    {
+        stats->points_in = count;
+        stats->points_clipped = clipped;
+        stats->points_drawn = count - clipped;
+    }
+}
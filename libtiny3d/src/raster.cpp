@@ -0,0 +1,680 @@
+#include "raster.h"
+#include "canvas.h"
+#include "mesh.h"
+#include "simd.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+static const int TILE_SIZE = 64; // multiple of the 8x8 block
+static const int BLOCK_SIZE = 8;
+
+// --------------------
+// Depth buffer
+// --------------------
+
+DepthBuffer::DepthBuffer(int width, int height)
+    : w(width),
+      h(height),
+      pitch((width + 7) & ~7),
+      blocks_x((width + 7) >> 3),
+      depth((size_t)((width + 7) & ~7) * ((height + 7) & ~7), 1.0f),
+      block_far((size_t)((width + 7) >> 3) * ((height + 7) >> 3), 1.0f)
+{
+}
+
+void DepthBuffer::clear()
+{
+    std::fill(depth.begin(), depth.end(), 1.0f);
+    std::fill(block_far.begin(), block_far.end(), 1.0f);
+}
+
+void DepthBuffer::resize(int width, int height)
+{
+    w = width;
+    h = height;
+    pitch = (width + 7) & ~7;
+    blocks_x = (width + 7) >> 3;
+    depth.assign((size_t)pitch * ((height + 7) & ~7), 1.0f);
+    block_far.assign((size_t)blocks_x * ((height + 7) >> 3), 1.0f);
+}
+
+// --------------------
+// Triangle setup
+// --------------------
+
+// Edge k is opposite vertex k: E(x, y) = a * x + b * y + c, >= 0 inside
+struct TriSetup
+{
+    float ea[3], eb[3], ec[3];
+    bool owner[3]; // shared edges: pixels exactly on the edge go to the owner
+    float za, zb, zc;
+    float sa, sb, sc;
+    float zmin;
+    int minx, miny, maxx, maxy;
+};
+
+static bool setup_triangle(const RasterVertex *v, ShadeMode mode, int width, int height, TriSetup &t)
+{
+    const RasterVertex *p[3] = {&v[0], &v[1], &v[2]};
+
+    float area = (p[1]->x - p[0]->x) * (p[2]->y - p[0]->y) - (p[1]->y - p[0]->y) * (p[2]->x - p[0]->x);
+    if (!(std::fabs(area) > 1e-12f))
+        return false;
+    if (area < 0.0f)
+    {
+        std::swap(p[1], p[2]);
+        area = -area;
+    }
+
+    for (int k = 0; k < 3; k++)
+    {
+        const RasterVertex &a = *p[(k + 1) % 3];
+        const RasterVertex &b = *p[(k + 2) % 3];
+        t.ea[k] = a.y - b.y;
+        t.eb[k] = b.x - a.x;
+        t.ec[k] = a.x * b.y - a.y * b.x;
+        t.owner[k] = t.ea[k] > 0.0f || (t.ea[k] == 0.0f && t.eb[k] < 0.0f);
+    }
+
+    // Attribute planes from the barycentric weights E_k / area
+    float inv = 1.0f / area;
+    t.za = (t.ea[0] * p[0]->z + t.ea[1] * p[1]->z + t.ea[2] * p[2]->z) * inv;
+    t.zb = (t.eb[0] * p[0]->z + t.eb[1] * p[1]->z + t.eb[2] * p[2]->z) * inv;
+    t.zc = (t.ec[0] * p[0]->z + t.ec[1] * p[1]->z + t.ec[2] * p[2]->z) * inv;
+
+    if (mode == SHADE_FLAT)
+    {
+        t.sa = 0.0f;
+        t.sb = 0.0f;
+        t.sc = v[0].shade;
+    }
+    else
+    {
+        t.sa = (t.ea[0] * p[0]->shade + t.ea[1] * p[1]->shade + t.ea[2] * p[2]->shade) * inv;
+        t.sb = (t.eb[0] * p[0]->shade + t.eb[1] * p[1]->shade + t.eb[2] * p[2]->shade) * inv;
+        t.sc = (t.ec[0] * p[0]->shade + t.ec[1] * p[1]->shade + t.ec[2] * p[2]->shade) * inv;
+    }
+
+    t.zmin = std::min(v[0].z, std::min(v[1].z, v[2].z));
+
+    // Pixels whose centre can fall inside
+    float minx = std::min(v[0].x, std::min(v[1].x, v[2].x));
+    float maxx = std::max(v[0].x, std::max(v[1].x, v[2].x));
+    float miny = std::min(v[0].y, std::min(v[1].y, v[2].y));
+    float maxy = std::max(v[0].y, std::max(v[1].y, v[2].y));
+    // (clamped as floats first: vertices near w = 0 land far off screen)
+    t.minx = (int)std::min((float)width, std::max(0.0f, std::ceil(minx - 0.5f)));
+    t.miny = (int)std::min((float)height, std::max(0.0f, std::ceil(miny - 0.5f)));
+    t.maxx = (int)std::max(-1.0f, std::min((float)(width - 1), std::floor(maxx - 0.5f)));
+    t.maxy = (int)std::max(-1.0f, std::min((float)(height - 1), std::floor(maxy - 0.5f)));
+
+    return t.minx <= t.maxx && t.miny <= t.maxy;
+}
+
+// --------------------
+// Block raster
+// --------------------
+
+struct TileCounters
+{
+    long long blocks_tested;
+    long long blocks_rejected_z;
+    long long pixels_written;
+};
+
+// Pixels [x0, x1] x [y0, y1] of the 8x8 block starting at column bx;
+// returns true if any depth was written
+static bool raster_block(
+    Canvas &canvas,
+    DepthBuffer &depth,
+    const TriSetup &t,
+    int bx,
+    int x0, int y0, int x1, int y1,
+    bool covered,
+    TileCounters &counters)
+{
+    bool wrote = false;
+
+#ifdef TINY3D_SSE2
+    const __m128 lane = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (int y = y0; y <= y1; y++)
+    {
+        float *zrow = depth.row(y);
+        float *crow = canvas.pixels[y];
+        float py = y + 0.5f;
+
+        for (int gx = bx; gx < bx + BLOCK_SIZE; gx += 4)
+        {
+            if (gx + 3 < x0 || gx > x1)
+                continue;
+
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)gx), lane);
+            __m128i xi = _mm_add_epi32(_mm_set1_epi32(gx), _mm_set_epi32(3, 2, 1, 0));
+            __m128 mask = _mm_castsi128_ps(_mm_and_si128(
+                _mm_cmpgt_epi32(xi, _mm_set1_epi32(x0 - 1)),
+                _mm_cmplt_epi32(xi, _mm_set1_epi32(x1 + 1))));
+
+            if (!covered)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    __m128 e = _mm_add_ps(
+                        _mm_mul_ps(_mm_set1_ps(t.ea[k]), px),
+                        _mm_set1_ps(t.eb[k] * py + t.ec[k]));
+                    mask = _mm_and_ps(mask, t.owner[k] ? _mm_cmpge_ps(e, zero) : _mm_cmpgt_ps(e, zero));
+                }
+            }
+            if (!_mm_movemask_ps(mask))
+                continue;
+
+            __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.za), px), _mm_set1_ps(t.zb * py + t.zc));
+            __m128 old_z = _mm_loadu_ps(zrow + gx);
+            mask = _mm_and_ps(mask, _mm_cmplt_ps(z, old_z));
+
+            int bits = _mm_movemask_ps(mask);
+            if (!bits)
+                continue;
+
+            _mm_storeu_ps(zrow + gx, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, old_z)));
+            wrote = true;
+
+            __m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.sa), px), _mm_set1_ps(t.sb * py + t.sc));
+            if (gx + 3 < canvas.width)
+            {
+                __m128 old_c = _mm_loadu_ps(crow + gx);
+                _mm_storeu_ps(crow + gx, _mm_or_ps(_mm_and_ps(mask, s), _mm_andnot_ps(mask, old_c)));
+            }
+            else
+            {
+                float shade[4];
+                _mm_storeu_ps(shade, s);
+                for (int k = 0; k < 4; k++)
+                    if (bits & (1 << k))
+                        crow[gx + k] = shade[k];
+            }
+            counters.pixels_written += (bits & 1) + ((bits >> 1) & 1) + ((bits >> 2) & 1) + (bits >> 3);
+        }
+    }
+#else
+    for (int y = y0; y <= y1; y++)
+    {
+        float *zrow = depth.row(y);
+        float *crow = canvas.pixels[y];
+        float py = y + 0.5f;
+
+        for (int x = x0; x <= x1; x++)
+        {
+            float px = x + 0.5f;
+            bool inside = true;
+            for (int k = 0; k < 3 && inside && !covered; k++)
+            {
+                float e = t.ea[k] * px + t.eb[k] * py + t.ec[k];
+                inside = t.owner[k] ? e >= 0.0f : e > 0.0f;
+            }
+            if (!inside)
+                continue;
+
+            float z = t.za * px + t.zb * py + t.zc;
+            if (!(z < zrow[x]))
+                continue;
+
+            zrow[x] = z;
+            crow[x] = t.sa * px + t.sb * py + t.sc;
+            counters.pixels_written++;
+            wrote = true;
+        }
+    }
+    (void)bx;
+#endif
+
+    return wrote;
+}
+
+static void raster_tile(
+    Canvas &canvas,
+    DepthBuffer &depth,
+    const std::vector<TriSetup> &setups,
+    const std::vector<int> &bin,
+    int tile_x, int tile_y,
+    TileCounters &counters)
+{
+    int width = std::min(canvas.width, depth.width());
+    int height = std::min(canvas.height, depth.height());
+    int tx1 = std::min(tile_x + TILE_SIZE, width) - 1;
+    int ty1 = std::min(tile_y + TILE_SIZE, height) - 1;
+
+    for (int index : bin)
+    {
+        const TriSetup &t = setups[index];
+        int x0 = std::max(t.minx, tile_x);
+        int y0 = std::max(t.miny, tile_y);
+        int x1 = std::min(t.maxx, tx1);
+        int y1 = std::min(t.maxy, ty1);
+
+        for (int by = y0 & ~(BLOCK_SIZE - 1); by <= y1; by += BLOCK_SIZE)
+        {
+            for (int bx = x0 & ~(BLOCK_SIZE - 1); bx <= x1; bx += BLOCK_SIZE)
+            {
+                counters.blocks_tested++;
+
+                float cx0 = bx + 0.5f, cx1 = bx + BLOCK_SIZE - 0.5f;
+                float cy0 = by + 0.5f, cy1 = by + BLOCK_SIZE - 0.5f;
+
+                // Trivial reject / accept from the block's corner samples
+                bool outside = false;
+                bool covered = true;
+                for (int k = 0; k < 3; k++)
+                {
+                    float hi = t.ea[k] * (t.ea[k] > 0.0f ? cx1 : cx0) + t.eb[k] * (t.eb[k] > 0.0f ? cy1 : cy0) + t.ec[k];
+                    float lo = t.ea[k] * (t.ea[k] > 0.0f ? cx0 : cx1) + t.eb[k] * (t.eb[k] > 0.0f ? cy0 : cy1) + t.ec[k];
+                    outside = outside || hi < 0.0f;
+                    covered = covered && lo > 0.0f;
+                }
+                if (outside)
+                    continue;
+
+                // Early-z: nearest point of the triangle's plane over the block
+                float znear = t.za * (t.za > 0.0f ? cx0 : cx1) + t.zb * (t.zb > 0.0f ? cy0 : cy1) + t.zc;
+                znear = std::max(znear, t.zmin);
+                float &block_far = depth.block_max_ref(bx >> 3, by >> 3);
+                if (znear >= block_far)
+                {
+                    counters.blocks_rejected_z++;
+                    continue;
+                }
+
+                int px0 = std::max(bx, x0), px1 = std::min(bx + BLOCK_SIZE - 1, x1);
+                int py0 = std::max(by, y0), py1 = std::min(by + BLOCK_SIZE - 1, y1);
+                if (!raster_block(canvas, depth, t, bx, px0, py0, px1, py1, covered, counters))
+                    continue;
+
+                // Refresh the block's far depth (padding stays at 1)
+                float far_z = 0.0f;
+                for (int y = by; y < by + BLOCK_SIZE; y++)
+                {
+                    const float *zrow = depth.row(y) + bx;
+                    for (int x = 0; x < BLOCK_SIZE; x++)
+                        far_z = std::max(far_z, zrow[x]);
+                }
+                block_far = far_z;
+            }
+        }
+    }
+}
+
+void rasterize_triangles(
+    Canvas &canvas,
+    DepthBuffer &depth,
+    const RasterVertex *vertices,
+    int tri_count,
+    ShadeMode mode,
+    int threads,
+    RasterStats *stats)
+{
+    int width = std::min(canvas.width, depth.width());
+    int height = std::min(canvas.height, depth.height());
+    int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+    int tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    // ---- Setup and binning ----
+    std::vector<TriSetup> setups;
+    std::vector<std::vector<int>> bins(tiles_x * tiles_y);
+    setups.reserve(tri_count);
+
+    long long culled = 0;
+    for (int i = 0; i < tri_count; i++)
+    {
+        TriSetup t;
+        if (!setup_triangle(vertices + i * 3, mode, width, height, t))
+        {
+            culled++;
+            continue;
+        }
+
+        int index = (int)setups.size();
+        setups.push_back(t);
+        for (int ty = t.miny / TILE_SIZE; ty <= t.maxy / TILE_SIZE; ty++)
+            for (int tx = t.minx / TILE_SIZE; tx <= t.maxx / TILE_SIZE; tx++)
+                bins[ty * tiles_x + tx].push_back(index);
+    }
+
+    std::vector<int> work;
+    for (int b = 0; b < (int)bins.size(); b++)
+        if (!bins[b].empty())
+            work.push_back(b);
+
+    // ---- Tiles in parallel; each tile keeps submission order ----
+    if (threads <= 0)
+        threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, (int)work.size()));
+
+    std::vector<TileCounters> counters(threads, TileCounters());
+    std::atomic<int> next(0);
+
+    auto worker = [&](int id) {
+        for (int i = next++; i < (int)work.size(); i = next++)
+        {
+            int b = work[i];
+            raster_tile(canvas, depth, setups, bins[b],
+                        (b % tiles_x) * TILE_SIZE, (b / tiles_x) * TILE_SIZE, counters[id]);
+        }
+    };
+
+    if (threads == 1)
+    {
+        worker(0);
+    }
+    else
+    {
+        std::vector<std::thread> pool;
+        for (int id = 1; id < threads; id++)
+            pool.emplace_back(worker, id);
+        worker(0);
+        for (std::thread &th : pool)
+            th.join();
+    }
+
+    if (stats)
+    {
+        *stats = RasterStats();
+        stats->triangles_in = tri_count;
+        stats->triangles_culled = culled;
+        stats->triangles_drawn = (long long)setups.size();
+        for (const TileCounters &c : counters)
+        {
+            stats->blocks_tested += c.blocks_tested;
+            stats->blocks_rejected_z += c.blocks_rejected_z;
+            stats->pixels_written += c.pixels_written;
+        }
+    }
+}
+
+// --------------------
+// Mesh front end
+// --------------------
+
+SolidOptions default_solid_options()
+{
+    SolidOptions o;
+    o.mode = SHADE_GOURAUD;
+    o.cull_backfaces = true;
+    o.ambient = 0.1f;
+    o.threads = 0;
+    return o;
+}
+
+struct ClipVertex
+{
+    float x, y, z, w;
+    float shade;
+};
+
+static ClipVertex lerp_clip(const ClipVertex &a, const ClipVertex &b, float t)
+{
+    return {a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t,
+            a.w + (b.w - a.w) * t, a.shade + (b.shade - a.shade) * t};
+}
+
+// Lights prepared once per call: unit direction (the cone axis for spots)
+// and spot cone cosines
+struct SolidLights
+{
+    const Light *lights;
+    int count;
+    std::vector<float> axes;
+    std::vector<float> cones;
+};
+
+// n: unit world normal at world point p
+static float light_shade(const float n[3], const float p[3], const SolidLights &l, float ambient)
+{
+    float s = ambient;
+    for (int i = 0; i < l.count; i++)
+    {
+        const Light &light = l.lights[i];
+        const float *axis = &l.axes[i * 3];
+        const float *travel = axis;
+        float power = light.intensity;
+        float to_p[3];
+        if (light.type != LIGHT_DIRECTIONAL)
+        {
+            power *= light_falloff(light, p, l.cones[i * 2], l.cones[i * 2 + 1], axis, to_p);
+            if (power <= 0.0f)
+                continue;
+            travel = to_p;
+        }
+
+        float d = -(n[0] * travel[0] + n[1] * travel[1] + n[2] * travel[2]);
+        if (d > 0.0f)
+            s += d * power;
+    }
+    return std::min(1.0f, s);
+}
+
+static void world_point(const mat4 &model, const float *p, float out[3])
+{
+    const float *m = model.m;
+    for (int k = 0; k < 3; k++)
+        out[k] = m[k] * p[0] + m[4 + k] * p[1] + m[8 + k] * p[2] + m[12 + k];
+}
+
+// Model-space normal to a unit world-space normal (upper 3x3 of model)
+static void world_normal(const mat4 &model, const float *n, float out[3])
+{
+    const float *m = model.m;
+    for (int k = 0; k < 3; k++)
+        out[k] = m[k] * n[0] + m[4 + k] * n[1] + m[8 + k] * n[2];
+
+    float len = std::sqrt(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]);
+    if (len > 0.0f)
+    {
+        out[0] /= len;
+        out[1] /= len;
+        out[2] /= len;
+    }
+}
+
+void render_mesh_solid(
+    Canvas &canvas,
+    DepthBuffer &depth,
+    const Mesh &mesh,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    const Light *lights,
+    int light_count,
+    const SolidOptions &options,
+    RasterStats *stats)
+{
+    static thread_local std::vector<float> clip;
+    static thread_local std::vector<float> face_normals;
+    static thread_local std::vector<float> vertex_shade;
+    static thread_local std::vector<RasterVertex> tris;
+
+    int vcount = mesh.vertex_count();
+    int fcount = mesh.face_count();
+    const float *xyz = mesh.position_data();
+    float width = (float)canvas.width;
+    float height = (float)canvas.height;
+
+    // ---- Lights ----
+    SolidLights lit;
+    lit.lights = lights;
+    lit.count = light_count;
+    lit.axes.resize(light_count * 3);
+    lit.cones.resize(light_count * 2);
+    for (int i = 0; i < light_count; i++)
+    {
+        const vec3_t &d = lights[i].direction;
+        float len = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+        float inv = len > 0.0f ? 1.0f / len : 0.0f;
+        lit.axes[i * 3] = d.x * inv;
+        lit.axes[i * 3 + 1] = d.y * inv;
+        lit.axes[i * 3 + 2] = d.z * inv;
+        lit.cones[i * 2] = std::cos(lights[i].spot_inner);
+        lit.cones[i * 2 + 1] = std::cos(lights[i].spot_outer);
+    }
+
+    // ---- Clip-space positions ----
+    mat4 mvp = multiply(projection, multiply(view, model));
+    const float *m = mvp.m;
+    clip.resize(vcount * 4);
+    for (int v = 0; v < vcount; v++)
+    {
+        const float *p = xyz + v * 3;
+        for (int k = 0; k < 4; k++)
+            clip[v * 4 + k] = m[k] * p[0] + m[4 + k] * p[1] + m[8 + k] * p[2] + m[12 + k];
+    }
+
+    // ---- Face normals (Newell, area weighted) and vertex shades ----
+    face_normals.assign(fcount * 3, 0.0f);
+    for (int f = 0; f < fcount; f++)
+    {
+        int n = mesh.face_size(f);
+        const int *fv = mesh.face_vertices(f);
+        float *fn = &face_normals[f * 3];
+        for (int k = 0; k < n; k++)
+        {
+            const float *p = xyz + fv[k] * 3;
+            const float *q = xyz + fv[(k + 1) % n] * 3;
+            fn[0] += (p[1] - q[1]) * (p[2] + q[2]);
+            fn[1] += (p[2] - q[2]) * (p[0] + q[0]);
+            fn[2] += (p[0] - q[0]) * (p[1] + q[1]);
+        }
+    }
+
+    if (options.mode == SHADE_GOURAUD)
+    {
+        std::vector<float> vertex_normals(vcount * 3, 0.0f);
+        for (int f = 0; f < fcount; f++)
+        {
+            const int *fv = mesh.face_vertices(f);
+            for (int k = 0; k < mesh.face_size(f); k++)
+                for (int c = 0; c < 3; c++)
+                    vertex_normals[fv[k] * 3 + c] += face_normals[f * 3 + c];
+        }
+
+        vertex_shade.resize(vcount);
+        for (int v = 0; v < vcount; v++)
+        {
+            float n[3], p[3];
+            world_normal(model, &vertex_normals[v * 3], n);
+            world_point(model, xyz + v * 3, p);
+            vertex_shade[v] = light_shade(n, p, lit, options.ambient);
+        }
+    }
+
+    // ---- Fan, near-clip, project, cull ----
+    tris.clear();
+    long long fanned = 0;
+    long long culled = 0;
+
+    auto emit = [&](const ClipVertex *c) {
+        RasterVertex r[3];
+        for (int k = 0; k < 3; k++)
+        {
+            float inv_w = 1.0f / c[k].w;
+            r[k].x = (c[k].x * inv_w + 1.0f) * 0.5f * width;
+            r[k].y = (1.0f - c[k].y * inv_w) * 0.5f * height;
+            r[k].z = c[k].z * inv_w * 0.5f + 0.5f;
+            r[k].shade = c[k].shade;
+        }
+
+        // Counter-clockwise in NDC is clockwise on the y-down screen
+        float area = (r[1].x - r[0].x) * (r[2].y - r[0].y) - (r[1].y - r[0].y) * (r[2].x - r[0].x);
+        if (options.cull_backfaces && area >= 0.0f)
+        {
+            culled++;
+            return;
+        }
+        tris.insert(tris.end(), r, r + 3);
+    };
+
+    for (int f = 0; f < fcount; f++)
+    {
+        int n = mesh.face_size(f);
+        const int *fv = mesh.face_vertices(f);
+
+        float flat = 0.0f;
+        if (options.mode == SHADE_FLAT)
+        {
+            // Point and spot lights are evaluated at the face centroid
+            float nw[3], centroid[3] = {0.0f, 0.0f, 0.0f}, p[3];
+            world_normal(model, &face_normals[f * 3], nw);
+            for (int k = 0; k < n; k++)
+                for (int c = 0; c < 3; c++)
+                    centroid[c] += xyz[fv[k] * 3 + c] / n;
+            world_point(model, centroid, p);
+            flat = light_shade(nw, p, lit, options.ambient);
+        }
+
+        for (int k = 1; k + 1 < n; k++)
+        {
+            fanned++;
+
+            ClipVertex in[3];
+            int ids[3] = {fv[0], fv[k], fv[k + 1]};
+            int behind = 0;
+            for (int i = 0; i < 3; i++)
+            {
+                const float *c = &clip[ids[i] * 4];
+                in[i] = {c[0], c[1], c[2], c[3], options.mode == SHADE_FLAT ? flat : vertex_shade[ids[i]]};
+                behind += (in[i].z + in[i].w < 0.0f);
+            }
+
+            if (behind == 0)
+            {
+                emit(in);
+                continue;
+            }
+            if (behind == 3)
+            {
+                culled++;
+                continue;
+            }
+
+            // Sutherland-Hodgman against z = -w, giving 3 or 4 vertices
+            ClipVertex out[4];
+            int count = 0;
+            for (int i = 0; i < 3; i++)
+            {
+                const ClipVertex &a = in[i];
+                const ClipVertex &b = in[(i + 1) % 3];
+                float da = a.z + a.w;
+                float db = b.z + b.w;
+                if (da >= 0.0f)
+                    out[count++] = a;
+                if ((da >= 0.0f) != (db >= 0.0f))
+                    out[count++] = lerp_clip(a, b, da / (da - db));
+            }
+
+            // Flat shading takes the first vertex's shade; keep it on every piece
+            for (int i = 0; i < count; i++)
+                if (options.mode == SHADE_FLAT)
+                    out[i].shade = flat;
+
+            emit(out);
+            if (count == 4)
+            {
+                ClipVertex second[3] = {out[0], out[2], out[3]};
+                emit(second);
+            }
+        }
+    }
+
+    RasterStats raster = RasterStats();
+    rasterize_triangles(
+        canvas, depth, tris.data(), (int)tris.size() / 3, options.mode, options.threads,
+        stats ? &raster : nullptr);
+
+    if (stats)
+    {
+        *stats = raster;
+        stats->triangles_in = fanned;
+        stats->triangles_culled += culled;
+    }
+}
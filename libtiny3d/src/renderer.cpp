@@ -1,5 +1,12 @@
 #include "renderer.h"
 #include "canvas.h"
+#include "mesh.h"
+#include "mesh_binary.h"
+#include "edge_reduce.h"
+#include "lighting.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
 
 // NOTE: multiply(mat4, vec3_t) must treat vec3 as (x,y,z,1)
 
@@ -36,6 +43,72 @@ bool clip_to_circular_viewport(
     return (dx * dx + dy * dy) <= (radius * radius);
 }
 
+#ifdef TINY3D_DEPTH_CUE
+static DepthCue depth_cue = {DEPTH_CUE_OFF, 0.0f, 1.0f, 1.0f};
+
+void set_depth_cue(const DepthCue &cue)
+{
+    depth_cue = cue;
+}
+
+const DepthCue &get_depth_cue()
+{
+    return depth_cue;
+}
+
+float depth_cue_factor(float z)
+{
+    float depth = z * 0.5f + 0.5f;
+    if (depth_cue.mode == DEPTH_CUE_LINEAR)
+    {
+        if (depth <= depth_cue.start)
+            return 1.0f;
+        if (depth >= depth_cue.end)
+            return 0.0f;
+        return (depth_cue.end - depth) / (depth_cue.end - depth_cue.start);
+    }
+    if (depth_cue.mode == DEPTH_CUE_EXP)
+        return depth <= depth_cue.start ? 1.0f : std::exp(-depth_cue.density * (depth - depth_cue.start));
+    return 1.0f;
+}
+#endif
+
+// Simple bounds check - only draw if an end point is reasonably on screen
+static void draw_edge_clipped(
+    Canvas &canvas,
+    const ScreenVertex &a,
+    const ScreenVertex &b,
+    int screen_width,
+    int screen_height,
+    float intensity = 1.0f)
+{
+    bool a_visible = (a.x >= -100 && a.x < screen_width + 100 &&
+                      a.y >= -100 && a.y < screen_height + 100);
+    bool b_visible = (b.x >= -100 && b.x < screen_width + 100 &&
+                      b.y >= -100 && b.y < screen_height + 100);
+
+    if (a_visible || b_visible)
+    {
+#ifdef TINY3D_DEPTH_CUE
+        if (depth_cue.mode != DEPTH_CUE_OFF)
+        {
+            draw_line_f_cued(
+                canvas,
+                a.x, a.y,
+                b.x, b.y,
+                intensity * depth_cue_factor(a.z),
+                intensity * depth_cue_factor(b.z), 1.0f);
+            return;
+        }
+#endif
+        draw_line_f(
+            canvas,
+            a.x, a.y,
+            b.x, b.y,
+            intensity, 1.0f);
+    }
+}
+
 // depth sorting
 struct Edge
 {
@@ -102,20 +175,542 @@ void renderer_wireframe(
     for (int i = 0; i < edge_count; ++i)
     {
         const Edge &e = edge_list[i];
+        draw_edge_clipped(canvas, e.a, e.b, screen_width, screen_height);
+    }
+}
 
-        // Simple bounds check - only draw if both points are reasonably on screen
-        bool a_visible = (e.a.x >= -100 && e.a.x < screen_width + 100 &&
-                          e.a.y >= -100 && e.a.y < screen_height + 100);
-        bool b_visible = (e.b.x >= -100 && e.b.x < screen_width + 100 &&
-                          e.b.y >= -100 && e.b.y < screen_height + 100);
+// Shared by the float and quantized position paths
+template <typename T>
+static void project_packed(
+    const T *xyz,
+    int count,
+    const mat4 &mvp,
+    int screen_width,
+    int screen_height,
+    ScreenVertex *out)
+{
+    const float *m = mvp.m;
+    float half_w = 0.5f * screen_width;
+    float half_h = 0.5f * screen_height;
 
-        if (a_visible || b_visible)
+    for (int i = 0; i < count; ++i)
+    {
+        float x = (float)xyz[i * 3 + 0];
+        float y = (float)xyz[i * 3 + 1];
+        float z = (float)xyz[i * 3 + 2];
+
+        float cx = m[0] * x + m[4] * y + m[8] * z + m[12];
+        float cy = m[1] * x + m[5] * y + m[9] * z + m[13];
+        float cz = m[2] * x + m[6] * y + m[10] * z + m[14];
+        float cw = m[3] * x + m[7] * y + m[11] * z + m[15];
+
+        // Same divide rule as multiply(mat4, vec3_t)
+        if (cw != 1.0f && cw > 0.0001f)
         {
-            draw_line_f(
-                canvas,
-                e.a.x, e.a.y,
-                e.b.x, e.b.y,
-                1.0f, 1.0f);
+            float inv_w = 1.0f / cw;
+            cx *= inv_w;
+            cy *= inv_w;
+            cz *= inv_w;
+        }
+
+        out[i].x = static_cast<int>((cx + 1.0f) * half_w);
+        out[i].y = static_cast<int>((1.0f - cy) * half_h);
+        out[i].z = cz;
+    }
+}
+
+void project_positions(
+    const float *xyz,
+    int count,
+    const mat4 &mvp,
+    int screen_width,
+    int screen_height,
+    ScreenVertex *out)
+{
+    project_packed(xyz, count, mvp, screen_width, screen_height, out);
+}
+
+void project_positions(
+    const uint16_t *xyz,
+    int count,
+    const mat4 &mvp,
+    int screen_width,
+    int screen_height,
+    ScreenVertex *out)
+{
+    project_packed(xyz, count, mvp, screen_width, screen_height, out);
+}
+
+// Sort edges back → front by midpoint depth, then draw. Edges with an end
+// at or past vertex_count are skipped: mapped files are drawn unparsed, so
+// this is where their indices get checked.
+template <typename Index>
+static void draw_sorted_edges(
+    Canvas &canvas,
+    const ScreenVertex *projected,
+    int vertex_count,
+    const Index *pairs,
+    int edge_count,
+    int screen_width,
+    int screen_height,
+    const float *intensity = nullptr)
+{
+    static thread_local std::vector<std::pair<float, int>> order;
+
+    order.clear();
+    for (int i = 0; i < edge_count; ++i)
+    {
+        unsigned long long a = (unsigned long long)pairs[i * 2];
+        unsigned long long b = (unsigned long long)pairs[i * 2 + 1];
+        if (a >= (unsigned long long)vertex_count || b >= (unsigned long long)vertex_count)
+            continue;
+        order.push_back(std::make_pair((projected[a].z + projected[b].z) * 0.5f, i));
+    }
+    std::sort(order.begin(), order.end(),
+              [](const std::pair<float, int> &a, const std::pair<float, int> &b)
+              { return a.first > b.first; });
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        int e = order[i].second;
+        draw_edge_clipped(
+            canvas,
+            projected[pairs[e * 2]], projected[pairs[e * 2 + 1]],
+            screen_width, screen_height,
+            intensity ? intensity[e] : 1.0f);
+    }
+}
+
+void renderer_wireframe_packed(
+    Canvas &canvas,
+    const float *xyz,
+    int vertex_count,
+    const uint32_t *edges,
+    int edge_count,
+    const mat4 &mvp,
+    int screen_width,
+    int screen_height)
+{
+    static thread_local std::vector<ScreenVertex> projected;
+
+    projected.resize(vertex_count);
+    project_positions(xyz, vertex_count, mvp, screen_width, screen_height, projected.data());
+
+    draw_sorted_edges(canvas, projected.data(), vertex_count, edges, edge_count, screen_width, screen_height);
+}
+
+void renderer_wireframe(
+    Canvas &canvas,
+    const Mesh &mesh,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height)
+{
+    static thread_local std::vector<ScreenVertex> projected;
+
+    mat4 mvp = multiply(projection, multiply(view, model));
+
+    projected.resize(mesh.vertex_count());
+    project_positions(
+        mesh.position_data(), mesh.vertex_count(), mvp,
+        screen_width, screen_height, projected.data());
+
+    draw_sorted_edges(
+        canvas, projected.data(), mesh.vertex_count(), &mesh.edge_data()[0][0], mesh.edge_count(),
+        screen_width, screen_height);
+}
+
+void renderer_wireframe_reduced(
+    Canvas &canvas,
+    const Mesh &mesh,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height,
+    float max_deviation,
+    EdgeReduceStats *stats)
+{
+    static thread_local std::vector<ScreenVertex> projected;
+    static thread_local std::vector<ScreenSegment> segments;
+    static thread_local std::vector<std::pair<float, int>> order;
+
+    mat4 mvp = multiply(projection, multiply(view, model));
+
+    projected.resize(mesh.vertex_count());
+    project_positions(
+        mesh.position_data(), mesh.vertex_count(), mvp,
+        screen_width, screen_height, projected.data());
+
+    int count = reduce_screen_edges(
+        projected.data(), mesh.vertex_count(), &mesh.edge_data()[0][0], mesh.edge_count(),
+        screen_width, screen_height, max_deviation, segments, stats);
+
+    order.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        order[i].first = (segments[i].a.z + segments[i].b.z) * 0.5f;
+        order[i].second = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [](const std::pair<float, int> &a, const std::pair<float, int> &b)
+              { return a.first > b.first; });
+
+    for (int i = 0; i < count; ++i)
+    {
+        const ScreenSegment &seg = segments[order[i].second];
+        draw_edge_clipped(canvas, seg.a, seg.b, screen_width, screen_height);
+    }
+}
+
+void renderer_wireframe(
+    Canvas &canvas,
+    const MeshView &mesh,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height)
+{
+    static thread_local std::vector<ScreenVertex> projected;
+
+    // Dequantization folds into the MVP, so stored positions project directly
+    mat4 mvp = multiply(projection, multiply(view, multiply(model, mesh.dequantize_matrix())));
+
+    projected.resize(mesh.vertex_count());
+    if (mesh.quantized())
+        project_positions(
+            static_cast<const uint16_t *>(mesh.position_data()), mesh.vertex_count(), mvp,
+            screen_width, screen_height, projected.data());
+    else
+        project_positions(
+            static_cast<const float *>(mesh.position_data()), mesh.vertex_count(), mvp,
+            screen_width, screen_height, projected.data());
+
+    if (mesh.index16())
+        draw_sorted_edges(
+            canvas, projected.data(), mesh.vertex_count(), static_cast<const uint16_t *>(mesh.edge_data()),
+            mesh.edge_count(), screen_width, screen_height);
+    else
+        draw_sorted_edges(
+            canvas, projected.data(), mesh.vertex_count(), static_cast<const uint32_t *>(mesh.edge_data()),
+            mesh.edge_count(), screen_width, screen_height);
+}
+
+// --------------------
+// Lit wireframe
+// --------------------
+
+EdgeLightCache::EdgeLightCache() : generation(0), valid(false), updates(0), model() {}
+
+void EdgeLightCache::invalidate()
+{
+    valid = false;
+}
+
+// Everything about a light that affects edge intensity
+static const int LIGHT_KEY_SIZE = 11;
+
+static void light_key_of(const Light &l, float *key)
+{
+    key[0] = l.direction.x;
+    key[1] = l.direction.y;
+    key[2] = l.direction.z;
+    key[3] = l.intensity;
+    key[4] = (float)l.type;
+    key[5] = l.position.x;
+    key[6] = l.position.y;
+    key[7] = l.position.z;
+    key[8] = l.range;
+    key[9] = l.spot_inner;
+    key[10] = l.spot_outer;
+}
+
+bool EdgeLightCache::update(const Mesh &m, const mat4 &model_matrix, const Light *lights, int light_count)
+{
+    // Key: mesh build generation (changes on every rebuild), model matrix,
+    // every light parameter
+    float key[LIGHT_KEY_SIZE];
+    bool same = valid && generation == m.generation() && (int)light_key.size() == light_count * LIGHT_KEY_SIZE;
+    for (int k = 0; same && k < 16; k++)
+        same = model.m[k] == model_matrix.m[k];
+    for (int i = 0; same && i < light_count; i++)
+    {
+        light_key_of(lights[i], key);
+        for (int k = 0; same && k < LIGHT_KEY_SIZE; k++)
+            same = light_key[i * LIGHT_KEY_SIZE + k] == key[k];
+    }
+    if (same)
+        return false;
+
+    generation = m.generation();
+    int vertex_count = m.vertex_count();
+    int edge_count = m.edge_count();
+    model = model_matrix;
+    light_key.resize(light_count * LIGHT_KEY_SIZE);
+    bool local = false;
+    for (int i = 0; i < light_count; i++)
+    {
+        light_key_of(lights[i], &light_key[i * LIGHT_KEY_SIZE]);
+        local = local || lights[i].type != LIGHT_DIRECTIONAL;
+    }
+
+    // World-space positions, then every edge against every light in one batch
+    static thread_local std::vector<float> world;
+    const float *xyz = m.position_data();
+    const float *a = model_matrix.m;
+    world.resize(vertex_count * 3);
+    for (int v = 0; v < vertex_count; v++)
+    {
+        const float *p = xyz + v * 3;
+        for (int k = 0; k < 3; k++)
+            world[v * 3 + k] = a[k] * p[0] + a[4 + k] * p[1] + a[8 + k] * p[2] + a[12 + k];
+    }
+
+    values.resize(edge_count);
+    const uint32_t *pairs = reinterpret_cast<const uint32_t *>(m.edge_data());
+    if (local)
+    {
+        // Point and spot lights: each edge only sees the lights binned near it
+        static thread_local LightGrid grid;
+        grid.build(lights, light_count);
+        grid.shade_edges(world.data(), pairs, edge_count, values.data());
+    }
+    else
+    {
+        static thread_local LightBatch batch;
+        batch.assign(lights, light_count);
+        lambert_edges_indexed(world.data(), pairs, edge_count, batch, values.data());
+    }
+
+    valid = true;
+    updates++;
+    return true;
+}
+
+void renderer_wireframe_lit(
+    Canvas &canvas,
+    const Mesh &mesh,
+    EdgeLightCache &cache,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    const Light *lights,
+    int light_count,
+    int screen_width,
+    int screen_height)
+{
+    static thread_local std::vector<ScreenVertex> projected;
+
+    cache.update(mesh, model, lights, light_count);
+
+    mat4 mvp = multiply(projection, multiply(view, model));
+
+    projected.resize(mesh.vertex_count());
+    project_positions(
+        mesh.position_data(), mesh.vertex_count(), mvp,
+        screen_width, screen_height, projected.data());
+
+    draw_sorted_edges(
+        canvas, projected.data(), mesh.vertex_count(), &mesh.edge_data()[0][0], mesh.edge_count(),
+        screen_width, screen_height, cache.intensities());
+}
+
+// --------------------
+// Bezier curves
+// --------------------
+
+struct Homogeneous
+{
+    float x, y, z, w;
+};
+
+struct CurveFlattener
+{
+    float half_w, half_h;
+    float width, height;
+    float tolerance_sq;
+    std::vector<float> *xy;
+    std::vector<int> *offsets;
+    bool open;
+
+    void to_screen(const Homogeneous &h, float &sx, float &sy) const
+    {
+        float inv_w = 1.0f / h.w;
+        sx = (h.x * inv_w + 1.0f) * half_w;
+        sy = (1.0f - h.y * inv_w) * half_h;
+    }
+
+    void line_to(float x0, float y0, float x1, float y1)
+    {
+        if (!open)
+        {
+            offsets->push_back((int)xy->size() / 2);
+            xy->push_back(x0);
+            xy->push_back(y0);
+            open = true;
         }
+        xy->push_back(x1);
+        xy->push_back(y1);
+    }
+
+    void split(const Homogeneous c[4], int depth);
+};
+
+static const int MAX_CURVE_DEPTH = 16;
+
+static Homogeneous mid(const Homogeneous &a, const Homogeneous &b)
+{
+    return {(a.x + b.x) * 0.5f, (a.y + b.y) * 0.5f, (a.z + b.z) * 0.5f, (a.w + b.w) * 0.5f};
+}
+
+// Squared distance from p to the segment a-b
+static float distance_sq(float px, float py, float ax, float ay, float bx, float by)
+{
+    float dx = bx - ax, dy = by - ay;
+    float len_sq = dx * dx + dy * dy;
+    float t = len_sq > 0.0f ? ((px - ax) * dx + (py - ay) * dy) / len_sq : 0.0f;
+    t = std::max(0.0f, std::min(1.0f, t));
+    float ex = ax + t * dx - px, ey = ay + t * dy - py;
+    return ex * ex + ey * ey;
+}
+
+void CurveFlattener::split(const Homogeneous c[4], int depth)
+{
+    int in_front = 0;
+    for (int k = 0; k < 4; k++)
+        in_front += (c[k].z + c[k].w >= 0.0f);
+
+    // Convex hull property: all control points behind means the whole piece is
+    if (in_front == 0)
+    {
+        open = false;
+        return;
+    }
+
+    bool subdivide = depth < MAX_CURVE_DEPTH;
+    if (in_front == 4)
+    {
+        float sx[4], sy[4];
+        for (int k = 0; k < 4; k++)
+            to_screen(c[k], sx[k], sy[k]);
+
+        float lo_x = std::min(std::min(sx[0], sx[1]), std::min(sx[2], sx[3]));
+        float hi_x = std::max(std::max(sx[0], sx[1]), std::max(sx[2], sx[3]));
+        float lo_y = std::min(std::min(sy[0], sy[1]), std::min(sy[2], sy[3]));
+        float hi_y = std::max(std::max(sy[0], sy[1]), std::max(sy[2], sy[3]));
+        if (hi_x < 0.0f || hi_y < 0.0f || lo_x > width || lo_y > height)
+        {
+            open = false;
+            return;
+        }
+
+        bool flat = distance_sq(sx[1], sy[1], sx[0], sy[0], sx[3], sy[3]) <= tolerance_sq &&
+                    distance_sq(sx[2], sy[2], sx[0], sy[0], sx[3], sy[3]) <= tolerance_sq;
+        if (flat || !subdivide)
+        {
+            line_to(sx[0], sy[0], sx[3], sy[3]);
+            return;
+        }
+    }
+    else if (!subdivide)
+    {
+        // Straddles the near plane at the depth limit: keep only a chord in front
+        if (c[0].z + c[0].w >= 0.0f && c[3].z + c[3].w >= 0.0f)
+        {
+            float x0, y0, x1, y1;
+            to_screen(c[0], x0, y0);
+            to_screen(c[3], x1, y1);
+            line_to(x0, y0, x1, y1);
+        }
+        else
+        {
+            open = false;
+        }
+        return;
+    }
+
+    // de Casteljau at t = 0.5
+    Homogeneous ab = mid(c[0], c[1]), bc = mid(c[1], c[2]), cd = mid(c[2], c[3]);
+    Homogeneous abc = mid(ab, bc), bcd = mid(bc, cd);
+    Homogeneous m = mid(abc, bcd);
+    Homogeneous left[4] = {c[0], ab, abc, m};
+    Homogeneous right[4] = {m, bcd, cd, c[3]};
+    split(left, depth + 1);
+    split(right, depth + 1);
+}
+
+void flatten_bezier(
+    const vec3_t &p0,
+    const vec3_t &p1,
+    const vec3_t &p2,
+    const vec3_t &p3,
+    const mat4 &mvp,
+    int screen_width,
+    int screen_height,
+    float tolerance,
+    std::vector<float> &xy,
+    std::vector<int> &offsets)
+{
+    xy.clear();
+    offsets.clear();
+
+    const vec3_t *p[4] = {&p0, &p1, &p2, &p3};
+    const float *m = mvp.m;
+    Homogeneous c[4];
+    for (int k = 0; k < 4; k++)
+    {
+        const vec3_t &v = *p[k];
+        c[k] = {m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12],
+                m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13],
+                m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14],
+                m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15]};
+    }
+
+    CurveFlattener f;
+    f.half_w = 0.5f * screen_width;
+    f.half_h = 0.5f * screen_height;
+    f.width = (float)screen_width;
+    f.height = (float)screen_height;
+    tolerance = std::max(tolerance, 0.01f);
+    f.tolerance_sq = tolerance * tolerance;
+    f.xy = &xy;
+    f.offsets = &offsets;
+    f.open = false;
+    f.split(c, 0);
+
+    offsets.push_back((int)xy.size() / 2);
+}
+
+int renderer_bezier(
+    Canvas &canvas,
+    const vec3_t &p0,
+    const vec3_t &p1,
+    const vec3_t &p2,
+    const vec3_t &p3,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height,
+    float tolerance,
+    float intensity)
+{
+    static thread_local std::vector<float> xy;
+    static thread_local std::vector<int> offsets;
+
+    mat4 mvp = multiply(projection, multiply(view, model));
+    flatten_bezier(p0, p1, p2, p3, mvp, screen_width, screen_height, tolerance, xy, offsets);
+
+    int segments = 0;
+    for (size_t s = 0; s + 1 < offsets.size(); s++)
+    {
+        int first = offsets[s];
+        int count = offsets[s + 1] - first;
+        draw_polyline_f(canvas, &xy[first * 2], count, intensity, 1.0f);
+        segments += count - 1;
     }
+    return segments;
 }
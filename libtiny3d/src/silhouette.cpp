@@ -0,0 +1,247 @@
+#include "silhouette.h"
+#include "mesh.h"
+#include "renderer.h"
+#include "simd.h"
+
+SilhouetteExtractor::SilhouetteExtractor() : mesh(nullptr), primed(false), last() {}
+
+void SilhouetteExtractor::detach()
+{
+    mesh = nullptr;
+    primed = false;
+    nx.clear();
+    ny.clear();
+    nz.clear();
+    d.clear();
+    facing.clear();
+    face_edge_offsets.clear();
+    face_edge_list.clear();
+    visible.clear();
+    visible_at.clear();
+    outline.clear();
+    outline_at.clear();
+    last = SilhouetteStats();
+}
+
+bool SilhouetteExtractor::attach(const Mesh &m)
+{
+    detach();
+    if (m.face_count() == 0 || !m.has_edge_faces())
+        return false;
+
+    mesh = &m;
+    int faces = m.face_count();
+    int padded = (faces + 3) & ~3;
+    const float *xyz = m.position_data();
+
+    // Padding faces have a zero normal and d < 0, so they always face away
+    nx.assign(padded, 0.0f);
+    ny.assign(padded, 0.0f);
+    nz.assign(padded, 0.0f);
+    d.assign(padded, -1.0f);
+    facing.assign(padded, 0);
+
+    face_edge_offsets.assign(1, 0);
+    for (int f = 0; f < faces; f++)
+    {
+        int n = m.face_size(f);
+        const int *fv = m.face_vertices(f);
+
+        // Newell normal and centroid, robust for non-planar polygons
+        float a = 0.0f, b = 0.0f, c = 0.0f;
+        float cx = 0.0f, cy = 0.0f, cz = 0.0f;
+        for (int k = 0; k < n; k++)
+        {
+            const float *p = xyz + fv[k] * 3;
+            const float *q = xyz + fv[(k + 1) % n] * 3;
+            a += (p[1] - q[1]) * (p[2] + q[2]);
+            b += (p[2] - q[2]) * (p[0] + q[0]);
+            c += (p[0] - q[0]) * (p[1] + q[1]);
+            cx += p[0];
+            cy += p[1];
+            cz += p[2];
+
+            // Face -> edge, through the vertex's incident edges
+            const int *ve = m.vertex_edges(fv[k]);
+            for (int i = 0; i < m.vertex_degree(fv[k]); i++)
+            {
+                const int *pair = m.edge_data()[ve[i]];
+                if (pair[0] + pair[1] - fv[k] == fv[(k + 1) % n])
+                {
+                    face_edge_list.push_back(ve[i]);
+                    break;
+                }
+            }
+        }
+        face_edge_offsets.push_back((int)face_edge_list.size());
+
+        nx[f] = a;
+        ny[f] = b;
+        nz[f] = c;
+        d[f] = -(a * cx + b * cy + c * cz) / n;
+    }
+
+    int edges = m.edge_count();
+    visible_at.assign(edges, -1);
+    outline_at.assign(edges, -1);
+    return true;
+}
+
+void SilhouetteExtractor::list_set(std::vector<int> &list, std::vector<int> &where, int e, bool on)
+{
+    if (on == (where[e] >= 0))
+        return;
+
+    if (on)
+    {
+        where[e] = (int)list.size();
+        list.push_back(e);
+        return;
+    }
+
+    // Swap-remove
+    int slot = where[e];
+    int moved = list.back();
+    list[slot] = moved;
+    where[moved] = slot;
+    list.pop_back();
+    where[e] = -1;
+}
+
+void SilhouetteExtractor::set_edge(int e)
+{
+    const int *f = mesh->edge_faces(e);
+    bool front0 = f[0] >= 0 && facing[f[0]];
+    bool front1 = f[1] >= 0 && facing[f[1]];
+
+    bool shown;
+    bool edge_of_outline;
+    if (f[0] < 0 && f[1] < 0)
+    {
+        // Loose wire edge: no facing to go by
+        shown = true;
+        edge_of_outline = false;
+    }
+    else if (f[0] < 0 || f[1] < 0)
+    {
+        // Open boundary of a front face
+        shown = front0 || front1;
+        edge_of_outline = shown;
+    }
+    else
+    {
+        shown = front0 || front1;
+        edge_of_outline = front0 != front1;
+    }
+
+    list_set(visible, visible_at, e, shown);
+    list_set(outline, outline_at, e, edge_of_outline);
+}
+
+void SilhouetteExtractor::update(const float eye_local[3])
+{
+    if (!mesh)
+        return;
+
+    changed.clear();
+    int padded = (int)facing.size();
+    int i = 0;
+
+#ifdef TINY3D_SSE2
+    __m128 ex = _mm_set1_ps(eye_local[0]);
+    __m128 ey = _mm_set1_ps(eye_local[1]);
+    __m128 ez = _mm_set1_ps(eye_local[2]);
+    __m128 zero = _mm_setzero_ps();
+
+    for (; i < padded; i += 4)
+    {
+        __m128 s = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&nx[i]), ex), _mm_mul_ps(_mm_loadu_ps(&ny[i]), ey)),
+            _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&nz[i]), ez), _mm_loadu_ps(&d[i])));
+        int now = _mm_movemask_ps(_mm_cmpgt_ps(s, zero));
+
+        int before = (facing[i] & 1) | (facing[i + 1] & 2) | (facing[i + 2] & 4) | (facing[i + 3] & 8);
+        int flips = now ^ before;
+        if (!flips)
+            continue;
+
+        for (int k = 0; k < 4; k++)
+        {
+            if (flips & (1 << k))
+            {
+                facing[i + k] = (now & (1 << k)) ? 0xff : 0;
+                changed.push_back(i + k);
+            }
+        }
+    }
+#endif
+
+    for (; i < padded; i++)
+    {
+        uint8_t now = (nx[i] * eye_local[0] + ny[i] * eye_local[1] + nz[i] * eye_local[2] + d[i] > 0.0f) ? 0xff : 0;
+        if (now != facing[i])
+        {
+            facing[i] = now;
+            changed.push_back(i);
+        }
+    }
+
+    for (int f : changed)
+        last.faces_front += facing[f] ? 1 : -1;
+    last.faces_changed = (int)changed.size();
+
+    if (!primed)
+    {
+        // First frame: every edge needs a state, including faceless ones
+        for (int e = 0; e < mesh->edge_count(); e++)
+            set_edge(e);
+        primed = true;
+    }
+    else
+    {
+        for (int f : changed)
+            for (int k = face_edge_offsets[f]; k < face_edge_offsets[f + 1]; k++)
+                set_edge(face_edge_list[k]);
+    }
+
+    last.edges_visible = (int)visible.size();
+    last.silhouette_edges = (int)outline.size();
+}
+
+void SilhouetteExtractor::update(const mat4 &model, const mat4 &view)
+{
+    mat4 inv;
+    if (!invert(multiply(view, model), inv))
+        return;
+
+    float eye[3] = {inv.m[12], inv.m[13], inv.m[14]};
+    update(eye);
+}
+
+void renderer_wireframe_visible(
+    Canvas &canvas,
+    const Mesh &mesh,
+    SilhouetteExtractor &extractor,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height)
+{
+    static thread_local std::vector<uint32_t> pairs;
+
+    extractor.update(model, view);
+
+    const std::vector<int> &edges = extractor.visible_edges();
+    pairs.resize(edges.size() * 2);
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        pairs[i * 2] = (uint32_t)mesh.edge_data()[edges[i]][0];
+        pairs[i * 2 + 1] = (uint32_t)mesh.edge_data()[edges[i]][1];
+    }
+
+    mat4 mvp = multiply(projection, multiply(view, model));
+    renderer_wireframe_packed(
+        canvas, mesh.position_data(), mesh.vertex_count(), pairs.data(), (int)edges.size(),
+        mvp, screen_width, screen_height);
+}
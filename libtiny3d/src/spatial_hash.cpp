@@ -0,0 +1,189 @@
+#include "spatial_hash.h"
+#include "mesh.h"
+#include <cmath>
+
+SpatialHashGrid::SpatialHashGrid() : inv_cell(1.0f), bucket_mask(0)
+{
+    bucket_offsets.assign(2, 0);
+}
+
+void SpatialHashGrid::cell_of(float x, float y, float z, int &cx, int &cy, int &cz) const
+{
+    // Clamp so huge coordinates or tiny cells cannot overflow int
+    const float LIMIT = 1.0e9f;
+    float fx = std::floor(x * inv_cell);
+    float fy = std::floor(y * inv_cell);
+    float fz = std::floor(z * inv_cell);
+    cx = (int)(fx < -LIMIT ? -LIMIT : (fx > LIMIT ? LIMIT : fx));
+    cy = (int)(fy < -LIMIT ? -LIMIT : (fy > LIMIT ? LIMIT : fy));
+    cz = (int)(fz < -LIMIT ? -LIMIT : (fz > LIMIT ? LIMIT : fz));
+}
+
+int SpatialHashGrid::bucket_of(int cx, int cy, int cz) const
+{
+    unsigned int h =
+        (unsigned int)cx * 73856093u ^
+        (unsigned int)cy * 19349663u ^
+        (unsigned int)cz * 83492791u;
+    return (int)(h & (unsigned int)bucket_mask);
+}
+
+void SpatialHashGrid::build(const float *xyz, int count, float cell_size)
+{
+    inv_cell = cell_size > 0.0f ? 1.0f / cell_size : 1.0f;
+
+    // Power-of-two table, about two buckets per point
+    int bucket_count = 1;
+    while (bucket_count < count * 2)
+        bucket_count <<= 1;
+    bucket_mask = bucket_count - 1;
+
+    cells.resize(count * 3);
+    std::vector<int> point_bucket(count);
+
+    bucket_offsets.assign(bucket_count + 1, 0);
+    for (int i = 0; i < count; i++)
+    {
+        cell_of(xyz[i * 3], xyz[i * 3 + 1], xyz[i * 3 + 2], cells[i * 3], cells[i * 3 + 1], cells[i * 3 + 2]);
+        point_bucket[i] = bucket_of(cells[i * 3], cells[i * 3 + 1], cells[i * 3 + 2]);
+        bucket_offsets[point_bucket[i] + 1]++;
+    }
+
+    for (int b = 0; b < bucket_count; b++)
+        bucket_offsets[b + 1] += bucket_offsets[b];
+
+    sorted_points.resize(count);
+    std::vector<int> cursor(bucket_offsets.begin(), bucket_offsets.end() - 1);
+    for (int i = 0; i < count; i++)
+        sorted_points[cursor[point_bucket[i]]++] = i;
+}
+
+int weld_vertices(
+    const float *xyz,
+    int count,
+    float epsilon,
+    std::vector<float> &out_xyz,
+    std::vector<int> &remap)
+{
+    SpatialHashGrid grid;
+    grid.build(xyz, count, epsilon);
+
+    float eps2 = epsilon * epsilon;
+    out_xyz.clear();
+    remap.assign(count, -1);
+
+    int welded = 0;
+    for (int i = 0; i < count; i++)
+    {
+        float x = xyz[i * 3];
+        float y = xyz[i * 3 + 1];
+        float z = xyz[i * 3 + 2];
+
+        // Nearest earlier representative within epsilon
+        int best = -1;
+        float best_d2 = eps2;
+        grid.for_each_near(x, y, z, [&](int j) {
+            if (j >= i || remap[j] < 0)
+                return;
+            const float *q = &out_xyz[remap[j] * 3];
+            float dx = q[0] - x;
+            float dy = q[1] - y;
+            float dz = q[2] - z;
+            float d2 = dx * dx + dy * dy + dz * dz;
+            if (d2 <= best_d2)
+            {
+                best_d2 = d2;
+                best = remap[j];
+            }
+        });
+
+        if (best >= 0)
+        {
+            remap[i] = best;
+        }
+        else
+        {
+            remap[i] = welded++;
+            out_xyz.push_back(x);
+            out_xyz.push_back(y);
+            out_xyz.push_back(z);
+        }
+    }
+
+    return welded;
+}
+
+void connect_points_within(
+    const float *xyz,
+    int count,
+    float max_distance,
+    std::vector<int> &out_edges)
+{
+    SpatialHashGrid grid;
+    grid.build(xyz, count, max_distance);
+
+    float r2 = max_distance * max_distance;
+
+    for (int i = 0; i < count; i++)
+    {
+        float x = xyz[i * 3];
+        float y = xyz[i * 3 + 1];
+        float z = xyz[i * 3 + 2];
+
+        grid.for_each_near(x, y, z, [&](int j) {
+            if (j <= i)
+                return;
+            float dx = xyz[j * 3] - x;
+            float dy = xyz[j * 3 + 1] - y;
+            float dz = xyz[j * 3 + 2] - z;
+            if (dx * dx + dy * dy + dz * dz < r2)
+            {
+                out_edges.push_back(i);
+                out_edges.push_back(j);
+            }
+        });
+    }
+}
+
+bool weld_mesh(const Mesh &in, float epsilon, Mesh &out)
+{
+    std::vector<float> xyz;
+    std::vector<int> remap;
+    int welded = weld_vertices(in.position_data(), in.vertex_count(), epsilon, xyz, remap);
+
+    std::vector<int> edges(in.edge_count() * 2);
+    for (int e = 0; e < in.edge_count(); e++)
+    {
+        edges[e * 2] = remap[in.edge_data()[e][0]];
+        edges[e * 2 + 1] = remap[in.edge_data()[e][1]];
+    }
+
+    // Drop vertices that collapsed inside a face; discard faces left with < 3
+    std::vector<int> sizes;
+    std::vector<int> indices;
+    for (int f = 0; f < in.face_count(); f++)
+    {
+        const int *fv = in.face_vertices(f);
+        int n = in.face_size(f);
+        int start = (int)indices.size();
+        for (int k = 0; k < n; k++)
+        {
+            int v = remap[fv[k]];
+            if (indices.size() > (size_t)start && indices.back() == v)
+                continue;
+            indices.push_back(v);
+        }
+        if ((int)indices.size() - start > 1 && indices.back() == indices[start])
+            indices.pop_back();
+
+        if ((int)indices.size() - start >= 3)
+            sizes.push_back((int)indices.size() - start);
+        else
+            indices.resize(start);
+    }
+
+    return out.build(
+        xyz.data(), welded,
+        reinterpret_cast<const int(*)[2]>(edges.data()), in.edge_count(),
+        sizes.data(), (int)sizes.size(), indices.data());
+}
@@ -0,0 +1,181 @@
+#include "strips.h"
+#include "canvas.h"
+#include "mesh.h"
+#include "renderer.h"
+
+// Same margin the per-edge renderer uses before drawing a segment
+static const int DRAW_MARGIN = 100;
+
+void build_polyline_strips(const int *pairs, int edge_count, int vertex_count, PolylineStrips &out)
+{
+    out.offsets.assign(1, 0);
+    out.vertices.clear();
+    if (edge_count == 0)
+        return;
+
+    // Odd vertices get a virtual edge to a hub vertex (index vertex_count);
+    // an Euler circuit through the hub splits into the minimal path set
+    int hub = vertex_count;
+    std::vector<int> degree(vertex_count + 1, 0);
+    for (int e = 0; e < edge_count * 2; e++)
+        degree[pairs[e]]++;
+
+    std::vector<int> ends(pairs, pairs + edge_count * 2);
+    for (int v = 0; v < vertex_count; v++)
+    {
+        if (degree[v] & 1)
+        {
+            ends.push_back(hub);
+            ends.push_back(v);
+        }
+    }
+    int total = (int)ends.size() / 2;
+
+    std::vector<int> offsets(vertex_count + 2, 0);
+    for (int e = 0; e < total * 2; e++)
+        offsets[ends[e] + 1]++;
+    for (int v = 0; v <= vertex_count; v++)
+        offsets[v + 1] += offsets[v];
+
+    std::vector<int> incident(total * 2);
+    std::vector<int> next(offsets.begin(), offsets.end() - 1);
+    for (int e = 0; e < total; e++)
+    {
+        incident[next[ends[e * 2]]++] = e;
+        incident[next[ends[e * 2 + 1]]++] = e;
+    }
+    next.assign(offsets.begin(), offsets.end() - 1);
+
+    std::vector<char> used(total, 0);
+    std::vector<int> stack;
+    std::vector<int> circuit;
+
+    auto flush = [&]() {
+        if (out.vertices.size() - out.offsets.back() >= 2)
+            out.offsets.push_back((int)out.vertices.size());
+        else
+            out.vertices.resize(out.offsets.back());
+    };
+
+    // Iterative Hierholzer from start; the circuit comes out reversed,
+    // which is still a valid walk
+    auto trace = [&](int start) {
+        stack.assign(1, start);
+        circuit.clear();
+        while (!stack.empty())
+        {
+            int v = stack.back();
+            while (next[v] < offsets[v + 1] && used[incident[next[v]]])
+                next[v]++;
+
+            if (next[v] == offsets[v + 1])
+            {
+                circuit.push_back(v);
+                stack.pop_back();
+                continue;
+            }
+
+            int e = incident[next[v]++];
+            used[e] = 1;
+            stack.push_back(ends[e * 2] == v ? ends[e * 2 + 1] : ends[e * 2]);
+        }
+
+        for (int v : circuit)
+        {
+            if (v == hub)
+                flush();
+            else
+                out.vertices.push_back(v);
+        }
+        flush();
+    };
+
+    if (total > edge_count)
+        trace(hub);
+
+    for (int v = 0; v < vertex_count; v++)
+        if (next[v] < offsets[v + 1])
+            trace(v);
+}
+
+void build_polyline_strips(const Mesh &mesh, PolylineStrips &out)
+{
+    build_polyline_strips(&mesh.edge_data()[0][0], mesh.edge_count(), mesh.vertex_count(), out);
+}
+
+static bool in_margin(const ScreenVertex &v, int screen_width, int screen_height)
+{
+    return v.x >= -DRAW_MARGIN && v.x < screen_width + DRAW_MARGIN &&
+           v.y >= -DRAW_MARGIN && v.y < screen_height + DRAW_MARGIN;
+}
+
+void renderer_wireframe_strips(
+    Canvas &canvas,
+    const Mesh &mesh,
+    const PolylineStrips &strips,
+    const mat4 &model,
+    const mat4 &view,
+    const mat4 &projection,
+    int screen_width,
+    int screen_height)
+{
+    static thread_local std::vector<ScreenVertex> projected;
+    static thread_local std::vector<float> run;
+#ifdef TINY3D_DEPTH_CUE
+    static thread_local std::vector<float> cue; // per run point
+    bool cued = get_depth_cue().mode != DEPTH_CUE_OFF;
+    auto flush = [&]() {
+        if (cued)
+            draw_polyline_f_cued(canvas, run.data(), cue.data(), (int)run.size() / 2, 1.0f);
+        else
+            draw_polyline_f(canvas, run.data(), (int)run.size() / 2, 1.0f, 1.0f);
+        run.clear();
+        cue.clear();
+    };
+#else
+    auto flush = [&]() {
+        draw_polyline_f(canvas, run.data(), (int)run.size() / 2, 1.0f, 1.0f);
+        run.clear();
+    };
+#endif
+
+    mat4 mvp = multiply(projection, multiply(view, model));
+
+    projected.resize(mesh.vertex_count());
+    project_positions(
+        mesh.position_data(), mesh.vertex_count(), mvp,
+        screen_width, screen_height, projected.data());
+
+    for (int s = 0; s < strips.strip_count(); s++)
+    {
+        const int *ids = strips.strip(s);
+        int size = strips.strip_size(s);
+
+        // Split the strip where a segment is skipped by the margin check
+        for (int i = 0; i + 1 < size; i++)
+        {
+            const ScreenVertex &a = projected[ids[i]];
+            const ScreenVertex &b = projected[ids[i + 1]];
+            if (!in_margin(a, screen_width, screen_height) && !in_margin(b, screen_width, screen_height))
+            {
+                flush();
+                continue;
+            }
+
+            if (run.empty())
+            {
+                run.insert(run.end(), {(float)a.x, (float)a.y});
+#ifdef TINY3D_DEPTH_CUE
+                if (cued)
+                    cue.push_back(depth_cue_factor(a.z));
+#endif
+            }
+            run.insert(run.end(), {(float)b.x, (float)b.y});
+#ifdef TINY3D_DEPTH_CUE
+            if (cued)
+                cue.push_back(depth_cue_factor(b.z));
+#endif
+        }
+        flush();
+    }
+}
@@ -0,0 +1,63 @@
+#include "transform.h"
+#include <algorithm>
+
+static const uint8_t LOCAL_CHANGED = 1;
+static const uint8_t WORLD_CHANGED = 2;
+
+TransformHierarchy::TransformHierarchy() : first_dirty(0) {}
+
+int TransformHierarchy::add(int parent, const mat4 &local)
+{
+    if (parent < -1 || parent >= size())
+        return -1;
+
+    int node = size();
+    parents.push_back(parent);
+    locals.push_back(local);
+    worlds.push_back(local);
+    flags.push_back(LOCAL_CHANGED);
+    first_dirty = std::min(first_dirty, node);
+    return node;
+}
+
+void TransformHierarchy::clear()
+{
+    parents.clear();
+    locals.clear();
+    worlds.clear();
+    flags.clear();
+    first_dirty = 0;
+}
+
+void TransformHierarchy::set_local(int node, const mat4 &local)
+{
+    locals[node] = local;
+    flags[node] |= LOCAL_CHANGED;
+    first_dirty = std::min(first_dirty, node);
+}
+
+int TransformHierarchy::update()
+{
+    int n = size();
+    int written = 0;
+
+    // Children follow their parents, so a node's parent is final by the
+    // time it is reached; WORLD_CHANGED carries dirtiness down the tree
+    for (int i = first_dirty; i < n; i++)
+    {
+        int p = parents[i];
+        bool recompute = (flags[i] & LOCAL_CHANGED) || (p >= 0 && (flags[p] & WORLD_CHANGED));
+        if (!recompute)
+            continue;
+
+        worlds[i] = p < 0 ? locals[i] : multiply(worlds[p], locals[i]);
+        flags[i] = WORLD_CHANGED;
+        written++;
+    }
+
+    // Clear the marks for the next frame
+    for (int i = first_dirty; i < n; i++)
+        flags[i] = 0;
+    first_dirty = n;
+    return written;
+}
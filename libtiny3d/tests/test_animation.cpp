@@ -1,3 +1,4 @@
+#include <iostream>
 #include <vector>
 #include <utility>
 #include <cmath>
@@ -36,6 +37,42 @@ void setup_lights()
     lights[1].intensity = 0.4f;
 }
 
+/* ================= CHECKS ================= */
+
+static int failures = 0;
+
+static void check(const char *label, bool ok)
+{
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << label << "\n";
+    if (!ok)
+        failures++;
+}
+
+// Farthest a densely sampled curve strays from its flattened polyline, in pixels
+static float curve_error(const vec3_t p[4], const mat4 &mvp, const std::vector<float> &xy)
+{
+    float worst = 0.0f;
+    for (int i = 0; i <= 1000; i++)
+    {
+        vec3_t c = multiply(mvp, bezier(p[0], p[1], p[2], p[3], i / 1000.0f));
+        float sx = (c.x + 1.0f) * 0.5f * SCREEN_W;
+        float sy = (1.0f - c.y) * 0.5f * SCREEN_H;
+
+        float best = 1e30f;
+        for (size_t k = 0; k + 3 < xy.size(); k += 2)
+        {
+            float dx = xy[k + 2] - xy[k], dy = xy[k + 3] - xy[k + 1];
+            float len = dx * dx + dy * dy;
+            float t = len > 0.0f ? ((sx - xy[k]) * dx + (sy - xy[k + 1]) * dy) / len : 0.0f;
+            t = std::fmax(0.0f, std::fmin(1.0f, t));
+            float ex = xy[k] + t * dx - sx, ey = xy[k + 1] + t * dy - sy;
+            best = std::fmin(best, ex * ex + ey * ey);
+        }
+        worst = std::fmax(worst, std::sqrt(best));
+    }
+    return worst;
+}
+
 /* ================= MAIN ================= */
 
 int main()
@@ -104,5 +141,187 @@ int main()
             SCREEN_W, SCREEN_H);
     }
 
-    return 0;
+    /* ================= CURVE FLATTENING ================= */
+
+    std::vector<float> xy;
+    std::vector<int> offsets;
+
+    vec3_t straight[4] = {{-2, 0, -6}, {-1, 0, -6}, {1, 0, -6}, {2, 0, -6}};
+    flatten_bezier(straight[0], straight[1], straight[2], straight[3], projection, SCREEN_W, SCREEN_H, 0.25f, xy, offsets);
+    check("straight curve is one segment", offsets.size() == 2 && xy.size() == 4);
+
+    vec3_t arch[4] = {pathA0, pathA1, pathA2, pathA3};
+    flatten_bezier(arch[0], arch[1], arch[2], arch[3], projection, SCREEN_W, SCREEN_H, 0.25f, xy, offsets);
+    int fine = (int)xy.size() / 2 - 1;
+    float fine_error = curve_error(arch, projection, xy);
+    flatten_bezier(arch[0], arch[1], arch[2], arch[3], projection, SCREEN_W, SCREEN_H, 2.0f, xy, offsets);
+    int coarse = (int)xy.size() / 2 - 1;
+    float coarse_error = curve_error(arch, projection, xy);
+    std::cout << "  arch: " << fine << " segments (error " << fine_error << " px), "
+              << coarse << " segments (error " << coarse_error << " px)\n";
+    check("within tolerance", fine_error <= 0.25f && coarse_error <= 2.0f);
+    check("looser tolerance, fewer segments", coarse < fine && offsets.size() == 2);
+
+    // Perspective: the same arch tilted away from the camera
+    vec3_t tilted[4] = {{-3, 0, -3}, {-3, 3, -8}, {3, 3, -13}, {3, 0, -18}};
+    flatten_bezier(tilted[0], tilted[1], tilted[2], tilted[3], projection, SCREEN_W, SCREEN_H, 0.25f, xy, offsets);
+    check("perspective curve within tolerance", curve_error(tilted, projection, xy) <= 0.25f);
+
+    // Passing behind the camera: only the part in front survives
+    vec3_t behind[4] = {{-2, 0, -4}, {-1, 0, 6}, {1, 0, 6}, {2, 0, -4}};
+    flatten_bezier(behind[0], behind[1], behind[2], behind[3], projection, SCREEN_W, SCREEN_H, 0.25f, xy, offsets);
+    bool finite = true;
+    for (float v : xy)
+        finite = finite && std::isfinite(v) && std::fabs(v) < 1e5f;
+    check("near plane splits the curve", offsets.size() == 3 && finite);
+
+    Canvas curve_canvas(SCREEN_W, SCREEN_H);
+    int drawn = renderer_bezier(curve_canvas, arch[0], arch[1], arch[2], arch[3],
+                                mat4::identity(), view, projection, SCREEN_W, SCREEN_H);
+    float ink = 0.0f;
+    for (int y = 0; y < SCREEN_H; y++)
+        for (int x = 0; x < SCREEN_W; x++)
+            ink += curve_canvas.pixels[y][x];
+    check("renderer_bezier draws", drawn == fine && ink > 0.0f);
+
+    /* ================= KEYFRAME TRACKS ================= */
+
+    const float key_times[4] = {0.0f, 1.0f, 2.0f, 4.0f};
+    const vec3_t key_points[4] = {{0, 0, 0}, {2, 0, 0}, {2, 2, 0}, {0, 2, -4}};
+    KeyframeTrack linear, smooth;
+    check("linear track built", linear.set_vec3(key_times, key_points, 4, KEY_LINEAR));
+    check("bezier track built", smooth.set_vec3(key_times, key_points, 4, KEY_BEZIER));
+    const float unordered[3] = {0.0f, 2.0f, 1.0f};
+    check("unordered key times rejected", !linear.set_vec3(unordered, key_points, 3, KEY_LINEAR) && linear.key_count() == 4);
+
+    float v[3];
+    linear.sample(3.0f, v);
+    check("linear midpoint", std::fabs(v[0] - 1) < 1e-6f && std::fabs(v[1] - 2) < 1e-6f && std::fabs(v[2] + 2) < 1e-6f);
+    linear.sample(-1.0f, v);
+    check("clamped before the first key", v[0] == 0 && v[1] == 0 && v[2] == 0);
+
+    bool through_keys = true;
+    for (int k = 0; k < 4; k++)
+    {
+        smooth.sample(key_times[k], v);
+        through_keys = through_keys && std::fabs(v[0] - key_points[k].x) < 1e-5f &&
+                       std::fabs(v[1] - key_points[k].y) < 1e-5f && std::fabs(v[2] - key_points[k].z) < 1e-5f;
+    }
+    check("bezier track passes through its keys", through_keys);
+    float before[3], after[3];
+    smooth.sample(2.0f - 1e-3f, before);
+    smooth.sample(2.0f + 1e-3f, after);
+    smooth.sample(2.0f, v);
+    bool c1 = true;
+    for (int c = 0; c < 3; c++)
+        c1 = c1 && std::fabs((v[c] - before[c]) - (after[c] - v[c])) < 1e-4f;
+    check("bezier track is smooth across a key", c1);
+
+    // Identity to a quarter turn about y; halfway is an eighth turn
+    const float half_angle = 0.7853982f * 0.5f;
+    const float quarter[8] = {0, 0, 0, 1, 0, std::sin(half_angle * 2), 0, std::cos(half_angle * 2)};
+    const float spin_times[2] = {0.0f, 2.0f};
+    KeyframeTrack spin;
+    check("rotation track built", spin.set_rotation(spin_times, quarter, 2));
+    float q[4];
+    spin.sample(1.0f, q);
+    check("slerp halfway", std::fabs(q[1] - std::sin(half_angle)) < 1e-5f && std::fabs(q[3] - std::cos(half_angle)) < 1e-5f);
+
+    // Cursor sampling matches the binary search, playing forward with loops and a seek
+    int cursor = 0;
+    bool cursor_matches = true;
+    float play = 0.0f;
+    for (int i = 0; i < 2000; i++)
+    {
+        play += 0.013f;
+        if (play > 4.0f)
+            play -= 4.0f;
+        if (i == 1000)
+            play = 0.5f;
+        float a[3], b[3];
+        smooth.sample(play, cursor, a);
+        smooth.sample(play, b);
+        cursor_matches = cursor_matches && a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+    }
+    check("cursor sampling matches binary search", cursor_matches);
+
+    // Clip on many instances: translation * rotation
+    AnimationClip clip;
+    clip.position.set_vec3(key_times, key_points, 4, KEY_LINEAR);
+    clip.rotation.set_rotation(spin_times, quarter, 2);
+    check("clip duration", clip.duration() == 4.0f);
+
+    std::vector<AnimatedInstance> crowd(100);
+    for (int i = 0; i < (int)crowd.size(); i++)
+        crowd[i] = {&clip, i * 0.05f, {0, 0, 0}};
+    std::vector<mat4> models(crowd.size());
+    for (int frame = 0; frame < 30; frame++)
+    {
+        for (AnimatedInstance &inst : crowd)
+            inst.time += 0.1f;
+        sample_animation(crowd.data(), (int)crowd.size(), models.data());
+    }
+    check("looping clip wraps time", crowd[99].time >= 0.0f && crowd[99].time < 4.0f &&
+                                         std::fabs(crowd[99].time - std::fmod(99 * 0.05f + 3.0f, 4.0f)) < 1e-4f);
+
+    AnimatedInstance probe = {&clip, 1.0f, {0, 0, 0}};
+    mat4 probe_model;
+    sample_animation(&probe, 1, &probe_model);
+    // rotation_xyz turns the opposite way to a quaternion about the same axis
+    mat4 expected = multiply(mat4::translation(2, 0, 0), mat4::rotation_xyz(0, -half_angle * 2, 0));
+    bool same_matrix = true;
+    for (int k = 0; k < 16; k++)
+        same_matrix = same_matrix && std::fabs(probe_model.m[k] - expected.m[k]) < 1e-5f;
+    check("sampled model matrix", same_matrix);
+
+    /* ================= ARC-LENGTH PATHS ================= */
+
+    BezierPath path;
+    const vec3_t bunched[4] = {{0, 0, 0}, {0.1f, 0, 0}, {0.2f, 0, 0}, {3, 0, 0}};
+    check("bad control point count rejected", !path.build(bunched, 3));
+    check("path built", path.build(bunched, 4));
+    check("straight path length", std::fabs(path.length() - 3.0f) < 1e-4f);
+    bool distance_maps = true;
+    for (int i = 0; i <= 30; i++)
+        distance_maps = distance_maps && std::fabs(path.position(path.t_at(i * 0.1f)).x - i * 0.1f) < 2e-3f;
+    check("t_at inverts arc length on an uneven curve", distance_maps && path.t_at(0.5f) > 0.5f);
+
+    // Two segments approximating a half circle of radius 2
+    const float arm = 2.0f * 0.5522848f;
+    const vec3_t half_circle[7] = {
+        {2, 0, 0}, {2, arm, 0}, {arm, 2, 0}, {0, 2, 0}, {-arm, 2, 0}, {-2, arm, 0}, {-2, 0, 0}};
+    path.build(half_circle, 7);
+    check("half circle length", std::fabs(path.length() - 6.2832f) < 0.01f && path.segment_count() == 2);
+
+    const int PATH_SAMPLES = 40;
+    std::vector<float> at(PATH_SAMPLES + 1), along((PATH_SAMPLES + 1) * 3), heading((PATH_SAMPLES + 1) * 3);
+    for (int i = 0; i <= PATH_SAMPLES; i++)
+        at[i] = path.length() * i / PATH_SAMPLES;
+    path.evaluate_at(at.data(), PATH_SAMPLES + 1, along.data(), heading.data());
+    float shortest = 1e30f, longest = 0.0f;
+    for (int i = 0; i < PATH_SAMPLES; i++)
+    {
+        float dx = along[i * 3 + 3] - along[i * 3], dy = along[i * 3 + 4] - along[i * 3 + 1];
+        float step = std::sqrt(dx * dx + dy * dy);
+        shortest = std::fmin(shortest, step);
+        longest = std::fmax(longest, step);
+    }
+    check("equal distances give equal steps", longest / shortest < 1.01f);
+    check("tangent follows the circle", std::fabs(heading[PATH_SAMPLES / 2 * 3 + 1]) < 1e-2f &&
+                                            heading[PATH_SAMPLES / 2 * 3] < 0.0f);
+
+    const int STEPS = 100;
+    std::vector<float> fd((2 * STEPS + 1) * 3), fd_tangent((2 * STEPS + 1) * 3);
+    path.evaluate_uniform(STEPS, fd.data(), fd_tangent.data());
+    float fd_error = 0.0f;
+    for (int i = 0; i <= 2 * STEPS; i++)
+    {
+        vec3_t p = path.position(i / (float)STEPS), d = path.tangent(i / (float)STEPS);
+        fd_error = std::fmax(fd_error, std::fabs(fd[i * 3] - p.x) + std::fabs(fd[i * 3 + 1] - p.y));
+        fd_error = std::fmax(fd_error, std::fabs(fd_tangent[i * 3] - d.x) + std::fabs(fd_tangent[i * 3 + 1] - d.y));
+    }
+    check("forward differencing matches direct evaluation", fd_error < 1e-3f);
+
+    std::cout << "\n=== Test Complete (" << failures << " failures) ===\n";
+    return failures == 0 ? 0 : 1;
 }
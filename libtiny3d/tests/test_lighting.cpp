@@ -0,0 +1,259 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include "math3d.h"
+#include "lighting.h"
+#include "mesh.h"
+#include "canvas.h"
+#include "renderer.h"
+
+static int failures = 0;
+
+static void check(const char *label, bool ok)
+{
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << label << "\n";
+    if (!ok)
+        failures++;
+}
+
+static float canvas_sum(const Canvas &c)
+{
+    float sum = 0.0f;
+    for (int y = 0; y < c.height; y++)
+        for (int x = 0; x < c.width; x++)
+            sum += c.pixels[y][x];
+    return sum;
+}
+
+static float frand(unsigned &seed, float lo, float hi)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * ((seed >> 8) / 16777216.0f);
+}
+
+int main()
+{
+    std::cout << "=== Lighting Test ===\n\n";
+
+    // ---- Single edge ----
+    Light along_x = {vec3_t(1, 0, 0), 0.5f};
+    Light along_y = {vec3_t(0, 1, 0), 0.8f};
+    vec3_t a(1, 2, 3), b(4, 2, 3);
+    check("edge along the light", std::fabs(lambert_edge(a, b, along_x) - 0.5f) < 2e-3f);
+    check("edge across the light", lambert_edge(a, b, along_y) < 1e-6f);
+    check("direction sign ignored", std::fabs(lambert_edge(b, a, along_x) - 0.5f) < 2e-3f);
+
+    Light pair[2] = {along_x, {vec3_t(1, 0, 0), 0.7f}};
+    check("multi clamps the sum", lambert_edge_multi(a, b, pair, 2) == 1.0f);
+
+    // ---- Batch vs scalar: 1001 edges (SIMD groups plus a tail), 12 lights ----
+    const int EDGES = 1001;
+    const int LIGHTS = 12;
+    unsigned seed = 3;
+    std::vector<Light> lights(LIGHTS);
+    for (Light &l : lights)
+    {
+        l.direction = vec3_t(frand(seed, -1, 1), frand(seed, -1, 1), frand(seed, -1, 1));
+        l.direction.normalize_fast();
+        l.intensity = frand(seed, 0.0f, 0.3f);
+    }
+    LightBatch batch;
+    batch.assign(lights.data(), LIGHTS);
+
+    std::vector<float> xyz(EDGES * 2 * 3);
+    for (float &v : xyz)
+        v = frand(seed, -5, 5);
+    xyz[3] = xyz[0]; // edge 0 has zero length
+    xyz[4] = xyz[1];
+    xyz[5] = xyz[2];
+
+    std::vector<float> soa[6];
+    std::vector<uint32_t> pairs(EDGES * 2);
+    for (int e = 0; e < EDGES; e++)
+    {
+        for (int k = 0; k < 6; k++)
+            soa[k].push_back(xyz[e * 6 + k]);
+        pairs[e * 2] = e * 2;
+        pairs[e * 2 + 1] = e * 2 + 1;
+    }
+
+    std::vector<float> batched(EDGES), indexed(EDGES);
+    lambert_edges_batch(soa[0].data(), soa[1].data(), soa[2].data(),
+                        soa[3].data(), soa[4].data(), soa[5].data(), EDGES, batch, batched.data());
+    lambert_edges_indexed(xyz.data(), pairs.data(), EDGES, batch, indexed.data());
+
+    float worst = 0.0f;
+    for (int e = 0; e < EDGES; e++)
+    {
+        vec3_t p(xyz[e * 6], xyz[e * 6 + 1], xyz[e * 6 + 2]);
+        vec3_t q(xyz[e * 6 + 3], xyz[e * 6 + 4], xyz[e * 6 + 5]);
+        worst = std::fmax(worst, std::fabs(batched[e] - lambert_edge_multi(p, q, lights.data(), LIGHTS)));
+    }
+    std::cout << "  batch vs scalar: max difference " << worst << "\n";
+    check("batch matches lambert_edge_multi", worst < 5e-3f);
+    check("zero-length edge is dark", batched[0] == 0.0f);
+    check("indexed matches batch", indexed == batched);
+
+    // ---- Spherical harmonics: fitted kernel, then 64 lights vs the exact path ----
+    Light overhead = {vec3_t(0, 0, 2), 0.5f}; // unnormalized: intensity 1
+    LightSH one_sh;
+    one_sh.project(&overhead, 1);
+    vec3_t o(0, 0, 0);
+    check("sh: edge across the light reads 0.1875", std::fabs(lambert_edge_sh(o, vec3_t(1, 0, 0), one_sh) - 0.1875f) < 1e-3f);
+    check("sh: edge at 45 degrees reads 0.65625", std::fabs(lambert_edge_sh(o, vec3_t(1, 0, 1), one_sh) - 0.65625f) < 1e-3f);
+    check("sh: edge along the light clamps", lambert_edge_sh(o, vec3_t(0, 0, -3), one_sh) == 1.0f);
+
+    std::vector<Light> sky(64);
+    for (Light &l : sky)
+    {
+        l.direction = vec3_t(frand(seed, -1, 1), frand(seed, -1, 1), frand(seed, -1, 1));
+        l.direction.normalize_fast();
+        l.intensity = 2.0f / 64;
+    }
+    sky.push_back(Light::point(vec3_t(0, 0, 0), 1.0f, 1000.0f)); // skipped by the projection
+    LightSH sky_sh;
+    sky_sh.project(sky.data(), (int)sky.size());
+
+    std::vector<float> sh_batched(EDGES), sh_indexed(EDGES);
+    lambert_edges_sh(soa[0].data(), soa[1].data(), soa[2].data(),
+                     soa[3].data(), soa[4].data(), soa[5].data(), EDGES, sky_sh, sh_batched.data());
+    lambert_edges_sh_indexed(xyz.data(), pairs.data(), EDGES, sky_sh, sh_indexed.data());
+
+    float sh_worst = 0.0f, sh_mean = 0.0f, sh_scalar_worst = 0.0f;
+    for (int e = 1; e < EDGES; e++)
+    {
+        vec3_t p(xyz[e * 6], xyz[e * 6 + 1], xyz[e * 6 + 2]);
+        vec3_t q(xyz[e * 6 + 3], xyz[e * 6 + 4], xyz[e * 6 + 5]);
+        float error = std::fabs(sh_batched[e] - lambert_edge_multi(p, q, sky.data(), 64));
+        sh_worst = std::fmax(sh_worst, error);
+        sh_mean += error / (EDGES - 1);
+        sh_scalar_worst = std::fmax(sh_scalar_worst, std::fabs(sh_batched[e] - lambert_edge_sh(p, q, sky_sh)));
+    }
+    std::cout << "  sh vs exact (64 lights): mean error " << sh_mean << ", max " << sh_worst << "\n";
+    check("sh batch matches scalar sh", sh_scalar_worst < 1e-3f);
+    check("sh indexed matches sh batch", sh_indexed == sh_batched);
+    check("sh zero-length edge is dark", sh_batched[0] == 0.0f);
+    check("sh approximates many lights", sh_mean < 0.015f && sh_worst < 0.06f);
+
+    // ---- Point and spot lights ----
+    Light bulb = Light::point(vec3_t(0, 0, 0), 0.8f, 10.0f);
+    // Radial edge at distance 5: falloff (1 - 0.25)^2
+    check("point light radial edge", std::fabs(lambert_edge(vec3_t(4, 0, 0), vec3_t(6, 0, 0), bulb) - 0.8f * 0.5625f) < 2e-3f);
+    check("point light tangent edge", lambert_edge(vec3_t(5, -1, 0), vec3_t(5, 1, 0), bulb) < 1e-6f);
+    check("point light out of range", lambert_edge(vec3_t(11, 0, 0), vec3_t(13, 0, 0), bulb) == 0.0f);
+
+    Light cone = Light::spot(vec3_t(0, 0, 0), vec3_t(0, 0, -1), 1.0f, 100.0f, 0.2f, 0.4f);
+    float on_axis = lambert_edge(vec3_t(0, 0, -1), vec3_t(0, 0, -3), cone);
+    float in_falloff = lambert_edge(vec3_t(0, 0.15f, -0.5f), vec3_t(0, 0.75f, -2.5f), cone); // 0.29 rad off axis
+    float outside = lambert_edge(vec3_t(0, 1, -1), vec3_t(0, 3, -3), cone);
+    check("spot: full inside, fading between, dark outside",
+          on_axis > 0.99f && in_falloff > 0.0f && in_falloff < on_axis && outside == 0.0f);
+
+    // ---- Light grid vs brute force: 300 local lights, 2 directional, 2000 edges ----
+    std::vector<Light> many;
+    many.push_back(Light(vec3_t(0, -1, 0), 0.1f));
+    many.push_back(Light(vec3_t(1, 0, 1), 0.05f));
+    for (int i = 0; i < 300; i++)
+    {
+        vec3_t at(frand(seed, -100, 100), frand(seed, -5, 5), frand(seed, -100, 100));
+        if (i % 3 == 0)
+            many.push_back(Light::spot(at, vec3_t(frand(seed, -1, 1), -1, frand(seed, -1, 1)), 0.6f,
+                                       frand(seed, 4, 12), 0.3f, 0.6f));
+        else
+            many.push_back(Light::point(at, 0.5f, frand(seed, 4, 12)));
+    }
+    const int GRID_EDGES = 2000;
+    std::vector<float> grid_xyz(GRID_EDGES * 6);
+    std::vector<uint32_t> grid_pairs(GRID_EDGES * 2);
+    for (int e = 0; e < GRID_EDGES; e++)
+    {
+        float c[3] = {frand(seed, -100, 100), frand(seed, -5, 5), frand(seed, -100, 100)};
+        for (int k = 0; k < 3; k++)
+        {
+            grid_xyz[e * 6 + k] = c[k];
+            grid_xyz[e * 6 + 3 + k] = c[k] + frand(seed, -1, 1);
+        }
+        grid_pairs[e * 2] = e * 2;
+        grid_pairs[e * 2 + 1] = e * 2 + 1;
+    }
+
+    LightGrid grid;
+    grid.build(many.data(), (int)many.size());
+    std::vector<float> shaded(GRID_EDGES);
+    LightGridStats grid_stats;
+    grid.shade_edges(grid_xyz.data(), grid_pairs.data(), GRID_EDGES, shaded.data(), &grid_stats);
+
+    worst = 0.0f;
+    for (int e = 0; e < GRID_EDGES; e++)
+    {
+        vec3_t p(grid_xyz[e * 6], grid_xyz[e * 6 + 1], grid_xyz[e * 6 + 2]);
+        vec3_t q(grid_xyz[e * 6 + 3], grid_xyz[e * 6 + 4], grid_xyz[e * 6 + 5]);
+        worst = std::fmax(worst, std::fabs(shaded[e] - lambert_edge_multi(p, q, many.data(), (int)many.size())));
+    }
+    std::cout << "  grid: " << grid.cell_count() << " cells, " << grid_stats.light_tests / (float)GRID_EDGES
+              << " local lights per edge (of 300), max difference " << worst << "\n";
+    check("grid matches brute force", worst < 5e-3f);
+    check("grid evaluates few lights per edge", grid_stats.light_tests < GRID_EDGES * 300 / 10);
+
+    // ---- Lit wireframe with a cached per-edge intensity ----
+    vec3_t cube[8] = {
+        {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+        {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}};
+    const int cube_edges[12][2] = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+    Mesh cube_mesh;
+    cube_mesh.build(cube, 8, cube_edges, 12);
+
+    Light key = {vec3_t(1, 0, 0), 0.6f};
+    mat4 model = mat4::rotation_xyz(0, 0.5f, 0);
+    mat4 projection = mat4::frustumAssymetric(-1, 1, -1, 1, 1, 50);
+    EdgeLightCache cache;
+    check("first update computes", cache.update(cube_mesh, model, &key, 1));
+
+    bool matches = true;
+    for (int e = 0; e < cube_mesh.edge_count(); e++)
+    {
+        const int *pair = cube_mesh.edge_data()[e];
+        const float *p = cube_mesh.position_data() + pair[0] * 3;
+        const float *q = cube_mesh.position_data() + pair[1] * 3;
+        vec3_t wp = multiply(model, vec3_t(p[0], p[1], p[2]));
+        vec3_t wq = multiply(model, vec3_t(q[0], q[1], q[2]));
+        matches = matches && std::fabs(cache.intensities()[e] - lambert_edge_multi(wp, wq, &key, 1)) < 2e-3f;
+    }
+    check("cached intensities are world-space lambert", matches);
+
+    Canvas lit(128, 128), plain(128, 128);
+    for (int frame = 0; frame < 5; frame++)
+    {
+        mat4 view = multiply(mat4::translation(0, 0, -6), mat4::rotation_xyz(0.1f * frame, 0, 0));
+        renderer_wireframe_lit(lit, cube_mesh, cache, model, view, projection, &key, 1, 128, 128);
+        if (frame == 0)
+            renderer_wireframe(plain, cube_mesh, model, view, projection, 128, 128);
+    }
+    check("moving camera reuses the cache", cache.update_count() == 1);
+
+    mat4 moved = multiply(mat4::translation(1, 0, 0), model);
+    check("model change recomputes", cache.update(cube_mesh, moved, &key, 1) && cache.update_count() == 2);
+    key.intensity = 0.3f;
+    check("light change recomputes", cache.update(cube_mesh, moved, &key, 1) && cache.update_count() == 3);
+    check("unchanged inputs do not", !cache.update(cube_mesh, moved, &key, 1));
+    Light lamp = Light::point(vec3_t(3, 0, 0), 1.0f, 5.0f);
+    cache.update(cube_mesh, moved, &lamp, 1);
+    lamp.position.x = 2.5f;
+    check("moved point light recomputes", cache.update(cube_mesh, moved, &lamp, 1));
+
+    // Rebuilt in place with the same counts: same address, new positions
+    vec3_t stretched[8];
+    for (int i = 0; i < 8; i++)
+        stretched[i] = vec3_t(cube[i].x * 3.0f, cube[i].y, cube[i].z);
+    cube_mesh.build(stretched, 8, cube_edges, 12);
+    check("rebuilt mesh recomputes", cache.update(cube_mesh, moved, &lamp, 1));
+
+    float lit_ink = canvas_sum(lit) / 5.0f;
+    float plain_ink = canvas_sum(plain);
+    std::cout << "  ink: lit " << lit_ink << ", unlit " << plain_ink << "\n";
+    check("lit edges are dimmer than unlit", lit_ink > 0.0f && lit_ink < plain_ink);
+
+    std::cout << "\n=== Test Complete (" << failures << " failures) ===\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -1,7 +1,25 @@
 #include <iostream>
 #include <iomanip>
+#include <cmath>
+#include <vector>
 #include "math3d.h"
 
+static int failures = 0;
+
+static void check(const char *label, bool ok)
+{
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << label << "\n";
+    if (!ok)
+        failures++;
+}
+
+// Rotation angle between two unit quaternions
+static float quat_angle(const quat &a, const quat &b)
+{
+    quat r = multiply({-a.x, -a.y, -a.z, a.w}, b); // a^-1 b, precise near zero unlike acos
+    return 2.0f * std::atan2(std::sqrt(r.x * r.x + r.y * r.y + r.z * r.z), std::fabs(r.w));
+}
+
 // Helper to print vec3
 void print_vec3(const char* label, const vec3_t& v)
 {
@@ -88,6 +106,63 @@ int main()
         print_vec3("dir", d);
     }
 
-    std::cout << "\n=== Test Complete ===\n";
-    return 0;
+    // 7️⃣ QUATERNIONS
+    std::cout << "\nQuaternion test:\n";
+
+    quat turn_y = quat::axis_angle(vec3_t(0, 2, 0), 0.8f);
+    mat4 from_quat = turn_y.to_matrix();
+    mat4 from_euler = mat4::rotation_xyz(0, -0.8f, 0);
+    bool same = true;
+    for (int k = 0; k < 16; k++)
+        same = same && std::fabs(from_quat.m[k] - from_euler.m[k]) < 1e-5f;
+    check("to_matrix matches rotation_xyz (opposite sense)", same);
+
+    quat turn_x = quat::axis_angle(vec3_t(1, 0, 0), 0.3f);
+    mat4 composed = multiply(turn_y, turn_x).to_matrix();
+    mat4 chained = multiply(turn_y.to_matrix(), turn_x.to_matrix());
+    same = true;
+    for (int k = 0; k < 16; k++)
+        same = same && std::fabs(composed.m[k] - chained.m[k]) < 1e-5f;
+    check("multiply composes like the matrices", same);
+
+    quat q0 = quat::identity();
+    quat q1 = quat::axis_angle(vec3_t(0, 0, 1), 2.0f);
+    check("slerp halfway", quat_angle(slerp(q0, q1, 0.5f), quat::axis_angle(vec3_t(0, 0, 1), 1.0f)) < 1e-3f);
+    quat flipped = {-q1.x, -q1.y, -q1.z, -q1.w};
+    check("slerp takes the short way", quat_angle(slerp(q0, flipped, 0.5f), slerp(q0, q1, 0.5f)) < 1e-3f);
+
+    // Fast paths against slerp over random pairs, angles up to 180 degrees
+    const int PAIRS = 1003;
+    std::vector<quat> from(PAIRS), to(PAIRS), batched(PAIRS);
+    std::vector<float> ts(PAIRS);
+    unsigned seed = 7;
+    auto rnd = [&seed]()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return (seed >> 8) / 16777216.0f;
+    };
+    for (int i = 0; i < PAIRS; i++)
+    {
+        from[i] = quat::axis_angle(vec3_t(rnd() - 0.5f, rnd() - 0.5f, rnd() - 0.5f), rnd() * 6.2832f);
+        to[i] = quat::axis_angle(vec3_t(rnd() - 0.5f, rnd() - 0.5f, rnd() - 0.5f), rnd() * 6.2832f);
+        ts[i] = rnd();
+    }
+    slerp_batch(from.data(), to.data(), ts.data(), PAIRS, batched.data());
+
+    float fast_error = 0.0f, batch_error = 0.0f, nlerp_error = 0.0f;
+    for (int i = 0; i < PAIRS; i++)
+    {
+        quat exact = slerp(from[i], to[i], ts[i]);
+        fast_error = std::fmax(fast_error, quat_angle(slerp_fast(from[i], to[i], ts[i]), exact));
+        batch_error = std::fmax(batch_error, quat_angle(batched[i], exact));
+        nlerp_error = std::fmax(nlerp_error, quat_angle(nlerp(from[i], to[i], ts[i]), exact));
+    }
+    std::cout << std::setprecision(6) << "max angular error vs slerp: nlerp " << nlerp_error << ", slerp_fast " << fast_error
+              << ", slerp_batch " << batch_error << " rad\n";
+    check("slerp_fast within 0.001 rad", fast_error < 1e-3f);
+    check("slerp_batch within 0.001 rad", batch_error < 1e-3f);
+    check("slerp_fast beats nlerp", fast_error < nlerp_error);
+
+    std::cout << "\n=== Test Complete (" << failures << " failures) ===\n";
+    return failures == 0 ? 0 : 1;
 }
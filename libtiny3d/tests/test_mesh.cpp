@@ -0,0 +1,442 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <utility>
+#include "mesh.h"
+#include "spatial_hash.h"
+#include "lod.h"
+#include "canvas.h"
+#include "renderer.h"
+#include "strips.h"
+#include "silhouette.h"
+#include "morph.h"
+
+static int failures = 0;
+
+// True when the strips walk every edge of the graph exactly once
+static bool strips_cover(const PolylineStrips &strips, const int *pairs, int edge_count)
+{
+    std::multiset<std::pair<int, int>> walked;
+    for (int s = 0; s < strips.strip_count(); s++)
+        for (int i = 0; i + 1 < strips.strip_size(s); i++)
+        {
+            int a = strips.strip(s)[i], b = strips.strip(s)[i + 1];
+            walked.insert({a < b ? a : b, a < b ? b : a});
+        }
+
+    std::multiset<std::pair<int, int>> expected;
+    for (int e = 0; e < edge_count; e++)
+    {
+        int a = pairs[e * 2], b = pairs[e * 2 + 1];
+        expected.insert({a < b ? a : b, a < b ? b : a});
+    }
+    return walked == expected;
+}
+
+static void check(const char *label, bool ok)
+{
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << label << "\n";
+    if (!ok)
+        failures++;
+}
+
+int main()
+{
+    std::cout << "=== Mesh Test ===\n\n";
+
+    vec3_t cube[8] = {
+        {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+        {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}};
+
+    // 12 cube edges plus a reversed duplicate, an exact duplicate and a self loop
+    const int edges[15][2] = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}, {7, 4},
+        {0, 4}, {1, 5}, {2, 6}, {3, 7}, {1, 0}, {2, 6}, {5, 5}};
+
+    Mesh mesh;
+    bool ok = mesh.build(cube, 8, edges, 15);
+
+    check("build succeeds", ok);
+    check("12 unique edges", mesh.edge_count() == 12);
+    check("2 duplicates dropped", mesh.build_stats().duplicate_edges == 2);
+    check("1 degenerate dropped", mesh.build_stats().degenerate_edges == 1);
+
+    bool canonical = true;
+    for (int i = 0; i < mesh.edge_count(); i++)
+    {
+        const int *e = mesh.edge_data()[i];
+        if (e[0] >= e[1])
+            canonical = false;
+        if (i > 0)
+        {
+            const int *p = mesh.edge_data()[i - 1];
+            if (p[0] > e[0] || (p[0] == e[0] && p[1] >= e[1]))
+                canonical = false;
+        }
+    }
+    check("edges canonical and sorted", canonical);
+    check("every cube vertex has degree 3", mesh.vertex_degree(0) == 3 && mesh.vertex_degree(6) == 3);
+
+    const AABB &box = mesh.aabb();
+    check("aabb", box.min[0] == -1 && box.max[2] == 1);
+    check("bounding sphere radius = sqrt(3)",
+          std::fabs(mesh.bounding_sphere().radius - std::sqrt(3.0f)) < 1e-4f);
+
+    // Out of range index is rejected
+    const int bad_edges[1][2] = {{0, 8}};
+    Mesh bad;
+    check("invalid index rejected", !bad.build(cube, 8, bad_edges, 1) && bad.empty());
+
+    // Faces: cube as 6 quads, no explicit edges
+    float xyz[24];
+    for (int i = 0; i < 8; i++)
+    {
+        xyz[i * 3 + 0] = cube[i].x;
+        xyz[i * 3 + 1] = cube[i].y;
+        xyz[i * 3 + 2] = cube[i].z;
+    }
+    const int sizes[6] = {4, 4, 4, 4, 4, 4};
+    const int quads[24] = {
+        0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4,
+        1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7};
+
+    Mesh faced;
+    ok = faced.build(xyz, 8, nullptr, 0, sizes, 6, quads);
+    check("face build succeeds", ok);
+    check("faces yield 12 edges", faced.edge_count() == 12);
+
+    bool two_faces = true;
+    for (int e = 0; e < faced.edge_count(); e++)
+    {
+        if (faced.edge_faces(e)[0] < 0 || faced.edge_faces(e)[1] < 0)
+            two_faces = false;
+    }
+    check("every edge has two faces", two_faces);
+
+    // ---- Spatial hash: compare against brute force ----
+    std::cout << "\nSpatial hash:\n";
+
+    const int N = 2000;
+    std::vector<float> pts(N * 3);
+    srand(7);
+    for (int i = 0; i < N * 3; i++)
+        pts[i] = (float)rand() / RAND_MAX * 10.0f;
+
+    const float R = 0.5f;
+    int brute = 0;
+    for (int i = 0; i < N; i++)
+        for (int j = i + 1; j < N; j++)
+        {
+            float dx = pts[i * 3] - pts[j * 3];
+            float dy = pts[i * 3 + 1] - pts[j * 3 + 1];
+            float dz = pts[i * 3 + 2] - pts[j * 3 + 2];
+            if (dx * dx + dy * dy + dz * dz < R * R)
+                brute++;
+        }
+
+    std::vector<int> near_edges;
+    connect_points_within(pts.data(), N, R, near_edges);
+    check("connect_points_within matches brute force", (int)near_edges.size() / 2 == brute);
+
+    // Every point duplicated with a tiny offset welds back to N
+    std::vector<float> doubled(pts);
+    for (int i = 0; i < N * 3; i++)
+        doubled.push_back(pts[i] + 1e-5f);
+
+    std::vector<float> welded;
+    std::vector<int> remap;
+    int count = weld_vertices(doubled.data(), N * 2, 1e-3f, welded, remap);
+    check("weld_vertices merges near duplicates", count == N && remap[N + 5] == remap[5]);
+
+    // Welding a mesh collapses its duplicate corner
+    vec3_t split[3] = {{0, 0, 0}, {1, 0, 0}, {1.00001f, 0, 0}};
+    const int split_edges[2][2] = {{0, 1}, {0, 2}};
+    Mesh split_mesh, joined;
+    split_mesh.build(split, 3, split_edges, 2);
+    check("weld_mesh", weld_mesh(split_mesh, 1e-3f, joined) &&
+                           joined.vertex_count() == 2 && joined.edge_count() == 1);
+
+    // ---- LOD: simplification ----
+    std::vector<float> line_xyz;
+    std::vector<int> line_edges;
+    for (int i = 0; i <= 100; i++)
+    {
+        line_xyz.insert(line_xyz.end(), {i * 0.1f, 0.0f, 0.0f});
+        if (i > 0)
+            line_edges.insert(line_edges.end(), {i - 1, i});
+    }
+    Mesh line;
+    line.build(line_xyz.data(), 101, reinterpret_cast<const int(*)[2]>(line_edges.data()), 100);
+    Mesh line_lod;
+    ok = simplify_wireframe(line, 0.05f, line_lod);
+    check("collinear chain straightened", ok && line_lod.edge_count() == 1 && line_lod.vertex_count() == 2);
+
+    // Latitude/longitude sphere, 64 x 32
+    std::vector<float> sphere_xyz;
+    std::vector<int> sphere_edges;
+    const int LON = 64, LAT = 32;
+    for (int j = 0; j <= LAT; j++)
+        for (int i = 0; i < LON; i++)
+        {
+            float theta = 3.14159265f * j / LAT;
+            float phi = 6.2831853f * i / LON;
+            sphere_xyz.insert(sphere_xyz.end(), {sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)});
+            int v = j * LON + i;
+            sphere_edges.insert(sphere_edges.end(), {v, j * LON + (i + 1) % LON});
+            if (j > 0)
+                sphere_edges.insert(sphere_edges.end(), {v, v - LON});
+        }
+    Mesh sphere;
+    sphere.build(sphere_xyz.data(), (int)sphere_xyz.size() / 3,
+                 reinterpret_cast<const int(*)[2]>(sphere_edges.data()), (int)sphere_edges.size() / 2);
+
+    LodMesh lod;
+    lod.generate(sphere);
+    bool shrinking = lod.level_count() >= 3;
+    for (int k = 1; k < lod.level_count(); k++)
+        shrinking = shrinking && lod.level(k).edge_count() < lod.level(k - 1).edge_count() &&
+                    lod.level_error(k) > lod.level_error(k - 1);
+    std::cout << "  lod levels:";
+    for (int k = 0; k < lod.level_count(); k++)
+        std::cout << " " << lod.level(k).edge_count();
+    std::cout << "\n";
+    check("lod levels get coarser", shrinking);
+
+    bool within = true;
+    for (int k = 1; k < lod.level_count(); k++)
+    {
+        const float *p = lod.level(k).position_data();
+        for (int v = 0; v < lod.level(k).vertex_count(); v++)
+        {
+            float r = sqrtf(p[v * 3] * p[v * 3] + p[v * 3 + 1] * p[v * 3 + 1] + p[v * 3 + 2] * p[v * 3 + 2]);
+            within = within && fabsf(r - 1.0f) <= lod.level_error(k);
+        }
+    }
+    check("simplified vertices stay within the error bound", within);
+
+    // ---- LOD: selection ----
+    int last = lod.level_count() - 1;
+    check("close up uses level 0", lod.select(10000.0f, -1) == 0);
+    check("far away uses coarsest", lod.select(0.5f, -1) == last);
+
+    // Radius at which level 1's error is exactly one pixel
+    float edge_px = 1.0f / lod.level_error(1);
+    int level = lod.select(edge_px * 1.01f, -1);
+    bool steady = true;
+    for (int frame = 0; frame < 20; frame++)
+    {
+        int next = lod.select(edge_px * (frame % 2 ? 0.95f : 1.05f), level);
+        steady = steady && next == level;
+        level = next;
+    }
+    check("hysteresis holds the level near a threshold", steady);
+    check("hysteresis still switches on a large change", lod.select(edge_px * 0.5f, level) != level);
+
+    BoundingSphere ball = {{0, 0, -10}, 1};
+    mat4 projection = mat4::frustumAssymetric(-1, 1, -1, 1, 1, 50);
+    check("projected radius", fabsf(projected_radius(ball, mat4::identity(), projection, 200) - 10.0f) < 1e-4f);
+
+    // Near and far copies of the sphere pick different levels
+    LodObject objects[2] = {
+        {&lod, mat4::translation(0, 0, -4), -1},
+        {&lod, mat4::translation(0, 0, -45), -1}};
+    Canvas canvas(200, 200);
+    LodRenderStats lod_stats;
+    render_lod_scene(canvas, objects, 2, mat4::identity(), projection, 200, 200, 1.0f, &lod_stats);
+    check("lod scene draws both objects", lod_stats.objects_drawn == 2);
+    check("far object uses a coarser level", objects[1].level > objects[0].level);
+
+    // ---- Polyline strips ----
+    PolylineStrips strips;
+    build_polyline_strips(mesh, strips);
+    check("cube: 8 odd vertices give 4 strips", strips.strip_count() == 4);
+    check("cube strips cover every edge once", strips_cover(strips, &mesh.edge_data()[0][0], mesh.edge_count()));
+
+    // A square loop plus a separate 3-edge path
+    const int mixed[7][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}};
+    build_polyline_strips(&mixed[0][0], 7, 8, strips);
+    bool loop_closed = false;
+    for (int s = 0; s < strips.strip_count(); s++)
+        loop_closed = loop_closed || (strips.strip_size(s) == 5 && strips.strip(s)[0] == strips.strip(s)[4]);
+    check("loop and path give 2 strips", strips.strip_count() == 2 && loop_closed);
+    check("mixed strips cover every edge once", strips_cover(strips, &mixed[0][0], 7));
+
+    build_polyline_strips(&sphere.edge_data()[0][0], sphere.edge_count(), sphere.vertex_count(), strips);
+    check("sphere strips cover every edge once", strips_cover(strips, &sphere.edge_data()[0][0], sphere.edge_count()));
+
+    // Joint of two segments: separate lines splat it twice, the polyline once
+    Canvas lines(40, 40), poly(40, 40);
+    draw_line_f(lines, 5, 20, 20, 20, 1.0f, 1.0f);
+    draw_line_f(lines, 20, 20, 20, 35, 1.0f, 1.0f);
+    const float corner_xy[6] = {5, 20, 20, 20, 20, 35};
+    draw_polyline_f(poly, corner_xy, 3, 1.0f, 1.0f);
+    check("polyline writes the joint once", poly.pixels[20][20] < lines.pixels[20][20] &&
+                                                 fabsf(poly.pixels[20][12] - lines.pixels[20][12]) < 1e-6f);
+
+#ifdef TINY3D_DEPTH_CUE
+    // Cued lines: the intensity ramps between the end values
+    Canvas cued(40, 40), cued_poly(40, 40), uncued(40, 40);
+    draw_line_f_cued(cued, 5, 10, 35, 10, 1.0f, 0.0f, 1.0f);
+    draw_line_f(uncued, 5, 10, 35, 10, 1.0f, 1.0f);
+    check("cued line fades along its length", cued.pixels[10][8] > cued.pixels[10][20] &&
+                                                  cued.pixels[10][20] > cued.pixels[10][32] &&
+                                                  fabsf(cued.pixels[10][20] - 0.5f * uncued.pixels[10][20]) < 0.02f);
+    const float fade[3] = {1.0f, 0.5f, 1.0f};
+    draw_polyline_f_cued(cued_poly, corner_xy, fade, 3, 1.0f);
+    check("cued polyline matches constant one at equal ends",
+          fabsf(cued_poly.pixels[20][5] - poly.pixels[20][5]) < 1e-6f && cued_poly.pixels[20][20] < poly.pixels[20][20]);
+
+    // Cube receding from the camera: far edges dimmer than near ones
+    Canvas flat_cube(200, 200), cued_cube(200, 200);
+    mat4 receding = multiply(mat4::translation(0, 0, -4), mat4::rotation_xyz(0.6f, 0.6f, 0));
+    renderer_wireframe(flat_cube, mesh, receding, mat4::identity(), projection, 200, 200);
+    set_depth_cue({DEPTH_CUE_LINEAR, 0.0f, 1.0f, 0.0f});
+    renderer_wireframe(cued_cube, mesh, receding, mat4::identity(), projection, 200, 200);
+    check("depth cue factor: near bright, far dark", depth_cue_factor(-1.0f) == 1.0f && depth_cue_factor(1.0f) == 0.0f);
+    set_depth_cue({DEPTH_CUE_OFF, 0.0f, 1.0f, 0.0f});
+    float flat_ink = 0.0f, cued_ink = 0.0f;
+    for (int y = 0; y < 200; y++)
+        for (int x = 0; x < 200; x++)
+        {
+            flat_ink += flat_cube.pixels[y][x];
+            cued_ink += cued_cube.pixels[y][x];
+        }
+    check("depth cue dims the wireframe", cued_ink > 0.0f && cued_ink < flat_ink);
+
+    Canvas flat_strips(200, 200), cued_strips(200, 200);
+    build_polyline_strips(sphere, strips);
+    renderer_wireframe_strips(flat_strips, sphere, strips, receding, mat4::identity(), projection, 200, 200);
+    set_depth_cue({DEPTH_CUE_EXP, 0.5f, 1.0f, 4.0f});
+    renderer_wireframe_strips(cued_strips, sphere, strips, receding, mat4::identity(), projection, 200, 200);
+    set_depth_cue({DEPTH_CUE_OFF, 0.0f, 1.0f, 0.0f});
+    flat_ink = cued_ink = 0.0f;
+    for (int y = 0; y < 200; y++)
+        for (int x = 0; x < 200; x++)
+        {
+            flat_ink += flat_strips.pixels[y][x];
+            cued_ink += cued_strips.pixels[y][x];
+        }
+    check("depth cue dims strips", cued_ink > 0.0f && cued_ink < flat_ink);
+#endif
+
+    Canvas strip_canvas(200, 200);
+    build_polyline_strips(sphere, strips);
+    renderer_wireframe_strips(strip_canvas, sphere, strips, mat4::translation(0, 0, -4), mat4::identity(), projection, 200, 200);
+    float ink = 0.0f;
+    for (int y = 0; y < 200; y++)
+        for (int x = 0; x < 200; x++)
+            ink += strip_canvas.pixels[y][x];
+    check("strip renderer draws", ink > 0.0f);
+
+    // ---- Morph targets ----
+    {
+        const int N = 1000;
+        std::vector<float> rest(N * 3), raised(N * 3), stretched(N * 3);
+        for (int i = 0; i < N * 3; i++)
+            rest[i] = raised[i] = stretched[i] = (float)(i % 17) - 8.0f;
+        for (int v = 100; v < 200; v++)
+            raised[v * 3 + 1] += 2.0f; // one block of 100
+        for (int v = 0; v < N; v += 50)
+            stretched[v * 3] *= 1.5f; // scattered, every 50th
+        stretched[203 * 3 + 2] += 1.0f;
+        stretched[205 * 3 + 2] += 1.0f; // a gap of one
+
+        MorphSet morph;
+        morph.set_base(rest.data(), N);
+        int up = morph.add_target(raised.data(), N);
+        int wide = morph.add_target(stretched.data(), N);
+        check("mismatched target rejected", morph.add_target(raised.data(), N - 1) == -1 && morph.target_count() == 2);
+        check("targets store only moved vertices", morph.target_vertices(up) == 100 &&
+                                                       morph.target_vertices(wide) < 40);
+
+        std::vector<float> out(N * 3);
+        float weights[2] = {0.0f, 0.0f};
+        morph.blend(weights, out.data());
+        check("zero weights give the base", out == rest);
+
+        weights[up] = 0.25f;
+        weights[wide] = -0.5f;
+        morph.blend(weights, out.data());
+        float worst = 0.0f;
+        for (int i = 0; i < N * 3; i++)
+        {
+            float expected = rest[i] + 0.25f * (raised[i] - rest[i]) - 0.5f * (stretched[i] - rest[i]);
+            worst = std::max(worst, std::fabs(out[i] - expected));
+        }
+        check("blend matches the dense sum", worst < 1e-5f);
+    }
+
+    // ---- Silhouettes ----
+    SilhouetteExtractor outline;
+    check("faceless mesh rejected", !outline.attach(mesh));
+    check("faced mesh attached", outline.attach(faced));
+
+    float eye_front[3] = {0, 0, 10};
+    outline.update(eye_front);
+    check("cube head-on: 1 face, 4 edges", outline.stats().faces_front == 1 &&
+                                              outline.visible_edges().size() == 4 && outline.silhouette().size() == 4);
+
+    float eye_corner[3] = {5, 5, 5};
+    outline.update(eye_corner);
+    check("cube from a corner: 3 faces, 9 edges, 6 on the outline",
+          outline.stats().faces_front == 3 && outline.visible_edges().size() == 9 && outline.silhouette().size() == 6);
+
+    // Faced lat/long sphere, wound counter-clockwise from outside
+    std::vector<int> sphere_faces;
+    for (int j = 0; j < LAT; j++)
+        for (int i = 0; i < LON; i++)
+        {
+            int a = j * LON + i, b = j * LON + (i + 1) % LON;
+            sphere_faces.insert(sphere_faces.end(), {a, b, b + LON, a + LON});
+        }
+    std::vector<int> quad_sizes(LAT * LON, 4);
+    Mesh faced_sphere;
+    faced_sphere.build(sphere_xyz.data(), (int)sphere_xyz.size() / 3, nullptr, 0,
+                       quad_sizes.data(), LAT * LON, sphere_faces.data());
+
+    // Orbit the eye; the incremental set must match a fresh extraction every step
+    SilhouetteExtractor orbit;
+    orbit.attach(faced_sphere);
+    bool coherent = true;
+    int flipped = 0;
+    for (int step = 0; step < 40; step++)
+    {
+        float a = step * 0.05f;
+        float eye[3] = {6.0f * sinf(a), 1.0f, 6.0f * cosf(a)};
+        orbit.update(eye);
+        if (step > 0)
+            flipped += orbit.stats().faces_changed;
+
+        SilhouetteExtractor fresh;
+        fresh.attach(faced_sphere);
+        fresh.update(eye);
+
+        std::vector<int> x = orbit.visible_edges(), y = fresh.visible_edges();
+        std::vector<int> sx = orbit.silhouette(), sy = fresh.silhouette();
+        std::sort(x.begin(), x.end());
+        std::sort(y.begin(), y.end());
+        std::sort(sx.begin(), sx.end());
+        std::sort(sy.begin(), sy.end());
+        coherent = coherent && x == y && sx == sy;
+    }
+    std::cout << "  sphere: " << orbit.stats().edges_visible << " of " << faced_sphere.edge_count()
+              << " edges visible, " << orbit.stats().silhouette_edges << " silhouette, "
+              << flipped / 39 << " faces flipped per step\n";
+    check("incremental update matches full extraction", coherent);
+    check("roughly half the edges culled", orbit.stats().edges_visible < faced_sphere.edge_count() * 0.6f);
+    check("only a band of faces flips per step", flipped / 39 < LAT * LON / 10);
+
+    Canvas outline_canvas(200, 200);
+    renderer_wireframe_visible(outline_canvas, faced_sphere, orbit, mat4::translation(0, 0, -4), mat4::identity(), projection, 200, 200);
+    float outline_ink = 0.0f;
+    for (int y = 0; y < 200; y++)
+        for (int x = 0; x < 200; x++)
+            outline_ink += outline_canvas.pixels[y][x];
+    check("visible-edge renderer draws", outline_ink > 0.0f);
+
+    std::cout << "\n=== Test Complete (" << failures << " failures) ===\n";
+    return failures == 0 ? 0 : 1;
+}
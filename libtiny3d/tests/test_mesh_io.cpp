@@ -0,0 +1,224 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "mesh.h"
+#include "mesh_io.h"
+#include "mesh_binary.h"
+#include "canvas.h"
+#include "renderer.h"
+#include <cmath>
+
+static int failures = 0;
+
+static float canvas_ink(const Canvas &c)
+{
+    float sum = 0.0f;
+    for (int y = 0; y < c.height; y++)
+        for (int x = 0; x < c.width; x++)
+            sum += c.pixels[y][x];
+    return sum;
+}
+
+static void check(const char *label, bool ok)
+{
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << label << "\n";
+    if (!ok)
+        failures++;
+}
+
+// Unit cube as 6 quads
+static const char *CUBE_OBJ =
+    "# cube\n"
+    "o cube\n"
+    "v -1 -1 -1\nv 1 -1 -1\nv 1 1 -1\nv -1 1 -1\n"
+    "v -1 -1 1\nv 1 -1 1\nv 1 1 1\r\nv -1 1 1\n"
+    "vn 0 0 1\n"
+    "f 1 4 3 2\nf 5/1 6/1 7/1 8/1\nf 1//1 2//1 6//1 5//1\n"
+    "f 2 3 7 6\nf 3 4 8 7\nf -8 -4 -1 -5\n"
+    "l 1 7\n";
+
+int main()
+{
+    std::cout << "=== Mesh IO Test ===\n\n";
+
+    // ---- OBJ ----
+    Mesh mesh;
+    MeshLoadInfo info;
+    bool ok = parse_obj(CUBE_OBJ, std::strlen(CUBE_OBJ), mesh, &info);
+    check("OBJ parses", ok);
+    check("OBJ 8 vertices, 6 faces", mesh.vertex_count() == 8 && mesh.face_count() == 6);
+    check("OBJ 12 face edges + 1 polyline edge", mesh.edge_count() == 13);
+    check("OBJ CRLF line parses", mesh.position_data()[6 * 3 + 2] == 1.0f);
+
+    const char *bad_obj = "v 0 0 0\nv 1 0 0\nf 1 2 9\n";
+    ok = parse_obj(bad_obj, std::strlen(bad_obj), mesh, &info);
+    check("OBJ out-of-range index skipped", ok && info.skipped == 2 && mesh.face_count() == 0);
+
+    // 2^32 + 1 must not wrap onto vertex 1; overflowing digits are malformed
+    const char *wide_obj = "v 0 0 0\nv 1 0 0\nv 0 1 0\nl 2 4294967297\nl 1 99999999999999999999999\nl -4 3\nl 3 -3\n";
+    ok = parse_obj(wide_obj, std::strlen(wide_obj), mesh, &info);
+    check("OBJ 64-bit and overflowing indices skipped", ok && info.skipped == 3 && mesh.edge_count() == 1);
+
+    // ---- ASCII PLY ----
+    const char *ply_ascii =
+        "ply\nformat ascii 1.0\ncomment tetra\n"
+        "element vertex 4\nproperty float x\nproperty float y\nproperty float z\nproperty uchar red\n"
+        "element face 4\nproperty list uchar int vertex_indices\n"
+        "end_header\n"
+        "0 0 0 255\n1 0 0 255\n0 1 0 255\n0 0 1.5e0 255\n"
+        "3 0 2 1\n3 0 1 3\n3 1 2 3\n3 0 3 2\n";
+
+    ok = parse_ply(reinterpret_cast<const unsigned char *>(ply_ascii), std::strlen(ply_ascii), mesh, &info);
+    check("ASCII PLY parses", ok);
+    check("ASCII PLY tetrahedron: 4 faces, 6 edges", mesh.face_count() == 4 && mesh.edge_count() == 6);
+    check("ASCII PLY z = 1.5", mesh.position_data()[3 * 3 + 2] == 1.5f);
+
+    // ---- Binary little-endian PLY with an edge element ----
+    std::string header =
+        "ply\nformat binary_little_endian 1.0\n"
+        "element vertex 3\nproperty float x\nproperty float y\nproperty float z\n"
+        "element edge 2\nproperty int vertex1\nproperty int vertex2\n"
+        "end_header\n";
+    std::vector<unsigned char> bin(header.begin(), header.end());
+    float verts[9] = {0, 0, 0, 2, 0, 0, 0, 3, 0};
+    int edges[4] = {0, 1, 1, 2};
+    bin.insert(bin.end(), (unsigned char *)verts, (unsigned char *)verts + sizeof(verts));
+    bin.insert(bin.end(), (unsigned char *)edges, (unsigned char *)edges + sizeof(edges));
+
+    ok = parse_ply(bin.data(), bin.size(), mesh, &info);
+    check("binary PLY parses", ok);
+    check("binary PLY 3 vertices, 2 edges", mesh.vertex_count() == 3 && mesh.edge_count() == 2);
+    check("binary PLY aabb", mesh.aabb().max[0] == 2.0f && mesh.aabb().max[1] == 3.0f);
+
+    check("truncated binary PLY rejected", !parse_ply(bin.data(), bin.size() - 4, mesh, &info));
+
+    // Header counts larger than the data are rejected before anything is reserved
+    std::string hostile =
+        "ply\nformat binary_little_endian 1.0\n"
+        "element vertex 4000000000000\nproperty float x\nproperty float y\nproperty float z\n"
+        "end_header\n";
+    hostile.append(12, '\0');
+    check("huge PLY vertex count rejected",
+          !parse_ply(reinterpret_cast<const unsigned char *>(hostile.data()), hostile.size(), mesh, &info) && info.error);
+    const char *ply_counts[2] = {"1000000000000", "-1"};
+    for (int i = 0; i < 2; i++)
+    {
+        std::string bad_list =
+            "ply\nformat ascii 1.0\n"
+            "element vertex 3\nproperty float x\nproperty float y\nproperty float z\n"
+            "element face 1\nproperty list uchar int vertex_indices\nend_header\n"
+            "0 0 0\n1 0 0\n0 1 0\n";
+        bad_list += std::string(ply_counts[i]) + " 0 1 2\n";
+        check(i ? "negative PLY list count rejected" : "huge PLY list count rejected",
+              !parse_ply(reinterpret_cast<const unsigned char *>(bad_list.data()), bad_list.size(), mesh, &info) && info.error);
+    }
+    std::string bad_edge =
+        "ply\nformat ascii 1.0\n"
+        "element vertex 2\nproperty float x\nproperty float y\nproperty float z\n"
+        "element edge 1\nproperty int vertex1\nproperty int vertex2\nend_header\n"
+        "0 0 0\n1 0 0\n0 1e12\n";
+    check("huge PLY edge index rejected",
+          !parse_ply(reinterpret_cast<const unsigned char *>(bad_edge.data()), bad_edge.size(), mesh, &info) && info.error);
+    check("ASCII PLY without a final newline parses",
+          parse_ply(reinterpret_cast<const unsigned char *>(ply_ascii), std::strlen(ply_ascii) - 1, mesh, &info));
+
+    // ---- Round trip through a mapped file ----
+    const char *path = "test_mesh_io_cube.obj";
+    FILE *f = std::fopen(path, "wb");
+    if (f)
+    {
+        std::fwrite(CUBE_OBJ, 1, std::strlen(CUBE_OBJ), f);
+        std::fclose(f);
+    }
+    ok = load_mesh(path, mesh, &info);
+    std::remove(path);
+    check("load_mesh maps and parses OBJ file", ok && mesh.edge_count() == 13);
+    check("missing file reported", !load_mesh("does_not_exist.obj", mesh, &info) && info.error);
+
+    // ---- Binary .t3dm round trip ----
+    std::cout << "\nBinary mesh format:\n";
+    parse_obj(CUBE_OBJ, std::strlen(CUBE_OBJ), mesh, &info);
+
+    const char *bin_path = "test_mesh_io_cube.t3dm";
+    for (int quantize = 0; quantize < 2; quantize++)
+    {
+        MeshView view;
+        ok = write_mesh_binary(mesh, bin_path, quantize != 0) && view.open(bin_path);
+        check(quantize ? "quantized file maps" : "float file maps", ok);
+        if (!ok)
+            continue;
+
+        check("16-bit indices chosen", view.index16());
+        check("counts match", view.vertex_count() == 8 && view.edge_count() == 13);
+
+        float max_err = 0.0f;
+        for (int i = 0; i < view.vertex_count(); i++)
+        {
+            float p[3];
+            view.position(i, p);
+            for (int k = 0; k < 3; k++)
+                max_err = std::fmax(max_err, std::fabs(p[k] - mesh.position_data()[i * 3 + k]));
+        }
+        check("positions round trip", max_err <= (quantize ? 2.0f / 65535.0f : 0.0f));
+
+        bool edges_same = true;
+        for (int e = 0; e < view.edge_count(); e++)
+        {
+            int a, b;
+            view.edge(e, a, b);
+            edges_same = edges_same && a == mesh.edge_data()[e][0] && b == mesh.edge_data()[e][1];
+        }
+        check("edges round trip", edges_same);
+        view.close();
+    }
+    std::remove(bin_path);
+
+    unsigned char junk[96] = {'T', '3', 'D', 'X'};
+    MeshView bad_view;
+    check("bad magic rejected", !bad_view.attach(junk, sizeof(junk)));
+
+    // Two vertices and one edge built by hand, then corrupted
+    alignas(16) unsigned char buffer[128] = {0};
+    MeshFileHeader hand = {};
+    std::memcpy(hand.magic, MESH_FILE_MAGIC, 4);
+    hand.version = MESH_FILE_VERSION;
+    hand.vertex_count = 2;
+    hand.edge_count = 1;
+    hand.positions_offset = 80;
+    hand.edges_offset = 112;
+    uint32_t pair[2] = {0, 1};
+    std::memcpy(buffer + 112, pair, sizeof(pair));
+
+    std::memcpy(buffer, &hand, sizeof(hand));
+    check("hand-built file attaches", bad_view.attach(buffer, sizeof(buffer)) && bad_view.validate());
+    mat4 near_view = mat4::translation(0, 0, -5);
+    mat4 frustum = mat4::frustumAssymetric(-1, 1, -1, 1, 1, 50);
+    Canvas good_canvas(64, 64);
+    renderer_wireframe(good_canvas, bad_view, mat4::identity(), near_view, frustum, 64, 64);
+    check("hand-built edge drawn", canvas_ink(good_canvas) > 0.0f);
+
+    MeshFileHeader wrapped = hand;
+    wrapped.positions_offset = 0xFFFFFFFFFFFFFFF0ull;
+    std::memcpy(buffer, &wrapped, sizeof(wrapped));
+    check("wrapping positions offset rejected", !bad_view.attach(buffer, sizeof(buffer)));
+
+    wrapped = hand;
+    wrapped.edges_offset = 0xFFFFFFFFFFFFFFF0ull;
+    wrapped.edge_count = 2;
+    std::memcpy(buffer, &wrapped, sizeof(wrapped));
+    check("wrapping edges offset rejected", !bad_view.attach(buffer, sizeof(buffer)));
+
+    pair[1] = 2;
+    std::memcpy(buffer, &hand, sizeof(hand));
+    std::memcpy(buffer + 112, pair, sizeof(pair));
+    check("edge index past vertex count attaches (no scan at open)", bad_view.attach(buffer, sizeof(buffer)));
+    check("validate() finds the bad edge index", !bad_view.validate());
+    Canvas canvas(64, 64);
+    renderer_wireframe(canvas, bad_view, mat4::identity(), near_view, frustum, 64, 64);
+    check("bad edge skipped while drawing", canvas_ink(canvas) == 0.0f);
+
+    std::cout << "\n=== Test Complete (" << failures << " failures) ===\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include "math3d.h"
+#include "canvas.h"
+#include "mesh.h"
+#include "raster.h"
+#include "hiz.h"
+#include "points.h"
+
+static int failures = 0;
+
+static void check(const char *label, bool ok)
+{
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << label << "\n";
+    if (!ok)
+        failures++;
+}
+
+static float canvas_sum(const Canvas &c)
+{
+    float sum = 0.0f;
+    for (int y = 0; y < c.height; y++)
+        for (int x = 0; x < c.width; x++)
+            sum += c.pixels[y][x];
+    return sum;
+}
+
+static void clear_canvas(Canvas &c)
+{
+    for (int y = 0; y < c.height; y++)
+        for (int x = 0; x < c.width; x++)
+            c.pixels[y][x] = 0.0f;
+}
+
+static bool same_canvas(const Canvas &a, const Canvas &b)
+{
+    for (int y = 0; y < a.height; y++)
+        for (int x = 0; x < a.width; x++)
+            if (a.pixels[y][x] != b.pixels[y][x])
+                return false;
+    return true;
+}
+
+int main()
+{
+    std::cout << "=== Raster Test ===\n\n";
+
+    // ---- Coverage: a 16x16 square as two triangles sharing a diagonal ----
+    Canvas canvas(100, 100);
+    DepthBuffer depth(100, 100);
+    RasterVertex square[6] = {
+        {10, 10, 0.5f, 1}, {26, 10, 0.5f, 1}, {26, 26, 0.5f, 1},
+        {10, 10, 0.5f, 1}, {26, 26, 0.5f, 1}, {10, 26, 0.5f, 1}};
+    RasterStats stats;
+    rasterize_triangles(canvas, depth, square, 2, SHADE_FLAT, 1, &stats);
+    check("shared edge written once", stats.pixels_written == 256 && canvas_sum(canvas) == 256.0f);
+    check("depth stored", depth.at(12, 12) == 0.5f && depth.at(30, 30) == 1.0f);
+
+    // ---- Depth test is order independent ----
+    RasterVertex near_tri[3] = {{0, 0, 0.2f, 0.25f}, {60, 0, 0.2f, 0.25f}, {0, 60, 0.2f, 0.25f}};
+    RasterVertex far_tri[3] = {{0, 0, 0.8f, 0.75f}, {70, 0, 0.8f, 0.75f}, {0, 70, 0.8f, 0.75f}};
+    RasterVertex order_a[6], order_b[6];
+    for (int i = 0; i < 3; i++)
+    {
+        order_a[i] = near_tri[i];
+        order_a[i + 3] = far_tri[i];
+        order_b[i] = far_tri[i];
+        order_b[i + 3] = near_tri[i];
+    }
+    Canvas first(100, 100), second(100, 100);
+    DepthBuffer depth_a(100, 100), depth_b(100, 100);
+    rasterize_triangles(first, depth_a, order_a, 2, SHADE_FLAT, 1);
+    rasterize_triangles(second, depth_b, order_b, 2, SHADE_FLAT, 1);
+    check("near triangle wins", first.pixels[10][10] == 0.25f && first.pixels[5][62] == 0.75f);
+    check("draw order does not matter", same_canvas(first, second));
+
+    // ---- Gouraud ----
+    clear_canvas(canvas);
+    depth.clear();
+    RasterVertex ramp[3] = {{0, 0, 0.5f, 0.0f}, {100, 0, 0.5f, 1.0f}, {0, 100, 0.5f, 0.0f}};
+    rasterize_triangles(canvas, depth, ramp, 1, SHADE_GOURAUD, 1);
+    check("gouraud interpolates", std::fabs(canvas.pixels[10][50] - 0.505f) < 1e-3f);
+
+    // ---- Mesh front end: faced cube ----
+    float cube_xyz[24] = {
+        -1, -1, -1, 1, -1, -1, 1, 1, -1, -1, 1, -1,
+        -1, -1, 1, 1, -1, 1, 1, 1, 1, -1, 1, 1};
+    const int sizes[6] = {4, 4, 4, 4, 4, 4};
+    const int quads[24] = {
+        0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4,
+        1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7};
+    Mesh cube;
+    cube.build(cube_xyz, 8, nullptr, 0, sizes, 6, quads);
+
+    Light light = {vec3_t(0, 0, -1), 1.0f};
+    mat4 projection = mat4::frustumAssymetric(-1, 1, -1, 1, 1, 50);
+    mat4 view = mat4::translation(0, 0, -5);
+    mat4 model = mat4::rotation_xyz(0.4f, 0.6f, 0.0f);
+
+    SolidOptions options = default_solid_options();
+    Canvas solid(256, 256);
+    DepthBuffer solid_depth(256, 256);
+    render_mesh_solid(solid, solid_depth, cube, model, view, projection, &light, 1, options, &stats);
+    std::cout << "  cube: " << stats.triangles_in << " triangles, " << stats.triangles_culled
+              << " culled, " << stats.pixels_written << " pixels\n";
+    check("back faces culled", stats.triangles_in == 12 && stats.triangles_culled == 6);
+    check("cube drawn", stats.pixels_written > 0 && canvas_sum(solid) > 0.0f);
+
+    // Behind a full-screen occluder every block fails the depth test early
+    RasterVertex wall[6] = {
+        {0, 0, 0.1f, 0}, {256, 0, 0.1f, 0}, {256, 256, 0.1f, 0},
+        {0, 0, 0.1f, 0}, {256, 256, 0.1f, 0}, {0, 256, 0.1f, 0}};
+    solid_depth.clear();
+    rasterize_triangles(solid, solid_depth, wall, 2, SHADE_FLAT, 1);
+    render_mesh_solid(solid, solid_depth, cube, model, view, projection, &light, 1, options, &stats);
+    check("early-z rejects hidden blocks", stats.blocks_rejected_z > 0 && stats.pixels_written == 0);
+
+    // Tile threads give identical output
+    Canvas threaded(256, 256);
+    DepthBuffer threaded_depth(256, 256);
+    Canvas single(256, 256);
+    DepthBuffer single_depth(256, 256);
+    options.threads = 4;
+    render_mesh_solid(threaded, threaded_depth, cube, model, view, projection, &light, 1, options);
+    options.threads = 1;
+    render_mesh_solid(single, single_depth, cube, model, view, projection, &light, 1, options);
+    check("threaded matches single-threaded", same_canvas(threaded, single));
+
+    // Point and spot lights in front of the facing side, in flat and Gouraud
+    for (int mode = 0; mode < 2; mode++)
+    {
+        SolidOptions lit_options = default_solid_options();
+        lit_options.mode = mode ? SHADE_GOURAUD : SHADE_FLAT;
+        Light local[4] = {
+            Light::point(vec3_t(0, 0, 8), 1.0f, 20.0f),
+            Light::point(vec3_t(0, 0, 8), 1.0f, 1.0f),
+            Light::spot(vec3_t(0, 0, 8), vec3_t(0, 0, -1), 1.0f, 20.0f, 0.5f, 0.8f),
+            Light::spot(vec3_t(0, 0, 8), vec3_t(0, 0, 1), 1.0f, 20.0f, 0.5f, 0.8f)};
+        float sums[5]; // the last one unlit
+        for (int i = 0; i < 5; i++)
+        {
+            Canvas c(64, 64);
+            DepthBuffer d(64, 64);
+            render_mesh_solid(c, d, cube, mat4::identity(), view, projection, local + i % 4, i < 4 ? 1 : 0, lit_options);
+            sums[i] = canvas_sum(c);
+        }
+        float ambient = sums[4];
+        check(mode ? "Gouraud point light in range shades" : "flat point light in range shades", sums[0] > ambient * 2.0f);
+        check(mode ? "Gouraud point light out of range adds nothing" : "flat point light out of range adds nothing",
+              sums[1] == ambient);
+        check(mode ? "Gouraud spot toward the cube shades" : "flat spot toward the cube shades", sums[2] > ambient * 2.0f);
+        check(mode ? "Gouraud spot facing away adds nothing" : "flat spot facing away adds nothing", sums[3] == ambient);
+    }
+
+    // Camera inside the cube: near-plane clipping, culling off to see the inside
+    options.cull_backfaces = false;
+    options.mode = SHADE_FLAT;
+    Canvas inside(64, 64);
+    DepthBuffer inside_depth(64, 64);
+    render_mesh_solid(inside, inside_depth, cube, mat4::scale(3, 3, 3), mat4::identity(), projection, &light, 1, options, &stats);
+    bool filled = true;
+    for (int y = 0; y < 64; y++)
+        for (int x = 0; x < 64; x++)
+            filled = filled && inside_depth.at(x, y) < 1.0f;
+    check("near-clipped interior fills the screen", filled);
+
+    // ---- Hierarchical-Z occlusion ----
+    // Wall 8 x 8 at z = -5 in front of a camera at the origin looking down -z
+    SceneObject scene[5] = {
+        {&cube, multiply(mat4::translation(0, 0, -5), mat4::scale(4, 4, 0.2f))},
+        {&cube, mat4::translation(0, 0, -15)},                                      // behind the wall
+        {&cube, mat4::translation(12, 0, -15)},                                     // partly past its edge
+        {&cube, multiply(mat4::translation(0, 0, -3), mat4::scale(0.5f, 0.5f, 0.5f))}, // in front of it
+        {&cube, mat4::translation(0, 0, -1)}};                                      // crossing the near plane
+
+    HiZBuffer hiz;
+    OcclusionStats occlusion;
+    int candidates[4] = {1, 2, 3, 4};
+    int unoccluded[4];
+    int kept = occlusion_cull(hiz, scene, candidates, 4, mat4::identity(), projection, unoccluded, &occlusion);
+    check("empty pyramid passes everything", kept == 4 && occlusion.occluded == 0);
+
+    hiz.build_from_occluders(scene, 1, mat4::identity(), projection, 128, 128);
+    check("pyramid levels", hiz.level_count() == 5 && hiz.level_width(0) == 16 && hiz.level_width(4) == 1);
+    kept = occlusion_cull(hiz, scene, candidates, 4, mat4::identity(), projection, unoccluded, &occlusion);
+    check("box behind the wall culled", kept == 3 && occlusion.occluded == 1 && unoccluded[0] == 2);
+    check("edge, front and near boxes kept", unoccluded[1] == 3 && unoccluded[2] == 4);
+
+    // Same result from a full-resolution depth buffer of the wall
+    Canvas wall_canvas(256, 256);
+    DepthBuffer wall_depth(256, 256);
+    render_mesh_solid(wall_canvas, wall_depth, cube, scene[0].model, mat4::identity(), projection, &light, 1, default_solid_options());
+    hiz.build(wall_depth);
+    kept = occlusion_cull(hiz, scene, candidates, 4, mat4::identity(), projection, unoccluded, &occlusion);
+    check("pyramid from a depth buffer", kept == 3 && unoccluded[0] == 2);
+
+    // ---- Point splatting ----
+    // Identity mvp: NDC in, so positions map straight to pixels
+    Canvas dots(64, 64);
+    float seven[21] = {
+        0, 0, 0, -0.5f, 0.5f, 0, 0.5f, -0.5f, 0, 2, 0, 0,     // SIMD group, one off screen
+        0.25f, 0.25f, 0, 0, 0, -2, 0.99f, -0.99f, 0};         // scalar tail, one past near
+    PointOptions point_options = default_point_options();
+    point_options.threads = 1;
+    PointStats point_stats;
+    render_points(dots, nullptr, seven, nullptr, 7, mat4::identity(), point_options, &point_stats);
+    check("points clipped", point_stats.points_drawn == 5 && point_stats.points_clipped == 2);
+    check("points land on pixels", dots.pixels[32][32] == 1.0f && dots.pixels[16][16] == 1.0f &&
+                                       dots.pixels[48][48] == 1.0f && dots.pixels[24][40] == 1.0f &&
+                                       dots.pixels[63][63] == 1.0f && canvas_sum(dots) == 5.0f);
+
+    // Nearest point wins with a depth buffer, whatever the order
+    float stacked[6] = {0, 0, 0.5f, 0, 0, -0.5f};
+    float stacked_value[2] = {0.3f, 0.7f};
+    DepthBuffer dot_depth(64, 64);
+    clear_canvas(dots);
+    render_points(dots, &dot_depth, stacked, stacked_value, 2, mat4::identity(), point_options);
+    check("nearest point wins", dots.pixels[32][32] == 0.7f && dot_depth.at(32, 32) == 0.25f);
+
+    // Size by distance: w = 1 with reference 4 gives a 4x4 splat
+    clear_canvas(dots);
+    point_options.size_by_distance = true;
+    point_options.reference_distance = 4.0f;
+    render_points(dots, nullptr, seven, nullptr, 1, mat4::identity(), point_options);
+    check("size by distance", canvas_sum(dots) == 16.0f && dots.pixels[31][31] == 1.0f && dots.pixels[34][34] == 1.0f);
+
+    // Banded multi-threaded splatting matches the single-threaded path
+    std::vector<float> cloud(300000 * 3);
+    unsigned seed = 7;
+    for (float &v : cloud)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        v = (seed >> 8) / 16777216.0f * 2.2f - 1.1f;
+    }
+    point_options = default_point_options();
+    point_options.size = 3.0f;
+    Canvas cloud_single(200, 150), cloud_threaded(200, 150);
+    DepthBuffer cloud_depth_single(200, 150), cloud_depth_threaded(200, 150);
+    point_options.threads = 1;
+    render_points(cloud_single, &cloud_depth_single, cloud.data(), nullptr, 300000, mat4::identity(), point_options);
+    point_options.threads = 4;
+    render_points(cloud_threaded, &cloud_depth_threaded, cloud.data(), nullptr, 300000, mat4::identity(), point_options, &point_stats);
+    check("threaded depth splats match", same_canvas(cloud_single, cloud_threaded));
+    clear_canvas(cloud_single);
+    clear_canvas(cloud_threaded);
+    point_options.threads = 1;
+    render_points(cloud_single, nullptr, cloud.data(), nullptr, 300000, mat4::identity(), point_options);
+    point_options.threads = 4;
+    render_points(cloud_threaded, nullptr, cloud.data(), nullptr, 300000, mat4::identity(), point_options);
+    check("threaded additive splats match", same_canvas(cloud_single, cloud_threaded));
+
+    std::cout << "\n=== Test Complete (" << failures << " failures) ===\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,407 @@
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
+#include "math3d.h"
+#include "canvas.h"
+#include "culling.h"
+#include "bvh.h"
+#include "edge_reduce.h"
+#include "renderer.h"
+#include "chunked_scene.h"
+#include "transform.h"
+
+static int failures = 0;
+
+static std::vector<unsigned char> file_bytes(const char *path)
+{
+    std::vector<unsigned char> bytes;
+    FILE *f = std::fopen(path, "rb");
+    if (!f)
+        return bytes;
+    unsigned char block[4096];
+    for (size_t n; (n = std::fread(block, 1, sizeof(block), f)) > 0;)
+        bytes.insert(bytes.end(), block, block + n);
+    std::fclose(f);
+    return bytes;
+}
+
+static bool write_bytes(const char *path, const std::vector<unsigned char> &bytes)
+{
+    FILE *f = std::fopen(path, "wb");
+    if (!f)
+        return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+static void check(const char *label, bool ok)
+{
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << label << "\n";
+    if (!ok)
+        failures++;
+}
+
+static float canvas_sum(const Canvas &c)
+{
+    float sum = 0.0f;
+    for (int y = 0; y < c.height; y++)
+        for (int x = 0; x < c.width; x++)
+            sum += c.pixels[y][x];
+    return sum;
+}
+
+int main()
+{
+    std::cout << "=== Scene Test ===\n\n";
+
+    mat4 view = mat4::identity();
+    mat4 projection = mat4::frustumAssymetric(-1, 1, -1, 1, 1, 50);
+    Frustum frustum = Frustum::from_matrix(multiply(projection, view));
+
+    // ---- Frustum planes ----
+    float ahead[3] = {0, 0, -10};
+    float behind[3] = {0, 0, 10};
+    float beyond_far[3] = {0, 0, -60};
+    float left[3] = {-30, 0, -10};
+    check("sphere ahead visible", frustum_intersects_sphere(frustum, ahead, 1.0f));
+    check("sphere behind culled", !frustum_intersects_sphere(frustum, behind, 1.0f));
+    check("sphere beyond far culled", !frustum_intersects_sphere(frustum, beyond_far, 1.0f));
+    check("sphere off to the left culled", !frustum_intersects_sphere(frustum, left, 1.0f));
+    check("large sphere straddling near plane visible", frustum_intersects_sphere(frustum, behind, 12.0f));
+
+    AABB box_in = {{-1, -1, -6}, {1, 1, -4}};
+    AABB box_out = {{20, 20, -6}, {22, 22, -4}};
+    check("aabb in view", frustum_intersects_aabb(frustum, box_in));
+    check("aabb outside", !frustum_intersects_aabb(frustum, box_out));
+
+    // ---- Object culling ----
+    vec3_t cube[8] = {
+        {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+        {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}};
+    const int cube_edges[12][2] = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+    Mesh cube_mesh;
+    cube_mesh.build(cube, 8, cube_edges, 12);
+
+    // 10 x 10 grid of cubes on the z = -10 plane, spaced 4 apart: only the middle few are in view
+    std::vector<SceneObject> objects;
+    for (int gy = 0; gy < 10; gy++)
+        for (int gx = 0; gx < 10; gx++)
+        {
+            SceneObject obj;
+            obj.mesh = &cube_mesh;
+            obj.model = multiply(
+                mat4::translation(-18.0f + gx * 4.0f, -18.0f + gy * 4.0f, -10.0f),
+                mat4::scale(0.5f, 0.5f, 0.5f));
+            objects.push_back(obj);
+        }
+    SceneObject behind_obj;
+    behind_obj.mesh = &cube_mesh;
+    behind_obj.model = mat4::translation(0, 0, 10);
+    objects.push_back(behind_obj);
+
+    AABB world = transform_aabb(cube_mesh.aabb(), objects[0].model);
+    check("transform_aabb", world.min[0] == -18.5f && world.max[2] == -9.5f);
+
+    Canvas scene_canvas(200, 200);
+    CullStats cull;
+    render_scene(scene_canvas, objects.data(), (int)objects.size(), view, projection, 200, 200, &cull);
+    std::cout << "  objects tested " << cull.tested << ", culled " << cull.culled << ", drawn " << cull.drawn << "\n";
+    check("most objects culled", cull.drawn == 36 && cull.culled == 65);
+    check("culled scene still draws", canvas_sum(scene_canvas) > 0.0f);
+
+    // ---- BVH ----
+    SceneBVH bvh;
+    bvh.build(objects.data(), (int)objects.size());
+    std::vector<int> brute(objects.size());
+    brute.resize(cull_objects(objects.data(), (int)objects.size(), frustum, brute.data()));
+    std::vector<int> hits;
+    bvh.query_frustum(frustum, hits);
+    std::sort(hits.begin(), hits.end());
+    check("bvh frustum query matches brute force", hits == brute);
+
+    // Random scatter, then move everything and refit
+    std::vector<SceneObject> scatter;
+    std::srand(7);
+    for (int i = 0; i < 3000; i++)
+    {
+        SceneObject obj;
+        obj.mesh = &cube_mesh;
+        obj.model = mat4::translation(
+            (std::rand() % 2000) * 0.05f - 50.0f,
+            (std::rand() % 2000) * 0.05f - 50.0f,
+            (std::rand() % 2000) * -0.03f);
+        scatter.push_back(obj);
+    }
+    bool bvh_match = true;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if (pass == 0)
+            bvh.build(scatter.data(), (int)scatter.size());
+        else
+        {
+            for (SceneObject &obj : scatter)
+                obj.model = multiply(mat4::translation(3.0f, -2.0f, 1.0f), obj.model);
+            bvh.refit(scatter.data());
+        }
+        brute.resize(scatter.size());
+        brute.resize(cull_objects(scatter.data(), (int)scatter.size(), frustum, brute.data()));
+        hits.clear();
+        bvh.query_frustum(frustum, hits);
+        std::sort(hits.begin(), hits.end());
+        bvh_match = bvh_match && hits == brute && !hits.empty();
+    }
+    check("bvh build and refit match brute force", bvh_match);
+
+    // Pick through the front top-right corner (2.5, 2.5, -9.5) of object 55
+    bvh.build(objects.data(), (int)objects.size());
+    float origin[3], dir[3];
+    bool ray_ok = ray_from_screen(view, projection, 100.0f * (1.0f + 2.5f / 9.5f), 100.0f * (1.0f - 2.5f / 9.5f), 200, 200, origin, dir);
+    check("ray from screen", ray_ok);
+    EdgePick pick = bvh.pick_edge(objects.data(), origin, dir, 0.05f);
+    EdgePick brute_pick = {-1, -1, 0.0f, 1e30f};
+    for (int i = 0; i < (int)objects.size(); i++)
+        pick_object_edge(objects[i], i, origin, dir, 0.05f, brute_pick);
+    bool on_corner = pick.object == 55 && pick.distance < 1e-3f &&
+                     (cube_mesh.edge_data()[pick.edge][0] == 6 || cube_mesh.edge_data()[pick.edge][1] == 6);
+    check("pick hits the corner edge", on_corner);
+    check("pick matches brute force", pick.object == brute_pick.object && pick.t == brute_pick.t);
+    float away[3] = {0.0f, 0.0f, -1.0f};
+    check("pick miss", bvh.pick_edge(objects.data(), origin, away, 0.05f).object == -1);
+
+    std::vector<int> selected;
+    bvh.select_rect(objects.data(), view, projection, 110, 70, 130, 90, 200, 200, selected);
+    check("rect selects the object under it", selected.size() == 1 && selected[0] == 55);
+    selected.clear();
+    bvh.select_rect(objects.data(), view, projection, 128, 128, 150, 150, 200, 200, selected);
+    check("rect between objects selects nothing", selected.empty());
+
+    // ---- Screen-space edge reduction ----
+    // An L: 60 one-pixel steps right, a repeated pixel, 40 steps down; then one edge far off screen
+    std::vector<ScreenVertex> pts;
+    std::vector<int> pairs;
+    for (int i = 0; i <= 60; i++)
+        pts.push_back({10 + i, 50, 0.5f});
+    pts.push_back({70, 50, 0.5f});
+    for (int i = 1; i <= 40; i++)
+        pts.push_back({70, 50 + i, 0.5f});
+    for (int i = 0; i + 1 < (int)pts.size(); i++)
+        pairs.insert(pairs.end(), {i, i + 1});
+    pts.push_back({-500, -500, 0.5f});
+    pts.push_back({-600, -500, 0.5f});
+    pairs.insert(pairs.end(), {(int)pts.size() - 2, (int)pts.size() - 1});
+
+    std::vector<ScreenSegment> segments;
+    EdgeReduceStats reduce;
+    reduce_screen_edges(pts.data(), (int)pts.size(), pairs.data(), (int)pairs.size() / 2, 200, 200, 0.5f, segments, &reduce);
+    std::cout << "  edges " << reduce.edges_in << " -> segments " << reduce.segments_out << " (offscreen "
+              << reduce.offscreen << ", degenerate " << reduce.degenerate << ", merged " << reduce.merged << ")\n";
+    check("degenerate and offscreen edges dropped", reduce.degenerate == 1 && reduce.offscreen == 1);
+    check("collinear runs merged, corner kept", reduce.segments_out <= 5 && reduce.segments_out >= 2 &&
+                                                    segments.front().a.x == 10 && segments.back().b.y == 90);
+
+    bool corner = false;
+    for (const ScreenSegment &seg : segments)
+        corner = corner || (seg.a.x == 70 && seg.a.y == 50) || (seg.b.x == 70 && seg.b.y == 50);
+    check("corner vertex preserved", corner);
+
+    // A dense ring far away collapses to a handful of segments
+    std::vector<float> ring_xyz;
+    std::vector<int> ring_edges;
+    for (int i = 0; i < 2000; i++)
+    {
+        float a = 6.2831853f * i / 2000;
+        ring_xyz.insert(ring_xyz.end(), {cosf(a), sinf(a), 0.0f});
+        ring_edges.insert(ring_edges.end(), {i, (i + 1) % 2000});
+    }
+    Mesh ring;
+    ring.build(ring_xyz.data(), 2000, reinterpret_cast<const int(*)[2]>(ring_edges.data()), 2000);
+    Canvas ring_canvas(200, 200);
+    renderer_wireframe_reduced(ring_canvas, ring, mat4::translation(0, 0, -20), view, projection, 200, 200, 0.5f, &reduce);
+    std::cout << "  ring: " << reduce.edges_in << " edges -> " << reduce.segments_out << " segments\n";
+    check("dense ring reduced", reduce.segments_out > 8 && reduce.segments_out < 200);
+    check("reduced ring drawn", canvas_sum(ring_canvas) > 0.0f);
+
+    // ---- Chunked scene: a line grid spanning x in [-40, 40] at z = -10 ----
+    std::vector<float> xyz;
+    std::vector<int> edges;
+    for (int i = 0; i <= 80; i++)
+    {
+        xyz.insert(xyz.end(), {-40.0f + i, -1.0f, -10.0f, -40.0f + i, 1.0f, -10.0f});
+        edges.insert(edges.end(), {i * 2, i * 2 + 1});
+        if (i > 0)
+            edges.insert(edges.end(), {(i - 1) * 2, i * 2});
+    }
+
+    const char *path = "test_scene_chunks.t3dc";
+    bool ok = write_chunked_scene(
+        xyz.data(), (int)xyz.size() / 3,
+        reinterpret_cast<const int(*)[2]>(edges.data()), (int)edges.size() / 2,
+        8, path);
+    check("chunked scene written", ok);
+
+    ChunkedScene scene;
+    ok = scene.open(path);
+    check("chunked scene maps", ok);
+
+    if (ok)
+    {
+        long long edge_total = 0;
+        for (int i = 0; i < scene.chunk_count(); i++)
+            edge_total += scene.chunk(i).edge_count;
+        check("8 chunks (top row only used by bottom-row edges)", scene.chunk_count() == 8);
+        check("every edge stored once", edge_total == (long long)edges.size() / 2);
+
+        int ring[26];
+        check("end chunk has one neighbour", scene.neighbours(0, ring) == 1);
+
+        Canvas canvas(200, 200);
+        ChunkCache cache(1 << 20);
+        ChunkRenderStats stats;
+        render_chunked_scene(canvas, scene, cache, view, projection, 200, 200, &stats);
+
+        std::cout << "  chunks drawn " << stats.chunks_drawn << ", culled " << stats.chunks_culled
+                  << ", prefetched " << stats.chunks_prefetched << "\n";
+        check("off-screen chunks culled", stats.chunks_culled > 0 && stats.chunks_drawn > 0);
+        check("neighbours prefetched", stats.chunks_prefetched > 0);
+        check("visible chunks drawn", canvas_sum(canvas) > 0.0f);
+
+        ChunkCache tiny(1);
+        render_chunked_scene(canvas, scene, tiny, view, projection, 200, 200, &stats);
+        check("resident set stays bounded", tiny.resident_bytes() <= scene.chunk_bytes(0) * 2 && tiny.evictions() > 0);
+
+        scene.close();
+    }
+
+    // Batched (one cell per input pass) and 64-bit writers match the one-batch file
+    const char *batched_path = "test_scene_chunks_batched.t3dc";
+    std::vector<uint64_t> wide_edges(edges.begin(), edges.end());
+    ok = write_chunked_scene(
+        xyz.data(), (int)xyz.size() / 3,
+        reinterpret_cast<const int(*)[2]>(edges.data()), (int)edges.size() / 2,
+        8, batched_path, 1);
+    check("batched writer matches", ok && file_bytes(batched_path) == file_bytes(path));
+    ok = write_chunked_scene(
+        xyz.data(), (uint64_t)xyz.size() / 3,
+        reinterpret_cast<const uint64_t(*)[2]>(wide_edges.data()), (uint64_t)wide_edges.size() / 2,
+        8, batched_path, 4096);
+    check("64-bit writer matches", ok && file_bytes(batched_path) == file_bytes(path));
+    std::vector<float> nan_xyz(xyz);
+    nan_xyz[4] = std::numeric_limits<float>::quiet_NaN();
+    ok = write_chunked_scene(
+        nan_xyz.data(), (int)nan_xyz.size() / 3,
+        reinterpret_cast<const int(*)[2]>(edges.data()), (int)edges.size() / 2,
+        8, batched_path);
+    check("non-finite position rejected", !ok);
+    std::remove(batched_path);
+
+    // Corrupt copies: a chunk offset that wraps past the file size, and a
+    // chunk-local edge index past the chunk's vertices
+    const char *bad_path = "test_scene_chunks_bad.t3dc";
+    std::vector<unsigned char> bytes = file_bytes(path);
+    const size_t record0 = sizeof(ChunkedSceneHeader);
+    std::vector<unsigned char> wrapped(bytes);
+    uint64_t huge_offset = 0xFFFFFFFFFFFFF000ull;
+    std::memcpy(&wrapped[record0 + offsetof(ChunkRecord, data_offset)], &huge_offset, 8);
+    ChunkedScene bad;
+    check("wrapping chunk offset rejected", write_bytes(bad_path, wrapped) && !bad.open(bad_path));
+
+    std::vector<unsigned char> bad_index(bytes);
+    ChunkRecord first;
+    std::memcpy(&first, &bytes[record0], sizeof(first));
+    uint32_t past = first.vertex_count;
+    std::memcpy(&bad_index[first.data_offset + first.vertex_count * 12], &past, 4);
+    ok = write_bytes(bad_path, bad_index) && bad.open(bad_path);
+    check("bad edge index opens (checked lazily)", ok);
+    if (ok)
+    {
+        check("bad edge index caught on first check", !bad.check_chunk(0) && bad.check_chunk(1));
+        bad.close();
+    }
+    std::remove(bad_path);
+    std::remove(path);
+
+    // ---- Chunked points: isolated vertices are splatted ----
+    {
+        std::vector<float> cloud;
+        for (int i = 0; i < 64; i++)
+            cloud.insert(cloud.end(), {-4.0f + i * 0.125f, 0.5f * (i % 3), -10.0f});
+        std::vector<int> one_edge = {0, 1};
+
+        for (int with_edge = 0; with_edge < 2; with_edge++)
+        {
+            ok = write_chunked_scene(
+                cloud.data(), (int)cloud.size() / 3,
+                reinterpret_cast<const int(*)[2]>(one_edge.data()), with_edge,
+                2, path);
+            ChunkedScene points;
+            ok = ok && points.open(path);
+            Canvas canvas(200, 200);
+            ChunkCache cache(1 << 20);
+            ChunkRenderStats stats;
+            if (ok)
+                render_chunked_scene(canvas, points, cache, view, projection, 200, 200, &stats);
+            check(with_edge ? "points beside an edge drawn" : "point-only chunks drawn",
+                  ok && stats.points_drawn == 64 - 2 * with_edge && canvas_sum(canvas) > 0.0f);
+            points.close();
+        }
+        std::remove(path);
+    }
+
+    // ---- Transform hierarchy ----
+    {
+        // root -> arm -> hand, plus a sibling leg under root
+        TransformHierarchy rig;
+        int root = rig.add(-1, mat4::translation(0, 0, -10));
+        int arm = rig.add(root, mat4::rotation_xyz(0, 0, 0.5f));
+        int hand = rig.add(arm, mat4::translation(2, 0, 0));
+        int leg = rig.add(root, mat4::translation(0, -1, 0));
+        check("bad parent rejected", rig.add(7, mat4::identity()) == -1 && rig.size() == 4);
+        check("first update computes every node", rig.update() == 4 && !rig.dirty());
+
+        mat4 expected = multiply(multiply(mat4::translation(0, 0, -10), mat4::rotation_xyz(0, 0, 0.5f)),
+                                 mat4::translation(2, 0, 0));
+        bool same = true;
+        for (int k = 0; k < 16; k++)
+            same = same && std::fabs(rig.world(hand).m[k] - expected.m[k]) < 1e-5f;
+        check("world is the chain of locals", same);
+
+        check("clean update writes nothing", rig.update() == 0);
+        rig.set_local(arm, mat4::rotation_xyz(0, 0, 1.0f));
+        check("moved joint updates only its subtree", rig.update() == 2);
+        mat4 leg_world = multiply(mat4::translation(0, 0, -10), mat4::translation(0, -1, 0));
+        same = true;
+        for (int k = 0; k < 16; k++)
+            same = same && rig.world(leg).m[k] == leg_world.m[k];
+        check("sibling untouched", same);
+        rig.set_local(root, mat4::translation(0, 0, -12));
+        check("moved root updates everything", rig.update() == 4 && rig.world(hand).m[14] == -12.0f);
+    }
+
+    // SIMD mat4 multiply against the scalar definition
+    {
+        mat4 a = multiply(mat4::translation(1, 2, 3), mat4::rotation_xyz(0.3f, 0.2f, 0.1f));
+        mat4 b = multiply(mat4::scale(2, 3, 4), projection);
+        mat4 r = multiply(a, b);
+        float worst = 0.0f;
+        for (int col = 0; col < 4; col++)
+            for (int row = 0; row < 4; row++)
+            {
+                float v = 0.0f;
+                for (int k = 0; k < 4; k++)
+                    v += a.m[k * 4 + row] * b.m[col * 4 + k];
+                worst = std::fmax(worst, std::fabs(v - r.m[col * 4 + row]));
+            }
+        check("mat4 multiply", worst < 1e-5f);
+    }
+
+    std::cout << "\n=== Test Complete (" << failures << " failures) ===\n";
+    return failures == 0 ? 0 : 1;
+}